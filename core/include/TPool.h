@@ -2,6 +2,9 @@
 #ifndef TURBO_CORE_TPOOL_H
 #define TURBO_CORE_TPOOL_H
 #include "TObject.h"
+#include "TRefPtr.h"
+#include <functional>
+#include <mutex>
 #include <stdint.h>
 #include <vector>
 
@@ -9,85 +12,207 @@ namespace Turbo
 {
 namespace Core
 {
+template <typename T>
+class TPool;
+
+// NOTE: Gives its object back to the TPool<T> once the last TRefPtr<TPoolObject<T>> drops. It holds the pool, so the pool outlives it
+template <typename T>
+class TPoolObject : public Turbo::Core::TReferenced
+{
+  private:
+    TRefPtr<TPool<T>> pool;
+    TRefPtr<T> object;
+    bool isDiscard = false;
+
+  public:
+    TPoolObject(const TRefPtr<TPool<T>> &pool, const TRefPtr<T> &object);
+
+  protected:
+    virtual ~TPoolObject();
+
+  public:
+    const TRefPtr<T> &Get() const;
+
+    // NOTE: The object is destroyed instead of given back, for an object left in a state the pool can not recycle
+    void Discard();
 
-// NOTE: 目前该 TPool<T> 没有用上
+    virtual bool Valid() const override;
+};
 
+// Free list of T, Allocate() and Free() are O(1). The free list is locked and TReferenced counts atomically, the recycler and destroyer run on the thread dropping the last handle.
+// creator makes a new object once the free list is empty, recycler brings a returned object back to its initial state (reset a fence),
+// destroyer runs on every object the pool lets go (discarded ones, the free ones when the pool is destroyed)
 template <typename T>
 class TPool : public Turbo::Core::TObject
 {
+  public:
+    typedef std::function<TRefPtr<T>()> TCreator;
+    typedef std::function<void(const TRefPtr<T> &)> TRecycler;
+    typedef std::function<void(const TRefPtr<T> &)> TDestroyer;
+
   private:
-    uint32_t count;
+    uint32_t count;            // objects alive at once (free and handed out), 0 for no limit
+    uint32_t createdCount = 0; // created and not discarded yet
+    TCreator creator;
+    TRecycler recycler;
+    TDestroyer destroyer;
 
-    std::vector<T *> pool;
+    std::mutex mutex;
+    std::vector<TRefPtr<T>> freeObjects; // a stack, the last one given back is the most likely still in the caches
 
   public:
-    TPool(uint32_t count);
+    TPool(uint32_t count, TCreator creator, TRecycler recycler = nullptr, TDestroyer destroyer = nullptr);
 
   protected:
     virtual ~TPool();
 
   public:
-    template <typename... Args>
-    T *Allocate(Args &&...args);
-    void Free(T *object);
+    // nullptr once count objects are handed out, or if the creator failed
+    TRefPtr<TPoolObject<T>> Allocate();
+    // recycle object and put it on the free list, TPoolObject<T> calls it
+    void Free(const TRefPtr<T> &object);
+    // destroy object instead, it no longer counts against count
+    void Discard(const TRefPtr<T> &object);
 
-    const std::vector<T *> &GetPool();
+    uint32_t GetCreatedCount();
+    uint32_t GetFreeCount();
 
     virtual std::string ToString() const override;
 };
 
 template <typename T>
-Turbo::Core::TPool<T>::TPool(uint32_t count) : Turbo::Core::TObject()
+Turbo::Core::TPoolObject<T>::TPoolObject(const TRefPtr<TPool<T>> &pool, const TRefPtr<T> &object) : Turbo::Core::TReferenced()
+{
+    this->pool = pool;
+    this->object = object;
+}
+
+template <typename T>
+Turbo::Core::TPoolObject<T>::~TPoolObject()
+{
+    if (this->isDiscard)
+    {
+        this->pool->Discard(this->object);
+    }
+    else
+    {
+        this->pool->Free(this->object);
+    }
+}
+
+template <typename T>
+const Turbo::Core::TRefPtr<T> &Turbo::Core::TPoolObject<T>::Get() const
+{
+    return this->object;
+}
+
+template <typename T>
+void Turbo::Core::TPoolObject<T>::Discard()
+{
+    this->isDiscard = true;
+}
+
+template <typename T>
+bool Turbo::Core::TPoolObject<T>::Valid() const
+{
+    return this->object.Valid();
+}
+
+template <typename T>
+Turbo::Core::TPool<T>::TPool(uint32_t count, TCreator creator, TRecycler recycler, TDestroyer destroyer) : Turbo::Core::TObject()
 {
     this->count = count;
+    this->creator = std::move(creator);
+    this->recycler = std::move(recycler);
+    this->destroyer = std::move(destroyer);
 }
 
 template <typename T>
 Turbo::Core::TPool<T>::~TPool()
 {
+    // every TPoolObject<T> holds the pool, so all the objects are back here
+    for (TRefPtr<T> &object_item : this->freeObjects)
+    {
+        if (this->destroyer)
+        {
+            this->destroyer(object_item);
+        }
+        object_item = nullptr;
+    }
 }
 
 template <typename T>
-template <typename... Args>
-T *Turbo::Core::TPool<T>::Allocate(Args &&...args)
+Turbo::Core::TRefPtr<Turbo::Core::TPoolObject<T>> Turbo::Core::TPool<T>::Allocate()
 {
-    if (this->pool.size() < this->count)
+    TRefPtr<T> object;
     {
-        T *result = new T(args...);
-        this->pool.push_back(result);
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->freeObjects.empty())
+        {
+            object = std::move(this->freeObjects.back());
+            this->freeObjects.pop_back();
+        }
+        else if (this->count != 0 && this->createdCount >= this->count)
+        {
+            return nullptr;
+        }
+        else
+        {
+            this->createdCount++;
+        }
+    }
 
-        return result;
+    // the creator runs outside the lock, creating a Vulkan object is the slow part
+    if (!object)
+    {
+        object = this->creator();
+        if (!object)
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->createdCount--;
+            return nullptr;
+        }
     }
 
-    return nullptr;
+    return new TPoolObject<T>(this, object);
 }
 
 template <typename T>
-void Turbo::Core::TPool<T>::Free(T *object)
+void Turbo::Core::TPool<T>::Free(const TRefPtr<T> &object)
 {
-    uint32_t index = 0;
-    bool is_found = false;
-    for (T *item : this->pool)
+    if (this->recycler)
     {
-        if (item == object)
-        {
-            is_found = true;
-            break;
-        }
-        index = index + 1;
+        this->recycler(object);
     }
 
-    if (is_found)
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->freeObjects.push_back(object);
+}
+
+template <typename T>
+void Turbo::Core::TPool<T>::Discard(const TRefPtr<T> &object)
+{
+    if (this->destroyer)
     {
-        delete this->pool[index];
-        this->pool.erase(this->pool.begin() + index);
+        this->destroyer(object);
     }
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->createdCount--;
+}
+
+template <typename T>
+uint32_t Turbo::Core::TPool<T>::GetCreatedCount()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->createdCount;
 }
 
 template <typename T>
-const std::vector<T *> &Turbo::Core::TPool<T>::GetPool()
+uint32_t Turbo::Core::TPool<T>::GetFreeCount()
 {
-    return this->pool;
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return static_cast<uint32_t>(this->freeObjects.size());
 }
 
 template <typename T>
@@ -98,4 +223,4 @@ std::string Turbo::Core::TPool<T>::ToString() const
 } // namespace Core
 } // namespace Turbo
 
-#endif // !TURBO_CORE_TPOOL_H
\ No newline at end of file
+#endif // !TURBO_CORE_TPOOL_H
@@ -67,8 +67,9 @@ class TRefPtr
         }
     }
 
+    // NOTE: Takes the reference over, the count is not touched
     template <typename Inherit>
-    TRefPtr(const TRefPtr<Inherit> &&other)
+    TRefPtr(TRefPtr<Inherit> &&other) noexcept
     {
         static_assert(std::is_base_of<T, Inherit>::value, "TRefPtr<Inherit> which Inherit must inherited from T");
         this->ptr = other.ptr;
@@ -137,6 +138,22 @@ class TRefPtr
         return *this;
     }
 
+    TRefPtr &operator=(TRefPtr &&rp) noexcept
+    {
+        if (this != &rp)
+        {
+            T *temp_ptr = this->ptr;
+            this->ptr = rp.ptr;
+            rp.ptr = nullptr;
+            if (temp_ptr != nullptr)
+            {
+                temp_ptr->UnReference();
+            }
+        }
+
+        return *this;
+    }
+
     template <typename Inherit>
     TRefPtr &operator=(TRefPtr<Inherit> &&rp)
     {
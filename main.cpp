@@ -1,5 +1,4 @@
 #include <iostream>
-#include <ply.h>
 
 #include "core/include/TDevice.h"
 #include "core/include/TDeviceQueue.h"
@@ -26,10 +25,13 @@
 #include "core/include/TDescriptorSetLayout.h"
 #include "core/include/TFramebuffer.h"
 
+#include "core/include/TBarrier.h"
 #include "core/include/TFence.h"
 #include "core/include/TSemaphore.h"
 
+#include <atomic>
 #include <fstream>
+#include <memory>
 
 #include <GLFW/glfw3.h>
 
@@ -50,259 +52,321 @@
 
 #include <imgui.h>
 
+#include "src/PointCloudData.h"
+#include "src/CameraPath.h"
+#include "src/DevicePools.h"
+#include "src/ChunkOrder.h"
+#include "src/ComputePrimitivesCheck.h"
+#include "src/DynamicResolution.h"
+#include "src/FramePacing.h"
+#include "src/GpuProfiler.h"
+#include "src/GraphicsPipelineState.h"
+#include "src/HeadlessBenchmark.h"
+#include "src/HiZCulling.h"
+#include "src/HoleFilling.h"
+#include "src/MortonSort.h"
+#include "src/PipelineBuilder.h"
+#include "src/PipelineCacheFile.h"
+#include "src/PointCloudUpload.h"
+#include "src/PointCulling.h"
+#include "src/PlyLoader.h"
+#include "src/PointsDrawRecorder.h"
+#include "src/ProgressiveAccumulation.h"
+#include "src/QueryPool.h"
+#include "src/EmbeddedShaders.h"
+#include "src/ShaderCache.h"
+#include "src/Trace.h"
+#include "src/UploadBenchmark.h"
+#include "src/WorkerPool.h"
+#include "src/WorkerPoolBenchmark.h"
+#include "src/RefCountBenchmark.h"
+
 static bool g_MouseJustPressed[ImGuiMouseButton_COUNT] = { false };
 static GLFWcursor* g_MouseCursors[ImGuiMouseCursor_COUNT] = { nullptr };
 
-std::string ReadTextFile(const std::string& filename)
+// On demand rendering only draws while this is set or frames are still owed. Every GLFW event sets it,
+// another thread (e.g. a streamed chunk landing) sets it and wakes the main thread with glfwPostEmptyEvent()
+static std::atomic<bool> g_IsRedrawRequested{ false };
+
+static void GlfwMouseButtonCallback(GLFWwindow* window, int button, int action, int mods)
 {
-    std::ifstream fileStream(filename);
-    if (!fileStream.is_open())
+    // a click shorter than an idle wait still reaches ImGui
+    if (action == GLFW_PRESS && button >= 0 && button < ImGuiMouseButton_COUNT)
     {
-        throw std::runtime_error("Unable to open file: " + filename);
+        g_MouseJustPressed[button] = true;
     }
-    return { std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>() };
+    g_IsRedrawRequested = true;
 }
 
-#define TEX_SIZE 512
+static void GlfwCursorPosCallback(GLFWwindow* window, double x, double y)
+{
+    g_IsRedrawRequested = true;
+}
+
+static void GlfwScrollCallback(GLFWwindow* window, double xOffset, double yOffset)
+{
+    g_IsRedrawRequested = true;
+}
+
+static void GlfwKeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
+{
+    g_IsRedrawRequested = true;
+}
 
-typedef struct POSITION
+static void GlfwCharCallback(GLFWwindow* window, unsigned int codepoint)
 {
-    float x, y, z, w;
-} POSITION;
+    g_IsRedrawRequested = true;
+}
 
-typedef struct COLOR
+static void GlfwWindowSizeCallback(GLFWwindow* window, int width, int height)
 {
-    float r, g, b, a;
-} COLOR;
+    g_IsRedrawRequested = true;
+}
 
-struct MATRIXS_BUFFER_DATA
+static void GlfwWindowRefreshCallback(GLFWwindow* window)
 {
-    glm::mat4 m, v, p;
-};
+    g_IsRedrawRequested = true;
+}
 
-typedef struct Point
+static void GlfwWindowFocusCallback(GLFWwindow* window, int focused)
 {
-    POSITION position;
-    COLOR color;
-} Point;
+    g_IsRedrawRequested = true;
+}
 
-typedef struct PlyData
+std::string ReadTextFile(const std::string& filename)
 {
-    std::vector<Point> points;
-    POSITION min, max;
-} PlyData;
+    std::ifstream fileStream(filename);
+    if (!fileStream.is_open())
+    {
+        throw std::runtime_error("Unable to open file: " + filename);
+    }
+    return { std::istreambuf_iterator<char>(fileStream), std::istreambuf_iterator<char>() };
+}
+
+const std::string PIPELINE_CACHE_PATH = "./pipeline_cache.bin";
+const std::string GPU_PROFILE_CSV_PATH = "./gpu_profile.csv";
+const std::string TRACE_STARTUP_PATH = "./trace_startup.json";
+const uint32_t TRACE_STARTUP_FRAME_COUNT = 120; // --trace keeps recording for the first frames after startup
+const double ON_DEMAND_WAIT_TIMEOUT = 0.25;     // second, longest idle wait between two checks of the redraw request
+const uint32_t ON_DEMAND_FRAME_COUNT = 3;       // frames drawn after a redraw request, ImGui needs a few to settle hover and focus
 
 const std::string IMGUI_VERT_SHADER_STR = ReadTextFile("./shaders/imgui.vert");
 const std::string IMGUI_FRAG_SHADER_STR = ReadTextFile("./shaders/imgui.frag");
 const std::string MY_VERT_SHADER_STR = ReadTextFile("./shaders/PointCloud.vert");
+const std::string MY_BUFFER_VERT_SHADER_STR = ReadTextFile("./shaders/PointCloudBuffer.vert");
 const std::string MY_FRAG_SHADER_STR = ReadTextFile("./shaders/PointCloud.frag");
-
-PlyData LoadPly(const std::string& url)
+const std::string HIZ_PYRAMID_COMP_SHADER_STR = ReadTextFile("./shaders/HiZPyramid.comp");
+const std::string HIZ_CULL_COMP_SHADER_STR = ReadTextFile("./shaders/HiZCull.comp");
+const std::string PULL_PUSH_COMP_SHADER_STR = ReadTextFile("./shaders/PullPush.comp");
+const std::string POINT_CULL_COMP_SHADER_STR = ReadTextFile("./shaders/PointCull.comp");
+const std::string REDUCE_COMP_SHADER_STR = ReadTextFile("./shaders/Reduce.comp");
+const std::string SCAN_COMP_SHADER_STR = ReadTextFile("./shaders/Scan.comp");
+const std::string COMPACT_COMP_SHADER_STR = ReadTextFile("./shaders/Compact.comp");
+const std::string HISTOGRAM_COMP_SHADER_STR = ReadTextFile("./shaders/Histogram.comp");
+const std::string RADIX_SORT_COMP_SHADER_STR = ReadTextFile("./shaders/RadixSort.comp");
+const std::string MORTON_SORT_COMP_SHADER_STR = ReadTextFile("./shaders/MortonSort.comp");
+
+int main(int argc, char** argv)
 {
-    PlyData plyData;
-    plyData.min = { FLT_MAX, FLT_MAX, FLT_MAX, 0 };
-    plyData.max = { -FLT_MAX, -FLT_MAX, -FLT_MAX, 0 };
-
-    int elementsCount = 0;
-    char** elements;
-    int fileType;
-    float version;
-
-    PlyFile* plyFile = ply_open_for_reading(const_cast<char*>(url.c_str()), &elementsCount, &elements, &fileType, &version);
-    if (plyFile)
+    Trace::SetThreadName("Main");
+    uint32_t trace_startup_frame_count = 0;
+    HeadlessBenchmarkOptions benchmark_options;
+    UploadBenchmarkOptions upload_benchmark_options;
+    bool is_upload_benchmark = false;
+    ComputePrimitivesCheckOptions primitives_check_options;
+    bool is_primitives_check = false;
+    WorkerPoolBenchmarkOptions worker_pool_benchmark_options;
+    bool is_worker_pool_benchmark = false;
+    RefCountBenchmarkOptions ref_count_benchmark_options;
+    bool is_ref_count_benchmark = false;
+    std::string record_camera_path_file; // --record-path, the WASD/mouse camera of every frame is written there on exit
+    std::vector<std::string> ply_files;  // --ply, may be repeated and replaces the built-in model list
+    bool is_on_demand = false;           // --on-demand, only draw when something changed
+    MortonSortMode morton_sort_mode = MortonSortMode::NONE; // --morton
+    bool is_morton_compare = false;                         // --morton compare, the GPU sort and the timing of the CPU one
+    Turbo::Extension::TPresentMode present_mode = Turbo::Extension::TPresentMode::FIFO; // --present-mode
+    FramePacingPolicy frame_pacing_policy = FramePacingPolicy::THROUGHPUT;              // --low-latency
+    uint32_t requested_swapchain_image_count = 0;                                       // --swapchain-images, 0 keeps the surface maximum
+    for (int arg_index = 1; arg_index < argc; arg_index++)
     {
-        for (int elemIdx = 0; elemIdx < elementsCount; ++elemIdx)
+        std::string arg = argv[arg_index];
+        bool has_value = arg_index + 1 < argc;
+        if (arg == "--trace")
+        {
+            trace_startup_frame_count = TRACE_STARTUP_FRAME_COUNT;
+            Trace::BeginCapture();
+        }
+        else if (arg == "--benchmark" && has_value)
+        {
+            benchmark_options.cameraPathFile = argv[++arg_index];
+        }
+        else if (arg == "--benchmark-output" && has_value)
         {
-            if (equal_strings("vertex", elements[elemIdx]))
+            benchmark_options.outputFile = argv[++arg_index];
+        }
+        else if (arg == "--benchmark-device" && has_value)
+        {
+            benchmark_options.deviceName = argv[++arg_index];
+            upload_benchmark_options.deviceName = benchmark_options.deviceName;
+            primitives_check_options.deviceName = benchmark_options.deviceName;
+        }
+        else if (arg == "--benchmark-resolution" && has_value)
+        {
+            // WIDTHxHEIGHT
+            unsigned int width = 0, height = 0;
+            if (sscanf(argv[++arg_index], "%ux%u", &width, &height) == 2 && width > 0 && height > 0)
             {
-                int numElems = 0;
-                int numProps = 0;
-
-                PlyProperty** propList = ply_get_element_description(plyFile, elements[elemIdx], &numElems, &numProps);  
-                struct PlyVertex
-                {
-                    float x, y, z;
-                    unsigned char r, g, b, a;
-                };
-
-                PlyProperty vertProps[] = {
-                    {"x", PLY_FLOAT, PLY_FLOAT, offsetof(PlyVertex, x), 0, 0, 0, 0},
-                    {"y", PLY_FLOAT, PLY_FLOAT, offsetof(PlyVertex, y), 0, 0, 0, 0},
-                    {"z", PLY_FLOAT, PLY_FLOAT, offsetof(PlyVertex, z), 0, 0, 0, 0},
-                    {"red", PLY_UCHAR, PLY_UCHAR, offsetof(PlyVertex, r), 0, 0, 0, 0},
-                    {"green", PLY_UCHAR, PLY_UCHAR, offsetof(PlyVertex, g), 0, 0, 0, 0},
-                    {"blue", PLY_UCHAR, PLY_UCHAR, offsetof(PlyVertex, b), 0, 0, 0, 0},
-                    {"alpha", PLY_UCHAR, PLY_UCHAR, offsetof(PlyVertex, a), 0, 0, 0, 0},
-                };
-
-                for (PlyProperty& prop : vertProps)
-                {
-                    ply_get_property(plyFile, elements[elemIdx], &prop);
-                }
-
-                for (int i = 0; i < numElems; ++i)
-                {
-                    PlyVertex vertex;
-                    ply_get_element(plyFile, &vertex);
-
-                    Point point;
-                    point.position = { vertex.x, vertex.y, vertex.z, 0.0f };
-                    point.color = { vertex.r / 255.0f, vertex.g / 255.0f, vertex.b / 255.0f, vertex.a / 255.0f };
-
-                    plyData.points.push_back(point);
-
-                    plyData.min.x = std::min(plyData.min.x, point.position.x);
-                    plyData.min.y = std::min(plyData.min.y, point.position.y);
-                    plyData.min.z = std::min(plyData.min.z, point.position.z);
-
-                    plyData.max.x = std::max(plyData.max.x, point.position.x);
-                    plyData.max.y = std::max(plyData.max.y, point.position.y);
-                    plyData.max.z = std::max(plyData.max.z, point.position.z);
-                }
+                benchmark_options.width = width;
+                benchmark_options.height = height;
+            }
+        }
+        else if (arg == "--benchmark-loops" && has_value)
+        {
+            benchmark_options.loopCount = static_cast<uint32_t>(std::max(1, atoi(argv[++arg_index])));
+        }
+        else if (arg == "--upload-benchmark" && has_value)
+        {
+            is_upload_benchmark = true;
+            upload_benchmark_options.outputFile = argv[++arg_index];
+        }
+        else if (arg == "--upload-points" && has_value)
+        {
+            // million
+            upload_benchmark_options.pointCount = static_cast<uint64_t>(std::max(0.0, atof(argv[++arg_index])) * 1000000.0);
+        }
+        else if (arg == "--upload-repeat" && has_value)
+        {
+            upload_benchmark_options.repeatCount = static_cast<uint32_t>(std::max(1, atoi(argv[++arg_index])));
+        }
+        else if ((arg == "--upload-chunk-sizes" || arg == "--upload-ring-sizes" || arg == "--upload-batches") && has_value)
+        {
+            // comma separated, e.g. --upload-chunk-sizes 256,512,1024
+            std::vector<uint32_t>& values = arg == "--upload-chunk-sizes" ? upload_benchmark_options.chunkSizes : (arg == "--upload-ring-sizes" ? upload_benchmark_options.stagingRingSizes : upload_benchmark_options.submitBatchSizes);
+            if (!ParseUploadBenchmarkList(argv[++arg_index], values))
+            {
+                std::cerr << "Invalid list for " << arg << std::endl;
+            }
+        }
+        else if (arg == "--morton" && has_value)
+        {
+            std::string morton_sort_mode_name = argv[++arg_index];
+            if (morton_sort_mode_name == "cpu")
+            {
+                morton_sort_mode = MortonSortMode::CPU;
+            }
+            else if (morton_sort_mode_name == "gpu" || morton_sort_mode_name == "compare")
+            {
+                morton_sort_mode = MortonSortMode::GPU;
+                is_morton_compare = morton_sort_mode_name == "compare";
+            }
+            else
+            {
+                std::cerr << "Unknown Morton sort mode " << morton_sort_mode_name << " (cpu, gpu, compare)" << std::endl;
             }
         }
-        ply_close(plyFile);
+        else if (arg == "--jobs-benchmark" && has_value)
+        {
+            is_worker_pool_benchmark = true;
+            worker_pool_benchmark_options.outputFile = argv[++arg_index];
+        }
+        else if (arg == "--refcount-benchmark" && has_value)
+        {
+            is_ref_count_benchmark = true;
+            ref_count_benchmark_options.outputFile = argv[++arg_index];
+        }
+        else if (arg == "--primitives-check")
+        {
+            is_primitives_check = true;
+        }
+        else if (arg == "--primitives-count" && has_value)
+        {
+            primitives_check_options.itemCount = static_cast<uint32_t>(std::max(1, atoi(argv[++arg_index])));
+        }
+        else if (arg == "--record-path" && has_value)
+        {
+            record_camera_path_file = argv[++arg_index];
+        }
+        else if (arg == "--ply" && has_value)
+        {
+            ply_files.push_back(argv[++arg_index]);
+        }
+        else if (arg == "--on-demand")
+        {
+            is_on_demand = true;
+        }
+        else if (arg == "--present-mode" && has_value)
+        {
+            std::string present_mode_name = argv[++arg_index];
+            if (present_mode_name == "immediate")
+            {
+                present_mode = Turbo::Extension::TPresentMode::IMMEDIATE;
+            }
+            else if (present_mode_name == "mailbox")
+            {
+                present_mode = Turbo::Extension::TPresentMode::MAILBOX;
+            }
+            else if (present_mode_name == "fifo-relaxed")
+            {
+                present_mode = Turbo::Extension::TPresentMode::FIFO_RELAXED;
+            }
+            else if (present_mode_name == "fifo")
+            {
+                present_mode = Turbo::Extension::TPresentMode::FIFO;
+            }
+            else
+            {
+                std::cerr << "Unknown present mode " << present_mode_name << " (immediate, mailbox, fifo, fifo-relaxed)" << std::endl;
+            }
+        }
+        else if (arg == "--low-latency")
+        {
+            frame_pacing_policy = FramePacingPolicy::LOW_LATENCY;
+        }
+        else if (arg == "--swapchain-images" && has_value)
+        {
+            requested_swapchain_image_count = static_cast<uint32_t>(std::max(0, atoi(argv[++arg_index])));
+        }
+        else
+        {
+            std::cerr << "Unknown argument " << arg << std::endl;
+        }
     }
-    else
+
+    // --upload-benchmark <output>: synthetic points, no window, time the upload paths and exit
+    if (is_upload_benchmark)
     {
-        std::cerr << "Failed to open ply file." << std::endl;
+        return RunUploadBenchmark(upload_benchmark_options);
     }
 
-    return plyData;
-}
-
-
-typedef struct PointsPositionImage
-{
-    Turbo::Core::TRefPtr<Turbo::Core::TImage> image;
-    Turbo::Core::TRefPtr<Turbo::Core::TImageView> imageView;
-} PointsPositionImage;
-
-typedef struct PointsColorImage
-{
-    Turbo::Core::TRefPtr<Turbo::Core::TImage> image;
-    Turbo::Core::TRefPtr<Turbo::Core::TImageView> imageView;
-} PointsColorImage;
-
-typedef struct PointsImageData
-{
-    PointsPositionImage pointsPositionImage;
-    PointsColorImage pointsColorImage;
-    uint32_t count = 0;
-} PointsImageData;
-
-std::vector<Point> PlyDatasToPoints(const std::vector<PlyData>& plyDatas)
-{
-    std::vector<Point> points;
-    for (const PlyData& plyData : plyDatas)
+    // --jobs-benchmark <output>: task overhead and scaling of the WorkerPool scheduler, no Vulkan
+    if (is_worker_pool_benchmark)
     {
-        points.insert(points.end(), plyData.points.begin(), plyData.points.end());
+        return RunWorkerPoolBenchmark(worker_pool_benchmark_options);
     }
-    return points;
-}
-std::vector<PointsImageData> CreateAllPointsImageData(const std::vector<Point>& points, Turbo::Core::TRefPtr<Turbo::Core::TDevice> device, Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> queue, Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> commandPool)
-{
-    std::vector<PointsImageData> result;
-    size_t tex_size = TEX_SIZE;
-    size_t tex_content_size = tex_size * tex_size;
-    size_t loop_count = points.size() / tex_content_size;
-    size_t residue_count = points.size() % tex_content_size;
-
-    auto create_points_image_data = [&](const std::vector<POSITION>& pointsPosition, const std::vector<COLOR>& pointsColor) -> PointsImageData {
-        PointsImageData imageData;
-        Turbo::Core::TRefPtr<Turbo::Core::TBuffer> positionBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, pointsPosition.size() * sizeof(POSITION));
-        Turbo::Core::TRefPtr<Turbo::Core::TBuffer> colorBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, pointsColor.size() * sizeof(COLOR));
-
-        void* positionPtr = positionBuffer->Map();
-        memcpy(positionPtr, pointsPosition.data(), pointsPosition.size() * sizeof(POSITION));
-        positionBuffer->Unmap();
-
-        void* colorPtr = colorBuffer->Map();
-        memcpy(colorPtr, pointsColor.data(), pointsColor.size() * sizeof(COLOR));
-        colorBuffer->Unmap();
-
-        Turbo::Core::TRefPtr<Turbo::Core::TImage> positionImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R32G32B32A32_SFLOAT, tex_size, tex_size, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
-        Turbo::Core::TRefPtr<Turbo::Core::TImage> colorImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R32G32B32A32_SFLOAT, tex_size, tex_size, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
-
-        Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> commandBuffer = commandPool->Allocate();
-        commandBuffer->Begin();
-
-        commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::HOST_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TAccessBits::HOST_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, positionImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
-        commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::HOST_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TAccessBits::HOST_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, colorImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
-
-        size_t rowCount = pointsPosition.size() / tex_size;
-        size_t remainingPoints = pointsPosition.size() % tex_size;
-
-        commandBuffer->CmdCopyBufferToImage(positionBuffer, positionImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, 0, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, tex_size, rowCount, 1);
-        commandBuffer->CmdCopyBufferToImage(colorBuffer, colorImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, 0, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, tex_size, rowCount, 1);
-
-        if (remainingPoints > 0)
-        {
-            commandBuffer->CmdCopyBufferToImage(positionBuffer, positionImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, rowCount * tex_size * sizeof(POSITION), 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, rowCount, 0, remainingPoints, 1, 1);
-            commandBuffer->CmdCopyBufferToImage(colorBuffer, colorImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, rowCount * tex_size * sizeof(COLOR), 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, rowCount, 0, remainingPoints, 1, 1);
-        }
-
-        commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::FRAGMENT_SHADER_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, Turbo::Core::TImageLayout::GENERAL, positionImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
-        commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::FRAGMENT_SHADER_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, Turbo::Core::TImageLayout::GENERAL, colorImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
-
-        commandBuffer->End();
-
-        Turbo::Core::TRefPtr<Turbo::Core::TFence> fence = new Turbo::Core::TFence(device);
-        queue->Submit(commandBuffer, fence);
-        fence->WaitUntil();
-        commandPool->Free(commandBuffer);
-
-        Turbo::Core::TRefPtr<Turbo::Core::TImageView> positionImageView = new Turbo::Core::TImageView(positionImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, positionImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
-        Turbo::Core::TRefPtr<Turbo::Core::TImageView> colorImageView = new Turbo::Core::TImageView(colorImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, colorImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
-
-        imageData.pointsPositionImage.image = positionImage;
-        imageData.pointsPositionImage.imageView = positionImageView;
-        imageData.pointsColorImage.image = colorImage;
-        imageData.pointsColorImage.imageView = colorImageView;
-        imageData.count = pointsPosition.size();
 
-        return imageData;
-        };
-
-    for (size_t loopIndex = 0; loopIndex < loop_count; ++loopIndex)
+    // --refcount-benchmark <output>: cost of the atomic TReferenced count against the old plain one, on one thread and under contention, no Vulkan
+    if (is_ref_count_benchmark)
     {
-        size_t offset = loopIndex * tex_content_size;
-
-        std::vector<POSITION> pointsPosition;
-        std::vector<COLOR> pointsColor;
-
-        for (size_t i = 0; i < tex_content_size; ++i)
-        {
-            pointsPosition.push_back(points[offset + i].position);
-            pointsColor.push_back(points[offset + i].color);
-        }
-
-        result.push_back(create_points_image_data(pointsPosition, pointsColor));
+        return RunRefCountBenchmark(ref_count_benchmark_options);
     }
 
-    if (residue_count > 0)
+    // --primitives-check: the GPU compute primitives against the std:: algorithms on random data, no window
+    if (is_primitives_check)
     {
-        size_t offset = loop_count * tex_content_size;
-
-        std::vector<POSITION> pointsPosition;
-        std::vector<COLOR> pointsColor;
-
-        for (size_t i = 0; i < residue_count; ++i)
-        {
-            pointsPosition.push_back(points[offset + i].position);
-            pointsColor.push_back(points[offset + i].color);
-        }
-
-        result.push_back(create_points_image_data(pointsPosition, pointsColor));
+        primitives_check_options.shaderCodes.reduce = REDUCE_COMP_SHADER_STR;
+        primitives_check_options.shaderCodes.scan = SCAN_COMP_SHADER_STR;
+        primitives_check_options.shaderCodes.compact = COMPACT_COMP_SHADER_STR;
+        primitives_check_options.shaderCodes.histogram = HISTOGRAM_COMP_SHADER_STR;
+        primitives_check_options.shaderCodes.radixSort = RADIX_SORT_COMP_SHADER_STR;
+        return RunComputePrimitivesCheck(primitives_check_options);
     }
 
-    return result;
-}
-
-
-int main()
-{
     std::vector<PlyData> ply_datas;
+    for (const std::string& ply_file : ply_files)
+    {
+        ply_datas.push_back(LoadPly(ply_file));
+    }
+    if (ply_files.empty())
     {
         //ply_datas.push_back(LoadPly("./models/points.ply"));
         //ply_datas.push_back(LoadPly("./models/sy-carola-point-cloud/source/Carola_PointCloud/Carola_PointCloud.ply"));
@@ -500,6 +564,20 @@ int main()
    size_t all_point_count = points.size();
 
    std::cout << "points::size::" << points.size() << ":: ----------------------------------------------------------------------------------" << std::endl;
+
+   // --benchmark <camera path>: no window and no swapchain, render offscreen along the path and exit
+   if (!benchmark_options.cameraPathFile.empty())
+   {
+       benchmark_options.pointsVertexShaderCode = MY_VERT_SHADER_STR;
+       benchmark_options.pointsBufferVertexShaderCode = MY_BUFFER_VERT_SHADER_STR;
+       benchmark_options.pointsFragmentShaderCode = MY_FRAG_SHADER_STR;
+       int benchmark_result = RunHeadlessBenchmark(benchmark_options, points);
+       if (trace_startup_frame_count > 0)
+       {
+           Trace::EndCapture(TRACE_STARTUP_PATH);
+       }
+       return benchmark_result;
+   }
    std::cout << "Vulkan Version:" << Turbo::Core::TVulkanLoader::Instance()->GetVulkanVersion().ToString() << ":: ----------------------------------------------------------------------------------" << std::endl;
 
    std::vector<Turbo::Core::TLayerInfo> support_layers;
@@ -555,6 +633,14 @@ int main()
    int window_height = 1080 / 2;
    glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
    window = glfwCreateWindow(window_width, window_height, "Turbo", nullptr, nullptr);
+   glfwSetMouseButtonCallback(window, GlfwMouseButtonCallback);
+   glfwSetCursorPosCallback(window, GlfwCursorPosCallback);
+   glfwSetScrollCallback(window, GlfwScrollCallback);
+   glfwSetKeyCallback(window, GlfwKeyCallback);
+   glfwSetCharCallback(window, GlfwCharCallback);
+   glfwSetWindowSizeCallback(window, GlfwWindowSizeCallback);
+   glfwSetWindowRefreshCallback(window, GlfwWindowRefreshCallback);
+   glfwSetWindowFocusCallback(window, GlfwWindowFocusCallback);
 
    VkSurfaceKHR vk_surface_khr = VK_NULL_HANDLE;
    VkInstance vk_instance = instance->GetVkInstance();
@@ -581,10 +667,19 @@ int main()
    uint32_t max_image_count = surface->GetMaxImageCount();
    uint32_t min_image_count = surface->GetMinImageCount();
    //uint32_t swapchain_image_count = (max_image_count <= min_image_count) ? min_image_count : max_image_count - 1;
-   uint32_t swapchain_image_count = max_image_count;
+   // fewer images queue fewer frames ahead of the display with FIFO, a max of 0 means no limit
+   uint32_t swapchain_image_count = requested_swapchain_image_count > 0 ? requested_swapchain_image_count : (max_image_count > 0 ? max_image_count : min_image_count + 1);
 
+   const Turbo::Core::TImageUsages swapchain_usages = Turbo::Core::TImageUsageBits::IMAGE_COLOR_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_SRC | Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST;
+   Turbo::Core::TRefPtr<Turbo::Extension::TSwapchain> swapchain = CreateSwapchain(surface, swapchain_image_count, Turbo::Core::TFormatType::B8G8R8A8_SRGB, swapchain_usages, present_mode);
+   swapchain_image_count = static_cast<uint32_t>(swapchain->GetImages().size());
+   present_mode = swapchain->GetPresentMode();
+   bool is_swapchain_dirty = false; // a new present mode or image count recreates the swapchain after the present
 
-   Turbo::Core::TRefPtr<Turbo::Extension::TSwapchain> swapchain = new Turbo::Extension::TSwapchain(surface, swapchain_image_count, Turbo::Core::TFormatType::B8G8R8A8_SRGB, 1, Turbo::Core::TImageUsageBits::IMAGE_COLOR_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_SRC | Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST, true);
+   FramePacing frame_pacing;
+   frame_pacing.SetPolicy(frame_pacing_policy);
+   const GLFWvidmode* video_mode = glfwGetVideoMode(glfwGetPrimaryMonitor());
+   frame_pacing.SetRefreshRate(video_mode != nullptr ? video_mode->refreshRate : 0);
 
    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImage>> swapchain_images = swapchain->GetImages();
    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> swapchain_image_views;
@@ -597,9 +692,87 @@ int main()
 
    Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> command_pool = new Turbo::Core::TCommandBufferPool(queue);
    Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> command_buffer = command_pool->Allocate();
+   // the per frame semaphore and fence, the upload command buffers and fences
+   DevicePools device_pools(queue);
+
+   WorkerPool worker_pool;
+
+   // UMA, ReBAR and software devices can write the points straight into device local memory
+   PointsStorageType points_storage_type = IsSupportDirectWriteUpload(physical_device, all_point_count * (sizeof(POSITION) + sizeof(COLOR))) ? PointsStorageType::BUFFER : PointsStorageType::IMAGE;
+
+   bool is_pipeline_cache_warm = false;
+   Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> pipeline_cache = LoadPipelineCache(device, PIPELINE_CACHE_PATH, &is_pipeline_cache_warm);
+
+   ShaderCache shader_cache;
+   EmbedShaders(shader_cache);
+   PipelineBuilder pipeline_builder(worker_pool, shader_cache);
+
+   auto create_compute_pipeline = [&](const Turbo::Core::TRefPtr<Turbo::Core::TComputeShader>& computeShader) {
+       return Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>(new Turbo::Core::TComputePipeline(pipeline_cache, computeShader));
+   };
+
+   auto upload_points = [&](const std::vector<Point>& uploadPoints) {
+       switch (points_storage_type)
+       {
+       case PointsStorageType::BUFFER:
+           return CreateAllPointsBufferData(uploadPoints, device, worker_pool);
+       case PointsStorageType::IMAGE:
+           return CreateAllPointsImageData(uploadPoints, device, device_pools);
+       }
+       return std::vector<PointsChunkData>();
+   };
+
+   // --morton: chunks cut along the Morton curve are spatially compact, so their bounds are tight for culling and the draw order.
+   // cpu sorts here before the usual upload, gpu uploads the file order and sorts on the device, compare times the CPU path on a copy too.
+   double morton_cpu_time = 0.0;            // SortPointsMorton
+   double morton_compare_upload_time = 0.0; // --morton compare: the usual upload of the CPU sorted copy, released right after
+   if (morton_sort_mode == MortonSortMode::CPU)
+   {
+       double morton_start_time = glfwGetTime();
+       SortPointsMorton(points, worker_pool);
+       morton_cpu_time = glfwGetTime() - morton_start_time;
+   }
+   else if (is_morton_compare)
+   {
+       std::vector<Point> compare_points = points;
+       double morton_start_time = glfwGetTime();
+       SortPointsMorton(compare_points, worker_pool);
+       morton_cpu_time = glfwGetTime() - morton_start_time;
+
+       double compare_upload_start_time = glfwGetTime();
+       std::vector<PointsChunkData> compare_points_chunk_data = upload_points(compare_points);
+       morton_compare_upload_time = glfwGetTime() - compare_upload_start_time;
+   }
 
-   auto all_points_image_data = CreateAllPointsImageData(points, device, queue, command_pool);
+   std::unique_ptr<MortonSort> morton_sort;
+   if (morton_sort_mode == MortonSortMode::GPU)
+   {
+       ComputePrimitivesShaderCodes primitives_shader_codes = { REDUCE_COMP_SHADER_STR, SCAN_COMP_SHADER_STR, COMPACT_COMP_SHADER_STR, HISTOGRAM_COMP_SHADER_STR, RADIX_SORT_COMP_SHADER_STR };
+       MortonSortPipelineFutures morton_sort_pipeline_futures = MortonSort::BuildPipelines(pipeline_builder, device, MORTON_SORT_COMP_SHADER_STR, primitives_shader_codes, create_compute_pipeline, points_storage_type, ComputePrimitives::IsSubgroupSupported(physical_device));
+       pipeline_builder.Wait();
+       morton_sort.reset(new MortonSort(MortonSort::GetPipelines(morton_sort_pipeline_futures), points_storage_type));
+   }
+
+   double upload_start_time = glfwGetTime();
+   std::vector<PointsChunkData> all_points_chunk_data = morton_sort ? morton_sort->CreateAllPointsData(points, queue, command_pool) : upload_points(points);
+   double upload_time = glfwGetTime() - upload_start_time;
    points.clear();
+   morton_sort.reset();
+
+   const char* upload_name = points_storage_type == PointsStorageType::BUFFER ? "direct write" : "staging copy";
+   if (morton_sort_mode == MortonSortMode::GPU)
+   {
+       upload_name = points_storage_type == PointsStorageType::BUFFER ? "gpu morton sort, buffer" : "gpu morton sort, image";
+   }
+   std::cout << "Upload(" << upload_name << "):" << upload_time * 1000.0 << "ms" << std::endl;
+   if (morton_sort_mode == MortonSortMode::CPU || is_morton_compare)
+   {
+       std::cout << "Morton sort(cpu):" << morton_cpu_time * 1000.0 << "ms" << std::endl;
+   }
+   if (is_morton_compare)
+   {
+       std::cout << "Morton compare: cpu sort + upload " << (morton_cpu_time + morton_compare_upload_time) * 1000.0 << "ms, gpu upload + sort " << upload_time * 1000.0 << "ms" << std::endl;
+   }
 
    MATRIXS_BUFFER_DATA matrixs_buffer_data = {};
 
@@ -616,12 +789,9 @@ int main()
    memcpy(mvp_ptr, &matrixs_buffer_data, sizeof(matrixs_buffer_data));
    matrixs_buffer->Unmap();
 
-   Turbo::Core::TRefPtr<Turbo::Core::TImage> depth_image = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::D32_SFLOAT, swapchain->GetWidth(), swapchain->GetHeight(), 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_DEPTH_STENCIL_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_INPUT_ATTACHMENT, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+   Turbo::Core::TRefPtr<Turbo::Core::TImage> depth_image = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::D32_SFLOAT, swapchain->GetWidth(), swapchain->GetHeight(), 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_DEPTH_STENCIL_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_INPUT_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
    Turbo::Core::TRefPtr<Turbo::Core::TImageView> depth_image_view = new Turbo::Core::TImageView(depth_image, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, depth_image->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_DEPTH_BIT, 0, 1, 0, 1);
 
-   Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> my_vertex_shader = new Turbo::Core::TVertexShader(device, Turbo::Core::TShaderLanguage::GLSL, MY_VERT_SHADER_STR);
-   Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> my_fragment_shader = new Turbo::Core::TFragmentShader(device, Turbo::Core::TShaderLanguage::GLSL, MY_FRAG_SHADER_STR);
-
    std::vector<Turbo::Core::TDescriptorSize> descriptor_sizes = {
        {Turbo::Core::TDescriptorType::UNIFORM_BUFFER, 1000},
        {Turbo::Core::TDescriptorType::COMBINED_IMAGE_SAMPLER, 1000},
@@ -652,56 +822,279 @@ int main()
    std::vector<Turbo::Core::TAttachment> attachments = { swapchain_color_attachment, depth_attachment };
 
    Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> render_pass = new Turbo::Core::TRenderPass(device, attachments, subpasses);
+
+   // HiZ culling splits the points subpass around the compute pass. Both passes only differ from render_pass in load/store ops and layouts,
+   // so they stay compatible with its pipelines and framebuffers. Phase 1 clears and keeps everything in attachment layouts, phase 2 loads it.
+   Turbo::Core::TAttachment hiz_first_color_attachment(swapchain_images[0]->GetFormat(), swapchain_images[0]->GetSampleCountBits(), Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::COLOR_ATTACHMENT_OPTIMAL);
+   Turbo::Core::TAttachment hiz_second_color_attachment(swapchain_images[0]->GetFormat(), swapchain_images[0]->GetSampleCountBits(), Turbo::Core::TLoadOp::LOAD, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::COLOR_ATTACHMENT_OPTIMAL, Turbo::Core::TImageLayout::PRESENT_SRC_KHR);
+   Turbo::Core::TAttachment hiz_second_depth_attachment(depth_image->GetFormat(), depth_image->GetSampleCountBits(), Turbo::Core::TLoadOp::LOAD, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+   std::vector<Turbo::Core::TAttachment> hiz_first_attachments = { hiz_first_color_attachment, depth_attachment };
+   std::vector<Turbo::Core::TAttachment> hiz_second_attachments = { hiz_second_color_attachment, hiz_second_depth_attachment };
+   Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> hiz_first_render_pass = new Turbo::Core::TRenderPass(device, hiz_first_attachments, subpasses);
+   Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> hiz_second_render_pass = new Turbo::Core::TRenderPass(device, hiz_second_attachments, subpasses);
+
+   // Progressive accumulation draws the points into its own target, the swapchain image is a copy of it with ImGui drawn over.
+   // The depth attachment keeps the accumulated depth, so this pass loads it too.
+   Turbo::Core::TAttachment accumulation_color_attachment(swapchain_images[0]->GetFormat(), swapchain_images[0]->GetSampleCountBits(), Turbo::Core::TLoadOp::LOAD, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, Turbo::Core::TImageLayout::PRESENT_SRC_KHR);
+   std::vector<Turbo::Core::TAttachment> accumulation_attachments = { accumulation_color_attachment, hiz_second_depth_attachment };
+   Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> accumulation_render_pass = new Turbo::Core::TRenderPass(device, accumulation_attachments, subpasses);
+   ProgressiveAccumulation progressive_accumulation(device, swapchain_images[0]->GetFormat(), depth_image->GetFormat(), subpasses);
+   progressive_accumulation.SetTargets(depth_image_view, swapchain->GetWidth(), swapchain->GetHeight());
+   bool is_accumulation = false;
+   int accumulation_slice_count = static_cast<int>(progressive_accumulation.GetSliceCount());
+
+   // Dynamic resolution draws the points into a scaled offscreen target and blits it into the swapchain image, ImGui stays at full resolution
+   std::vector<Turbo::Core::TAttachment> upscale_attachments = { accumulation_color_attachment, depth_attachment };
+   Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> upscale_render_pass = new Turbo::Core::TRenderPass(device, upscale_attachments, subpasses);
+   DynamicResolution dynamic_resolution(device, swapchain_images[0]->GetFormat(), depth_image->GetFormat(), subpasses);
+   dynamic_resolution.SetTargets(swapchain->GetWidth(), swapchain->GetHeight());
+   bool is_dynamic_resolution = false;
+   bool is_dynamic_resolution_auto = true; // false: the scale slider sets it
+   float dynamic_resolution_scale = static_cast<float>(dynamic_resolution.GetScale());
+   float dynamic_resolution_target = static_cast<float>(dynamic_resolution.GetTargetFrameTime());
+   uint32_t dynamic_resolution_resolved_count = 0; // GPU frames the scale has seen
    Turbo::Core::TViewport viewport(0, 0, surface->GetCurrentWidth(), surface->GetCurrentHeight(), 0, 1);
    Turbo::Core::TScissor scissor(0, 0, surface->GetCurrentWidth(), surface->GetCurrentHeight());
 
    std::vector<Turbo::Core::TVertexBinding> vertex_bindings;
 
-   Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> graphics_pipeline = new Turbo::Core::TGraphicsPipeline(render_pass, 0, vertex_bindings, my_vertex_shader, my_fragment_shader, Turbo::Core::TTopologyType::POINT_LIST, false, false, false, Turbo::Core::TPolygonMode::POINT, Turbo::Core::TCullModeBits::MODE_BACK_BIT, Turbo::Core::TFrontFace::CLOCKWISE, false, 0, 0, 0, 1, false, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, true, true, Turbo::Core::TCompareOp::LESS_OR_EQUAL, false, false, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TCompareOp::ALWAYS, 0, 0, 0, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TCompareOp::ALWAYS, 0, 0, 0, 0, 0, false, Turbo::Core::TLogicOp::NO_OP, true, Turbo::Core::TBlendFactor::SRC_ALPHA, Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA, Turbo::Core::TBlendOp::ADD, Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA, Turbo::Core::TBlendFactor::ZERO, Turbo::Core::TBlendOp::ADD);
-    // Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> graphics_pipeline = new Turbo::Core::TGraphicsPipeline(render_pass, 0, vertex_bindings, my_vertex_shader, my_fragment_shader, Turbo::Core::TTopologyType::POINT_LIST, false, false, false, Turbo::Core::TPolygonMode::POINT, Turbo::Core::TCullModeBits::MODE_BACK_BIT, Turbo::Core::TFrontFace::CLOCKWISE, false, 0, 0, 0, 1, false, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, false, false, Turbo::Core::TCompareOp::LESS_OR_EQUAL, false, false, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TCompareOp::ALWAYS, 0, 0, 0, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TCompareOp::ALWAYS, 0, 0, 0, 0, 0, false, Turbo::Core::TLogicOp::NO_OP, true, Turbo::Core::TBlendFactor::SRC_ALPHA, Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA, Turbo::Core::TBlendOp::ADD, Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA, Turbo::Core::TBlendFactor::ZERO, Turbo::Core::TBlendOp::ADD);
-   std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> graphics_pipeline_descriptor_sets;
-   for (const auto& points_image_data_item : all_points_image_data)
+   Turbo::Core::TVertexBinding imgui_vertex_binding(0, sizeof(ImDrawVert), Turbo::Core::TVertexRate::VERTEX);
+   imgui_vertex_binding.AddAttribute(0, Turbo::Core::TFormatType::R32G32_SFLOAT, IM_OFFSETOF(ImDrawVert, pos));
+   imgui_vertex_binding.AddAttribute(1, Turbo::Core::TFormatType::R32G32_SFLOAT, IM_OFFSETOF(ImDrawVert, uv));
+   imgui_vertex_binding.AddAttribute(2, Turbo::Core::TFormatType::R8G8B8A8_UNORM, IM_OFFSETOF(ImDrawVert, col));
+
+   std::vector<Turbo::Core::TVertexBinding> imgui_vertex_bindings = { imgui_vertex_binding };
+
+   // Every pipeline and its shaders are built as one job, the workers get the SPIR-V and the creators below run on this thread inside WaitFor()
+   double pipeline_start_time = glfwGetTime();
+   GraphicsPipelineState points_pipeline_state;
+   points_pipeline_state.vertexBindings = vertex_bindings;
+   points_pipeline_state.topology = Turbo::Core::TTopologyType::POINT_LIST;
+   points_pipeline_state.polygonMode = Turbo::Core::TPolygonMode::POINT;
+   points_pipeline_state.blendEnable = true;
+   points_pipeline_state.srcColorBlendFactor = Turbo::Core::TBlendFactor::SRC_ALPHA;
+   points_pipeline_state.dstColorBlendFactor = Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA;
+   points_pipeline_state.srcAlphaBlendFactor = Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA;
+   points_pipeline_state.dstAlphaBlendFactor = Turbo::Core::TBlendFactor::ZERO;
+
+   GraphicsPipelineState points_no_depth_pipeline_state = points_pipeline_state;
+   points_no_depth_pipeline_state.depthTestEnable = false;
+   points_no_depth_pipeline_state.depthWriteEnable = false;
+
+   GraphicsPipelineState imgui_pipeline_state;
+   imgui_pipeline_state.vertexBindings = imgui_vertex_bindings;
+   imgui_pipeline_state.depthTestEnable = false;
+   imgui_pipeline_state.depthWriteEnable = false;
+   imgui_pipeline_state.blendEnable = true;
+   imgui_pipeline_state.srcColorBlendFactor = Turbo::Core::TBlendFactor::SRC_ALPHA;
+   imgui_pipeline_state.dstColorBlendFactor = Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA;
+   imgui_pipeline_state.srcAlphaBlendFactor = Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA;
+   imgui_pipeline_state.dstAlphaBlendFactor = Turbo::Core::TBlendFactor::ZERO;
+
+   // Render mode switches go through graphics_pipeline_cache, the variants are created here so switching never compiles
+   GraphicsPipelineCache graphics_pipeline_cache(pipeline_cache);
+   const std::string points_vertex_shader_name = points_storage_type == PointsStorageType::BUFFER ? "PointCloudBuffer.vert" : "PointCloud.vert";
+   const std::string& points_vertex_shader_code = points_storage_type == PointsStorageType::BUFFER ? MY_BUFFER_VERT_SHADER_STR : MY_VERT_SHADER_STR;
+   Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> points_vertex_shader;
+   Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> points_fragment_shader;
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>> graphics_pipeline_future = pipeline_builder.BuildGraphicsPipeline(device, points_vertex_shader_name, points_vertex_shader_code, "PointCloud.frag", MY_FRAG_SHADER_STR, [&](const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader>& vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader>& fragmentShader) {
+       points_vertex_shader = vertexShader;
+       points_fragment_shader = fragmentShader;
+       return graphics_pipeline_cache.Get(render_pass, 0, vertexShader, fragmentShader, points_pipeline_state);
+   });
+   pipeline_builder.BuildGraphicsPipeline(device, points_vertex_shader_name, points_vertex_shader_code, "PointCloud.frag", MY_FRAG_SHADER_STR, [&](const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader>& vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader>& fragmentShader) {
+       return graphics_pipeline_cache.Get(render_pass, 0, vertexShader, fragmentShader, points_no_depth_pipeline_state);
+   });
+   // Per point culling draws the compacted point indices with the POINTS_INDEXED variant, it needs subgroup arithmetic for the compaction
+   const bool is_point_culling_supported = PointCulling::IsSupported(physical_device);
+   Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> points_indexed_vertex_shader;
+   Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> points_indexed_fragment_shader;
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>> indexed_graphics_pipeline_future;
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> point_cull_pipeline_future;
+   if (is_point_culling_supported)
+   {
+       indexed_graphics_pipeline_future = pipeline_builder.BuildGraphicsPipeline(device, points_vertex_shader_name, points_vertex_shader_code, "PointCloud.frag", MY_FRAG_SHADER_STR, [&](const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader>& vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader>& fragmentShader) {
+           points_indexed_vertex_shader = vertexShader;
+           points_indexed_fragment_shader = fragmentShader;
+           return graphics_pipeline_cache.Get(render_pass, 0, vertexShader, fragmentShader, points_pipeline_state);
+       }, { "POINTS_INDEXED" });
+       pipeline_builder.BuildGraphicsPipeline(device, points_vertex_shader_name, points_vertex_shader_code, "PointCloud.frag", MY_FRAG_SHADER_STR, [&](const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader>& vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader>& fragmentShader) {
+           return graphics_pipeline_cache.Get(render_pass, 0, vertexShader, fragmentShader, points_no_depth_pipeline_state);
+       }, { "POINTS_INDEXED" });
+   }
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>> imgui_pipeline_future = pipeline_builder.BuildGraphicsPipeline(device, "imgui.vert", IMGUI_VERT_SHADER_STR, "imgui.frag", IMGUI_FRAG_SHADER_STR, [&](const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader>& vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader>& fragmentShader) {
+       return graphics_pipeline_cache.Get(render_pass, 1, vertexShader, fragmentShader, imgui_pipeline_state);
+   });
+
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> hiz_pyramid_from_depth_pipeline_future = pipeline_builder.BuildComputePipeline(device, "HiZPyramid.comp", HIZ_PYRAMID_COMP_SHADER_STR, create_compute_pipeline, { "HIZ_FROM_DEPTH" });
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> hiz_pyramid_pipeline_future = pipeline_builder.BuildComputePipeline(device, "HiZPyramid.comp", HIZ_PYRAMID_COMP_SHADER_STR, create_compute_pipeline);
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> hiz_cull_pipeline_future = pipeline_builder.BuildComputePipeline(device, "HiZCull.comp", HIZ_CULL_COMP_SHADER_STR, create_compute_pipeline);
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> pull_from_target_pipeline_future = pipeline_builder.BuildComputePipeline(device, "PullPush.comp", PULL_PUSH_COMP_SHADER_STR, create_compute_pipeline, { "PULL_FROM_TARGET" });
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> pull_pipeline_future = pipeline_builder.BuildComputePipeline(device, "PullPush.comp", PULL_PUSH_COMP_SHADER_STR, create_compute_pipeline, { "PULL" });
+   std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> push_pipeline_future = pipeline_builder.BuildComputePipeline(device, "PullPush.comp", PULL_PUSH_COMP_SHADER_STR, create_compute_pipeline);
+   if (is_point_culling_supported)
    {
-       Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> pipeline_descriptor_set = descriptor_pool->Allocate(graphics_pipeline->GetPipelineLayout());
-       std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> points_pos_image_views = { points_image_data_item.pointsPositionImage.imageView };
-       std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> points_color_image_views = { points_image_data_item.pointsColorImage.imageView };
-       std::vector<Turbo::Core::TRefPtr<Turbo::Core::TBuffer>> matrixs_buffers = { matrixs_buffer };
+       std::vector<std::string> point_cull_defines;
+       if (points_storage_type == PointsStorageType::IMAGE)
+       {
+           point_cull_defines.push_back("POINTS_IMAGE");
+           point_cull_defines.push_back("TEX_SIZE " + std::to_string(TEX_SIZE));
+       }
+       point_cull_pipeline_future = pipeline_builder.BuildComputePipeline(device, "PointCull.comp", POINT_CULL_COMP_SHADER_STR, create_compute_pipeline, point_cull_defines);
+   }
 
-       pipeline_descriptor_set->BindData(0, 0, 0, matrixs_buffers);
-       pipeline_descriptor_set->BindData(0, 1, 0, points_pos_image_views);
-       pipeline_descriptor_set->BindData(0, 2, 0, points_color_image_views);
+   std::vector<Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer>> swpachain_framebuffers;
+   for (Turbo::Core::TRefPtr<Turbo::Core::TImageView> swapchain_image_view_item : swapchain_image_views)
+   {
+       std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> image_views;
+       image_views.push_back(swapchain_image_view_item);
+       image_views.push_back(depth_image_view);
 
-       graphics_pipeline_descriptor_sets.push_back(pipeline_descriptor_set);
+       Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> swapchain_framebuffer = new Turbo::Core::TFramebuffer(render_pass, image_views);
+       swpachain_framebuffers.push_back(swapchain_framebuffer);
    }
 
-    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer>> swpachain_framebuffers;
-    for (Turbo::Core::TRefPtr<Turbo::Core::TImageView> swapchain_image_view_item : swapchain_image_views)
-    {
-        std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> image_views;
-        image_views.push_back(swapchain_image_view_item);
-        image_views.push_back(depth_image_view);
+   // Loading: present a cleared frame with a progress bar of the finished pipeline jobs until all of them finished.
+   // NOTE: WaitFor() wraps the SPIR-V into shaders and creates the pipelines on this thread, a frame is drawn between two WaitFor()s
+   glfwSetWindowTitle(window, "Turbo - building pipelines...");
+   while (!pipeline_builder.WaitFor(std::chrono::milliseconds(16)))
+   {
+       glfwPollEvents();
 
-        Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> swapchain_framebuffer = new Turbo::Core::TFramebuffer(render_pass, image_views);
-        swpachain_framebuffers.push_back(swapchain_framebuffer);
-    }
+       uint32_t loading_image_index = UINT32_MAX;
+       DevicePools::Semaphore loading_image_ready = device_pools.AcquireSemaphore(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT);
+       if (swapchain->AcquireNextImageUntil(loading_image_ready->Get(), nullptr, &loading_image_index) != Turbo::Core::TResult::SUCCESS)
+       {
+           // minimized or out of date, the swapchain is recreated by the first frame of the main loop
+           loading_image_ready->Discard();
+           continue;
+       }
+
+       uint32_t loading_width = swapchain->GetWidth();
+       uint32_t loading_height = swapchain->GetHeight();
+       uint32_t job_count = std::max(pipeline_builder.GetJobCount(), 1u);
+       uint32_t finished_job_count = job_count - std::min(pipeline_builder.GetPendingCount(), job_count);
+
+       VkClearAttachment background_clear = {};
+       background_clear.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+       background_clear.colorAttachment = 0;
+       background_clear.clearValue.color = { { 0.1f, 0.1f, 0.1f, 1.0f } };
+       VkClearRect background_rect = {};
+       background_rect.rect.extent = { loading_width, loading_height };
+       background_rect.layerCount = 1;
+
+       VkClearAttachment progress_clear = background_clear;
+       progress_clear.clearValue.color = { { 0.3f, 0.6f, 0.9f, 1.0f } };
+       VkClearRect progress_rect = background_rect;
+       progress_rect.rect.offset = { static_cast<int32_t>(loading_width / 8), static_cast<int32_t>(loading_height / 2) };
+       progress_rect.rect.extent = { loading_width * 3 / 4 * finished_job_count / job_count, std::max(loading_height / 32, 1u) };
+
+       command_buffer->Begin();
+       command_buffer->CmdBeginRenderPass(render_pass, swpachain_framebuffers[loading_image_index]);
+       device->GetDeviceDriver()->vkCmdClearAttachments(command_buffer->GetVkCommandBuffer(), 1, &background_clear, 1, &background_rect);
+       if (progress_rect.rect.extent.width > 0)
+       {
+           device->GetDeviceDriver()->vkCmdClearAttachments(command_buffer->GetVkCommandBuffer(), 1, &progress_clear, 1, &progress_rect);
+       }
+       command_buffer->CmdNextSubpass();
+       command_buffer->CmdEndRenderPass();
+       command_buffer->End();
+
+       DevicePools::Fence loading_fence = device_pools.AcquireFence();
+       queue->Submit({ loading_image_ready->Get() }, {}, command_buffer, loading_fence->Get());
+       loading_fence->Get()->WaitUntil();
+       command_buffer->Reset();
+       queue->Present(swapchain, loading_image_index);
+   }
+   glfwSetWindowTitle(window, "Turbo");
+
+   Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> graphics_pipeline = graphics_pipeline_future.get();
+   Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> imgui_pipeline = imgui_pipeline_future.get();
+   double pipeline_create_time = glfwGetTime() - pipeline_start_time;
+   bool is_depth_test = true;
+   std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> graphics_pipeline_descriptor_sets;
+   for (const auto& points_chunk_data_item : all_points_chunk_data)
+   {
+       graphics_pipeline_descriptor_sets.push_back(CreatePointsDescriptorSet(descriptor_pool, graphics_pipeline->GetPipelineLayout(), matrixs_buffer, points_chunk_data_item, points_storage_type));
+   }
+
+   HiZCulling hiz_culling(descriptor_pool, hiz_pyramid_from_depth_pipeline_future.get(), hiz_pyramid_pipeline_future.get(), hiz_cull_pipeline_future.get(), all_points_chunk_data);
+   hiz_culling.SetDepthImage(depth_image_view, swapchain->GetWidth(), swapchain->GetHeight());
+   bool is_hiz_culling = false;
+   bool is_hiz_occlusion = true; // false: frustum culling only
+
+   // Hole filling draws the points into its own target and fills the gaps between them before the blit into the swapchain image.
+   // Drawing 1 in N points shows how far the point budget can drop with it.
+   HoleFilling hole_filling(descriptor_pool, pull_from_target_pipeline_future.get(), pull_pipeline_future.get(), push_pipeline_future.get(), swapchain_images[0]->GetFormat(), depth_image->GetFormat(), subpasses);
+   hole_filling.SetTargets(swapchain->GetWidth(), swapchain->GetHeight());
+   bool is_hole_filling = false;
+   int hole_filling_level_count = static_cast<int>(hole_filling.GetLevelCount());
+   float hole_filling_depth_threshold = hole_filling.GetDepthThreshold();
+   float hole_filling_min_coverage = hole_filling.GetMinCoverage();
+   int hole_filling_point_stride = 1;
+
+   std::unique_ptr<PointCulling> point_culling;
+   Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> indexed_graphics_pipeline;
+   if (is_point_culling_supported)
+   {
+       point_culling.reset(new PointCulling(descriptor_pool, point_cull_pipeline_future.get(), matrixs_buffer, all_points_chunk_data, points_storage_type));
+       indexed_graphics_pipeline = indexed_graphics_pipeline_future.get();
+   }
+   bool is_point_culling = false;
+   bool is_clip_plane = false;
+   int clip_plane_axis = 0; // x, y, z
+   float clip_plane_offset = 0.0f;
+   bool is_clip_plane_flipped = false;
+
+   std::vector<PointsDrawItem> points_draw_items;
+   for (size_t points_chunk_index = 0; points_chunk_index < all_points_chunk_data.size(); points_chunk_index++)
+   {
+       PointsDrawItem points_draw_item;
+       points_draw_item.descriptorSet = graphics_pipeline_descriptor_sets[points_chunk_index]->GetDescriptorSet()[0]->GetVkDescriptorSet();
+       points_draw_item.count = all_points_chunk_data[points_chunk_index].count;
+       points_draw_items.push_back(points_draw_item);
+   }
+
+   // Nearest chunks first, the depth test then rejects the points behind them before they are shaded
+   ChunkOrder chunk_order(all_points_chunk_data);
+   bool is_front_to_back = true;
+   std::vector<PointsDrawItem> ordered_points_draw_items = points_draw_items;
+   // NOTE: without VK_QUERY_CONTROL_PRECISE_BIT an occlusion query only tells zero from non zero samples, so it is shown as visible or not.
+   // occlusionQueryPrecise, pipelineStatisticsQuery and fragmentStoresAndAtomics (a fragment counter) can not be enabled through TPhysicalDeviceFeatures
+   QueryPool fragment_query_pool(device, VK_QUERY_TYPE_OCCLUSION, 1);
+   bool is_points_visibles[2] = { false, false }; // [is_front_to_back] of the last inline points pass
+
+   // record_thread_count == 0 records the points draws inline into the primary command buffer
+   // Secondary command buffers inherit the framebuffer, so the cached points commands are kept per swapchain image
+   std::vector<std::unique_ptr<PointsDrawRecorder>> points_draw_recorders;
+   for (size_t swapchain_image_index = 0; swapchain_image_index < swapchain_images.size(); swapchain_image_index++)
+   {
+       points_draw_recorders.emplace_back(new PointsDrawRecorder(queue, worker_pool));
+   }
+   bool is_cache_points_commands = true;
+   uint64_t points_commands_generation = 0; // bump it whenever the drawn chunks or the framebuffers change
+   const int record_thread_counts[] = { 0, 1, 2, 4, 8 };
+   const char* record_thread_count_names[] = { "Inline", "1", "2", "4", "8" };
+   int record_thread_count_index = 3;
+   double record_time = 0;
+
+   struct RecordBenchmarkResult
+   {
+       uint32_t threadCount;
+       size_t drawCount;
+       double recordTime;
+   };
+   std::vector<RecordBenchmarkResult> record_benchmark_results;
+
+   GpuProfiler gpu_profiler(queue);
 
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO();
     ImGui::StyleColorsDark();
 
     auto imgui_sampler = Turbo::Core::TRefPtr<Turbo::Core::TSampler>(new Turbo::Core::TSampler(device));
-    auto imgui_vertex_shader = Turbo::Core::TRefPtr<Turbo::Core::TShader>(new Turbo::Core::TShader(device, Turbo::Core::TShaderType::VERTEX, Turbo::Core::TShaderLanguage::GLSL, IMGUI_VERT_SHADER_STR));
-    auto imgui_fragment_shader = Turbo::Core::TRefPtr<Turbo::Core::TShader>(new Turbo::Core::TShader(device, Turbo::Core::TShaderType::FRAGMENT, Turbo::Core::TShaderLanguage::GLSL, IMGUI_FRAG_SHADER_STR));
-
-    Turbo::Core::TVertexBinding imgui_vertex_binding(0, sizeof(ImDrawVert), Turbo::Core::TVertexRate::VERTEX);
-    imgui_vertex_binding.AddAttribute(0, Turbo::Core::TFormatType::R32G32_SFLOAT, IM_OFFSETOF(ImDrawVert, pos));
-    imgui_vertex_binding.AddAttribute(1, Turbo::Core::TFormatType::R32G32_SFLOAT, IM_OFFSETOF(ImDrawVert, uv));
-    imgui_vertex_binding.AddAttribute(2, Turbo::Core::TFormatType::R8G8B8A8_UNORM, IM_OFFSETOF(ImDrawVert, col));
-
-    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TShader>> imgui_shaders = { imgui_vertex_shader, imgui_fragment_shader };
-    std::vector<Turbo::Core::TVertexBinding> imgui_vertex_bindings = { imgui_vertex_binding };
-
-    auto imgui_pipeline = Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>(new Turbo::Core::TGraphicsPipeline(render_pass, 1, imgui_vertex_bindings, imgui_shaders, Turbo::Core::TTopologyType::TRIANGLE_LIST, false, false, false, Turbo::Core::TPolygonMode::FILL, Turbo::Core::TCullModeBits::MODE_BACK_BIT, Turbo::Core::TFrontFace::CLOCKWISE, false, 0, 0, 0, 1, false, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, false, false, Turbo::Core::TCompareOp::LESS_OR_EQUAL, false, false, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TCompareOp::ALWAYS, 0, 0, 0, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TStencilOp::KEEP, Turbo::Core::TCompareOp::ALWAYS, 0, 0, 0, 0, 0, false, Turbo::Core::TLogicOp::NO_OP, true, Turbo::Core::TBlendFactor::SRC_ALPHA, Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA, Turbo::Core::TBlendOp::ADD, Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA, Turbo::Core::TBlendFactor::ZERO, Turbo::Core::TBlendOp::ADD));
+    std::cout << "Shader cache:" << shader_cache.GetHitCount() << " hit, " << shader_cache.GetMissCount() << " miss" << std::endl;
+    std::cout << "Pipeline creation(" << (is_pipeline_cache_warm ? "warm" : "cold") << " cache, " << pipeline_builder.GetJobCount() << " jobs):" << pipeline_create_time * 1000.0 << "ms" << std::endl;
 
     unsigned char* imgui_font_pixels;
     int imgui_font_width, imgui_font_height;
@@ -750,17 +1143,88 @@ int main()
     float angle = 0.0f;
     float _time = glfwGetTime();
 
+    std::vector<CameraPathFrame> recorded_camera_path;
+
+    bool is_trace_key_down = false;
+    uint32_t trace_capture_index = 0;
+    std::string trace_status;
+
+    uint32_t on_demand_frame_count = ON_DEMAND_FRAME_COUNT; // frames still to draw before idling
+    uint64_t on_demand_idle_count = 0;
+
     while (!glfwWindowShouldClose(window))
     {
+        if (is_on_demand && on_demand_frame_count == 0 && !g_IsRedrawRequested)
+        {
+            // nothing is acquired, recorded or presented while idle, the presentation engine keeps showing the last image
+            TRACE_ZONE("Idle");
+            glfwWaitEventsTimeout(ON_DEMAND_WAIT_TIMEOUT);
+            on_demand_idle_count++;
+            if (!g_IsRedrawRequested)
+            {
+                continue;
+            }
+            _time = 0.0f; // the time spent idle is no camera movement
+        }
+
+        TRACE_ZONE("Frame");
         glfwPollEvents();
+        worker_pool.RunMainThreadTasks(); // TaskAffinity::MAIN_THREAD tasks which became ready since the last frame
+        if (g_IsRedrawRequested.exchange(false))
+        {
+            on_demand_frame_count = ON_DEMAND_FRAME_COUNT;
+        }
+        // held keys do not repeat events every frame, keep the camera moving while one is down
+        for (int camera_key : { GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D })
+        {
+            if (glfwGetKey(window, camera_key) == GLFW_PRESS)
+            {
+                on_demand_frame_count = ON_DEMAND_FRAME_COUNT;
+            }
+        }
+
+        // F9 starts/stops a capture, each one is written to ./trace_<index>.json
+        bool is_trace_key_pressed = glfwGetKey(window, GLFW_KEY_F9) == GLFW_PRESS;
+        if (is_trace_key_pressed && !is_trace_key_down)
+        {
+            if (Trace::IsCapturing())
+            {
+                std::string trace_path = trace_startup_frame_count > 0 ? TRACE_STARTUP_PATH : "./trace_" + std::to_string(trace_capture_index++) + ".json";
+                trace_startup_frame_count = 0;
+                trace_status = Trace::EndCapture(trace_path) ? "Saved " + trace_path : "Failed to write " + trace_path;
+            }
+            else
+            {
+                Trace::BeginCapture();
+            }
+        }
+        is_trace_key_down = is_trace_key_pressed;
 
         // <Begin Rendering>
         uint32_t current_image_index = UINT32_MAX;
-        Turbo::Core::TRefPtr<Turbo::Core::TSemaphore> wait_image_ready = new Turbo::Core::TSemaphore(device, Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT);
-        Turbo::Core::TResult result = swapchain->AcquireNextImageUntil(wait_image_ready, nullptr, &current_image_index);
+        DevicePools::Semaphore wait_image_ready = device_pools.AcquireSemaphore(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT);
+        Turbo::Core::TResult result;
+        {
+            TRACE_ZONE("Acquire");
+            frame_pacing.BeginAcquire();
+            result = swapchain->AcquireNextImageUntil(wait_image_ready->Get(), nullptr, &current_image_index);
+            frame_pacing.EndAcquire();
+        }
+        if (result != Turbo::Core::TResult::SUCCESS)
+        {
+            // a suboptimal acquire may still signal it and nothing will wait on it, never hand it out again
+            wait_image_ready->Discard();
+        }
 
         if (result == Turbo::Core::TResult::SUCCESS)
         {
+            if (frame_pacing.GetPolicy() == FramePacingPolicy::LOW_LATENCY)
+            {
+                // the acquire waited for the display to release an image, pick up what happened meanwhile
+                TRACE_ZONE("Poll events");
+                glfwPollEvents();
+            }
+
             int window_w, window_h;
             int display_w, display_h;
             glfwGetWindowSize(window, &window_w, &window_h);
@@ -776,6 +1240,7 @@ int main()
             _time = current_time;
 
             // Update Mouse and Keyboard
+            frame_pacing.MarkInput();
             {
                 ImGuiIO& io = ImGui::GetIO();
                 for (int i = 0; i < IM_ARRAYSIZE(io.MouseDown); i++)
@@ -840,7 +1305,6 @@ int main()
                 glm::vec3 forward_dir = look_forward;
                 glm::vec3 up_dir = glm::vec3(0.0f, 0.0f, 1.0f);
                 glm::vec3 right_dir = glm::normalize(glm::cross(up_dir, forward_dir));
-                up_dir = glm::normalize(glm::cross(right_dir, forward_dir));
 
                 if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
                 {
@@ -860,17 +1324,20 @@ int main()
                 }
 
                 model = glm::mat4(1.0f);
-                glm::vec3 look_point = camera_position + forward_dir;
-                view = glm::lookAt(camera_position, look_point, up_dir);
+                view = GetCameraView(camera_position, horizontal_angle, vertical_angle);
+                if (!record_camera_path_file.empty())
+                {
+                    CameraPathFrame camera_path_frame;
+                    camera_path_frame.position = camera_position;
+                    camera_path_frame.yaw = horizontal_angle;
+                    camera_path_frame.pitch = vertical_angle;
+                    recorded_camera_path.push_back(camera_path_frame);
+                }
                 projection = glm::perspective(glm::radians(45.0f), (float)(swapchain->GetWidth() <= 0 ? 1 : swapchain->GetWidth()) / (float)(swapchain->GetHeight() <= 0 ? 1 : swapchain->GetHeight()), 0.1f, 300.0f);
 
                 matrixs_buffer_data.m = model;
                 matrixs_buffer_data.v = view;
                 matrixs_buffer_data.p = projection;
-
-                void* _ptr = matrixs_buffer->Map();
-                memcpy(_ptr, &matrixs_buffer_data, sizeof(matrixs_buffer_data));
-                matrixs_buffer->Unmap();
             }
 
             ImGui::NewFrame();
@@ -880,6 +1347,249 @@ int main()
                 ImGui::Text("Push down and drag mouse right button to rotate view.");
                 ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
                 ImGui::Text((std::string("All point count : ") + std::to_string(all_point_count)).c_str());
+                ImGui::Text("Upload %s : %.3f ms", upload_name, upload_time * 1000.0);
+                if (morton_sort_mode == MortonSortMode::CPU || is_morton_compare)
+                {
+                    ImGui::Text("Morton sort cpu : %.3f ms", morton_cpu_time * 1000.0);
+                }
+                if (is_morton_compare)
+                {
+                    ImGui::Text("Morton compare : cpu sort + upload %.3f ms, gpu %.3f ms", (morton_cpu_time + morton_compare_upload_time) * 1000.0, upload_time * 1000.0);
+                }
+                ImGui::Combo("Record threads", &record_thread_count_index, record_thread_count_names, IM_ARRAYSIZE(record_thread_count_names));
+                ImGui::Text("Shader cache : %u hit %u miss", shader_cache.GetHitCount(), shader_cache.GetMissCount());
+                ImGui::Text("Pipeline creation %s cache : %.3f ms (%u jobs)", is_pipeline_cache_warm ? "warm" : "cold", pipeline_create_time * 1000.0, pipeline_builder.GetJobCount());
+                ImGui::Checkbox("Cache points commands", &is_cache_points_commands);
+                ImGui::Checkbox("Render on demand", &is_on_demand);
+                if (is_on_demand)
+                {
+                    ImGui::SameLine();
+                    ImGui::Text("(%llu idle waits)", static_cast<unsigned long long>(on_demand_idle_count));
+                }
+                if (ImGui::Checkbox("Depth test", &is_depth_test))
+                {
+                    const GraphicsPipelineState& points_state = is_depth_test ? points_pipeline_state : points_no_depth_pipeline_state;
+                    graphics_pipeline = graphics_pipeline_cache.Get(render_pass, 0, points_vertex_shader, points_fragment_shader, points_state);
+                    if (is_point_culling_supported)
+                    {
+                        indexed_graphics_pipeline = graphics_pipeline_cache.Get(render_pass, 0, points_indexed_vertex_shader, points_indexed_fragment_shader, points_state);
+                    }
+                    points_commands_generation++;
+                    progressive_accumulation.Reset();
+                }
+                ImGui::Text("Pipelines : %zu (%u hit %u miss)", graphics_pipeline_cache.GetPipelineCount(), graphics_pipeline_cache.GetHitCount(), graphics_pipeline_cache.GetMissCount());
+                ImGui::Text("Points record : %.3f ms (%d draws)", record_time * 1000.0, (int)points_draw_items.size());
+                if (ImGui::CollapsingHeader("Chunk order"))
+                {
+                    if (ImGui::Checkbox("Front to back", &is_front_to_back) && !is_front_to_back)
+                    {
+                        chunk_order.Reset();
+                        ordered_points_draw_items = points_draw_items;
+                        points_commands_generation++;
+                    }
+                    ImGui::Text("Chunks moved last frame : %u", chunk_order.GetMoveCount());
+                    ImGui::Text("Points passing depth test (Inline record threads only) :");
+                    ImGui::Text("  load order : %s", is_points_visibles[0] ? "visible" : "not visible");
+                    ImGui::Text("  front to back : %s", is_points_visibles[1] ? "visible" : "not visible");
+                }
+                if (ImGui::CollapsingHeader("Frame pacing"))
+                {
+                    const Turbo::Extension::TPresentMode present_modes[] = { Turbo::Extension::TPresentMode::FIFO, Turbo::Extension::TPresentMode::FIFO_RELAXED, Turbo::Extension::TPresentMode::MAILBOX, Turbo::Extension::TPresentMode::IMMEDIATE };
+                    if (ImGui::BeginCombo("Present mode", GetPresentModeName(present_mode)))
+                    {
+                        for (Turbo::Extension::TPresentMode present_mode_item : present_modes)
+                        {
+                            bool is_supported = ChoosePresentMode(surface, present_mode_item) == present_mode_item;
+                            if (ImGui::Selectable(GetPresentModeName(present_mode_item), present_mode_item == present_mode, is_supported ? 0 : ImGuiSelectableFlags_Disabled) && present_mode_item != present_mode)
+                            {
+                                present_mode = present_mode_item;
+                                is_swapchain_dirty = true;
+                            }
+                        }
+                        ImGui::EndCombo();
+                    }
+                    int image_count = static_cast<int>(swapchain_image_count);
+                    int max_image_count_item = static_cast<int>(max_image_count > 0 ? std::min(max_image_count, 8u) : 8u);
+                    if (ImGui::SliderInt("Swapchain images", &image_count, static_cast<int>(min_image_count), max_image_count_item) && static_cast<uint32_t>(image_count) != swapchain_image_count)
+                    {
+                        swapchain_image_count = static_cast<uint32_t>(image_count);
+                        is_swapchain_dirty = true;
+                    }
+                    bool is_low_latency = frame_pacing.GetPolicy() == FramePacingPolicy::LOW_LATENCY;
+                    if (ImGui::Checkbox("Sample input after the acquire", &is_low_latency))
+                    {
+                        frame_pacing.SetPolicy(is_low_latency ? FramePacingPolicy::LOW_LATENCY : FramePacingPolicy::THROUGHPUT);
+                    }
+                    ImGui::Text("Refresh %.2f ms, acquire wait %.2f ms", frame_pacing.GetRefreshPeriod(), frame_pacing.GetAcquireWaitTime());
+                    ImGui::Text("Input to photon (estimate) : %.2f ms", frame_pacing.GetLatency());
+                    ImGui::Text("  input to present %.2f ms + display %.2f ms", frame_pacing.GetInputToPresentTime(), frame_pacing.GetDisplayDelay());
+                }
+                if (ImGui::CollapsingHeader("Progressive accumulation"))
+                {
+                    if (ImGui::Checkbox("Accumulate while still (records inline, overrides HiZ)", &is_accumulation))
+                    {
+                        progressive_accumulation.Reset();
+                    }
+                    if (ImGui::SliderInt("Slices", &accumulation_slice_count, 1, 64))
+                    {
+                        progressive_accumulation.SetSliceCount(static_cast<uint32_t>(accumulation_slice_count));
+                    }
+                    if (is_accumulation)
+                    {
+                        ImGui::Text("Accumulated %u / %u slices%s", progressive_accumulation.GetAccumulatedSliceCount(), progressive_accumulation.GetSliceCount(), progressive_accumulation.IsConverged() ? " (converged)" : "");
+                    }
+                }
+                if (ImGui::CollapsingHeader("Dynamic resolution"))
+                {
+                    ImGui::Checkbox("Scale the points pass (records inline, overrides HiZ)", &is_dynamic_resolution);
+                    ImGui::Checkbox("Auto from GPU frame time", &is_dynamic_resolution_auto);
+                    if (is_dynamic_resolution_auto && gpu_profiler.IsSupported())
+                    {
+                        if (ImGui::SliderFloat("Target GPU ms", &dynamic_resolution_target, 4.0f, 50.0f, "%.1f"))
+                        {
+                            dynamic_resolution.SetTargetFrameTime(dynamic_resolution_target);
+                        }
+                    }
+                    else if (ImGui::SliderFloat("Scale", &dynamic_resolution_scale, static_cast<float>(DynamicResolution::MIN_SCALE), static_cast<float>(DynamicResolution::MAX_SCALE), "%.2f"))
+                    {
+                        dynamic_resolution.SetScale(dynamic_resolution_scale);
+                    }
+                    if (is_dynamic_resolution)
+                    {
+                        ImGui::Text("Points pass %u x %u (%.0f%%)", dynamic_resolution.GetRenderWidth(), dynamic_resolution.GetRenderHeight(), dynamic_resolution.GetScale() * 100.0);
+                    }
+                }
+                if (ImGui::CollapsingHeader("Hole filling"))
+                {
+                    ImGui::Checkbox("Pull-push fill (records inline, overrides HiZ)", &is_hole_filling);
+                    if (ImGui::SliderInt("Levels", &hole_filling_level_count, 1, static_cast<int>(HoleFilling::MAX_LEVEL_COUNT)))
+                    {
+                        hole_filling.SetLevelCount(static_cast<uint32_t>(hole_filling_level_count));
+                    }
+                    if (ImGui::SliderFloat("Depth threshold", &hole_filling_depth_threshold, 0.0f, 1.0f))
+                    {
+                        hole_filling.SetDepthThreshold(hole_filling_depth_threshold);
+                    }
+                    if (ImGui::SliderFloat("Min coverage", &hole_filling_min_coverage, 0.0f, 1.0f))
+                    {
+                        hole_filling.SetMinCoverage(hole_filling_min_coverage);
+                    }
+                    ImGui::SliderInt("Draw 1 in N points", &hole_filling_point_stride, 1, 8);
+                    ImGui::Text("Holes up to %u px, %u levels", 1u << (hole_filling.GetLevelCount() - 1), hole_filling.GetLevelCount());
+                }
+                if (ImGui::CollapsingHeader("Point culling"))
+                {
+                    if (!is_point_culling_supported)
+                    {
+                        ImGui::Text("Needs subgroup arithmetic in compute shaders");
+                    }
+                    else
+                    {
+                        ImGui::Checkbox("Per point compute culling (records inline, overrides HiZ)", &is_point_culling);
+                        ImGui::Checkbox("Clip plane", &is_clip_plane);
+                        if (is_clip_plane)
+                        {
+                            const char* clip_plane_axis_names[] = { "X", "Y", "Z" };
+                            ImGui::Combo("Clip axis", &clip_plane_axis, clip_plane_axis_names, IM_ARRAYSIZE(clip_plane_axis_names));
+                            ImGui::SliderFloat("Clip offset", &clip_plane_offset, -50.0f, 50.0f);
+                            ImGui::Checkbox("Keep the other side", &is_clip_plane_flipped);
+                        }
+                        if (is_point_culling)
+                        {
+                            ImGui::Text("Points drawn : %u of %u (%.1f%%)", point_culling->GetVisiblePointCount(), point_culling->GetPointCount(), point_culling->GetPointCount() > 0 ? 100.0 * point_culling->GetVisiblePointCount() / point_culling->GetPointCount() : 0.0);
+                        }
+                    }
+                }
+                if (ImGui::CollapsingHeader("HiZ culling"))
+                {
+                    ImGui::Checkbox("Two phase culling (records inline)", &is_hiz_culling);
+                    ImGui::Checkbox("Occlusion test", &is_hiz_occlusion);
+                    if (is_hiz_culling)
+                    {
+                        ImGui::Text("Chunks : %u, pyramid levels : %u", hiz_culling.GetChunkCount(), hiz_culling.GetPyramidLevelCount());
+                        ImGui::Text("Visible : %u (%u newly visible in phase 2)", hiz_culling.GetVisibleCount(), hiz_culling.GetNewlyVisibleCount());
+                        ImGui::Text("Frustum culled : %u", hiz_culling.GetFrustumCulledCount());
+                        ImGui::Text("Occlusion culled : %u", hiz_culling.GetOcclusionCulledCount());
+                    }
+                }
+                if (ImGui::Button("Benchmark record"))
+                {
+                    // CPU record time against draw count with 1, 2, 4 and 8 threads, nothing is submitted
+                    record_benchmark_results.clear();
+                    for (uint32_t thread_count : { 1u, 2u, 4u, 8u })
+                    {
+                        for (size_t draw_count : { points_draw_items.size() / 4, points_draw_items.size() / 2, points_draw_items.size() })
+                        {
+                            std::vector<PointsDrawItem> draw_items(points_draw_items.begin(), points_draw_items.begin() + draw_count);
+                            points_draw_recorders[0]->SetRangeCount(thread_count);
+
+                            const int iteration_count = 16;
+                            double time_sum = 0;
+                            for (int iteration = 0; iteration < iteration_count; iteration++)
+                            {
+                                points_draw_recorders[0]->Record(render_pass, swpachain_framebuffers[0], 0, graphics_pipeline, viewport, scissor, draw_items);
+                                time_sum += points_draw_recorders[0]->GetRecordTime();
+                            }
+
+                            record_benchmark_results.push_back({ thread_count, draw_count, time_sum / iteration_count });
+                            std::cout << "Record benchmark::threads::" << thread_count << "::draws::" << draw_count << "::" << time_sum / iteration_count * 1000.0 << "ms" << std::endl;
+                        }
+                    }
+                }
+                for (const RecordBenchmarkResult& result_item : record_benchmark_results)
+                {
+                    ImGui::Text("%u threads, %zu draws : %.3f ms", result_item.threadCount, result_item.drawCount, result_item.recordTime * 1000.0);
+                }
+
+                if (ImGui::CollapsingHeader("CPU trace"))
+                {
+                    ImGui::Text("F9 : %s", Trace::IsCapturing() ? "capturing, press again to save" : "start a capture");
+                    if (!trace_status.empty())
+                    {
+                        ImGui::Text("%s (%u events dropped)", trace_status.c_str(), Trace::GetDroppedEventCount());
+                    }
+                }
+
+                if (ImGui::CollapsingHeader("GPU profiler", ImGuiTreeNodeFlags_DefaultOpen))
+                {
+                    if (!gpu_profiler.IsSupported())
+                    {
+                        ImGui::Text("Timestamps are not supported by this queue");
+                    }
+                    else
+                    {
+                        ImGui::Text("Resolved %u frames, dropped %u (%u frames latency)", gpu_profiler.GetResolvedFrameCount(), gpu_profiler.GetDroppedFrameCount(), GpuProfiler::FRAME_COUNT);
+                        if (ImGui::BeginTable("GPU zones", 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+                        {
+                            ImGui::TableSetupColumn("Zone");
+                            ImGui::TableSetupColumn("Last (ms)");
+                            ImGui::TableSetupColumn("Average (ms)");
+                            ImGui::TableHeadersRow();
+                            for (const GpuProfiler::Zone& zone_item : gpu_profiler.GetZones())
+                            {
+                                ImGui::TableNextRow();
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%s", zone_item.name.c_str());
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%.3f", zone_item.time);
+                                ImGui::TableNextColumn();
+                                ImGui::Text("%.3f", zone_item.average);
+                            }
+                            ImGui::EndTable();
+                        }
+                        for (const GpuProfiler::Zone& zone_item : gpu_profiler.GetZones())
+                        {
+                            ImGui::PlotLines(zone_item.name.c_str(), zone_item.history.data(), (int)zone_item.history.size(), (int)gpu_profiler.GetHistoryOffset(), nullptr, 0.0f, FLT_MAX, ImVec2(0, 40));
+                        }
+                        if (ImGui::Button("Export CSV"))
+                        {
+                            if (!gpu_profiler.ExportCsv(GPU_PROFILE_CSV_PATH))
+                            {
+                                std::cerr << "Failed to write " << GPU_PROFILE_CSV_PATH << std::endl;
+                            }
+                        }
+                    }
+                }
                 ImGui::End();
             }
 
@@ -887,19 +1597,218 @@ int main()
             Turbo::Core::TViewport frame_viewport(0, 0, swapchain->GetWidth() <= 0 ? 1 : swapchain->GetWidth(), swapchain->GetHeight(), 0, 1);
             Turbo::Core::TScissor frame_scissor(0, 0, swapchain->GetWidth() <= 0 ? 1 : swapchain->GetWidth(), swapchain->GetHeight() <= 0 ? 1 : swapchain->GetHeight());
 
+            int record_thread_count = record_thread_counts[record_thread_count_index];
+
+            // a still camera draws the next slice of the points, a converged accumulation draws none
+            bool is_accumulation_frame = is_accumulation;
+            bool is_accumulation_slice = is_accumulation_frame && progressive_accumulation.Update(projection * view * model);
+            bool is_dynamic_resolution_frame = is_dynamic_resolution && !is_accumulation_frame;
+            bool is_hole_filling_frame = is_hole_filling && !is_accumulation_frame && !is_dynamic_resolution_frame;
+            bool is_point_culling_frame = is_point_culling && is_point_culling_supported && !is_accumulation_frame && !is_dynamic_resolution_frame && !is_hole_filling_frame;
+            bool is_hiz_frame = is_hiz_culling && !is_accumulation_frame && !is_dynamic_resolution_frame && !is_hole_filling_frame && !is_point_culling_frame;
+            bool is_fragment_query_frame = !is_accumulation_frame && !is_dynamic_resolution_frame && !is_hole_filling_frame && !is_point_culling_frame && !is_hiz_frame && record_thread_count == 0;
+            if (is_front_to_back)
+            {
+                TRACE_ZONE("Chunk order");
+                glm::vec3 model_camera_position = glm::vec3(glm::inverse(view * model)[3]);
+                if (chunk_order.Update(model_camera_position))
+                {
+                    for (size_t order_index = 0; order_index < chunk_order.GetOrder().size(); order_index++)
+                    {
+                        ordered_points_draw_items[order_index] = points_draw_items[chunk_order.GetOrder()[order_index]];
+                    }
+                    points_commands_generation++;
+                }
+            }
+            if (is_dynamic_resolution_frame && is_dynamic_resolution_auto && gpu_profiler.GetResolvedFrameCount() != dynamic_resolution_resolved_count)
+            {
+                // "Frame" of the newest resolved GPU frame, it lags GpuProfiler::FRAME_COUNT frames
+                dynamic_resolution_resolved_count = gpu_profiler.GetResolvedFrameCount();
+                for (const GpuProfiler::Zone& zone_item : gpu_profiler.GetZones())
+                {
+                    if (zone_item.name == "Frame")
+                    {
+                        dynamic_resolution.Update(zone_item.time);
+                        dynamic_resolution_scale = static_cast<float>(dynamic_resolution.GetScale());
+                    }
+                }
+            }
+            matrixs_buffer_data.pointStride = is_accumulation_slice ? progressive_accumulation.GetSliceCount() : (is_hole_filling_frame ? static_cast<uint32_t>(hole_filling_point_stride) : 1);
+            matrixs_buffer_data.pointOffset = is_accumulation_slice ? progressive_accumulation.GetSliceOffset() : 0;
+            {
+                void* _ptr = matrixs_buffer->Map();
+                memcpy(_ptr, &matrixs_buffer_data, sizeof(matrixs_buffer_data));
+                matrixs_buffer->Unmap();
+            }
+
+            uint64_t record_begin_time = Trace::Now();
             command_buffer->Begin();
-            command_buffer->CmdBeginRenderPass(render_pass, swpachain_framebuffers[current_image_index]);
-            command_buffer->CmdBindPipeline(graphics_pipeline);
-            command_buffer->CmdSetViewport({ frame_viewport });
-            command_buffer->CmdSetScissor({ frame_scissor });
+            gpu_profiler.BeginFrame(command_buffer);
+            uint32_t gpu_frame_zone = gpu_profiler.BeginZone(command_buffer, "Frame");
+            uint32_t gpu_points_zone = gpu_profiler.BeginZone(command_buffer, "Points pass");
+            if (is_accumulation_frame)
+            {
+                double record_start_time = glfwGetTime();
+                if (is_accumulation_slice)
+                {
+                    progressive_accumulation.CmdBeginSlice(command_buffer);
+                    command_buffer->CmdBindPipeline(graphics_pipeline);
+                    command_buffer->CmdSetViewport({ frame_viewport });
+                    command_buffer->CmdSetScissor({ frame_scissor });
+                    for (uint32_t points_chunk_index : chunk_order.GetOrder())
+                    {
+                        command_buffer->CmdBindPipelineDescriptorSet(graphics_pipeline_descriptor_sets[points_chunk_index]);
+                        command_buffer->CmdDraw(1, progressive_accumulation.GetSlicePointCount(all_points_chunk_data[points_chunk_index].count), 0, 0);
+                    }
+                    progressive_accumulation.CmdEndSlice(command_buffer);
+                }
 
-            for (size_t points_image_index = 0; points_image_index < all_points_image_data.size(); points_image_index++)
+                progressive_accumulation.CmdCopyToImage(command_buffer, swapchain_images[current_image_index]);
+                command_buffer->CmdBeginRenderPass(accumulation_render_pass, swpachain_framebuffers[current_image_index]);
+                record_time = glfwGetTime() - record_start_time;
+            }
+            else if (is_dynamic_resolution_frame)
+            {
+                double record_start_time = glfwGetTime();
+                Turbo::Core::TViewport scaled_viewport(0, 0, dynamic_resolution.GetRenderWidth(), dynamic_resolution.GetRenderHeight(), 0, 1);
+                Turbo::Core::TScissor scaled_scissor(0, 0, dynamic_resolution.GetRenderWidth(), dynamic_resolution.GetRenderHeight());
+                dynamic_resolution.CmdBegin(command_buffer);
+                command_buffer->CmdBindPipeline(graphics_pipeline);
+                command_buffer->CmdSetViewport({ scaled_viewport });
+                command_buffer->CmdSetScissor({ scaled_scissor });
+                for (uint32_t points_chunk_index : chunk_order.GetOrder())
+                {
+                    command_buffer->CmdBindPipelineDescriptorSet(graphics_pipeline_descriptor_sets[points_chunk_index]);
+                    command_buffer->CmdDraw(1, all_points_chunk_data[points_chunk_index].count, 0, 0);
+                }
+                dynamic_resolution.CmdEnd(command_buffer);
+
+                dynamic_resolution.CmdBlitToImage(command_buffer, swapchain_images[current_image_index]);
+                command_buffer->CmdBeginRenderPass(upscale_render_pass, swpachain_framebuffers[current_image_index]);
+                record_time = glfwGetTime() - record_start_time;
+            }
+            else if (is_hole_filling_frame)
+            {
+                double record_start_time = glfwGetTime();
+                uint32_t point_stride = static_cast<uint32_t>(hole_filling_point_stride);
+                hole_filling.CmdBegin(command_buffer);
+                command_buffer->CmdBindPipeline(graphics_pipeline);
+                command_buffer->CmdSetViewport({ frame_viewport });
+                command_buffer->CmdSetScissor({ frame_scissor });
+                for (uint32_t points_chunk_index : chunk_order.GetOrder())
+                {
+                    command_buffer->CmdBindPipelineDescriptorSet(graphics_pipeline_descriptor_sets[points_chunk_index]);
+                    command_buffer->CmdDraw(1, (all_points_chunk_data[points_chunk_index].count + point_stride - 1) / point_stride, 0, 0);
+                }
+                hole_filling.CmdEnd(command_buffer);
+
+                uint32_t gpu_hole_filling_zone = gpu_profiler.BeginZone(command_buffer, "Hole filling");
+                hole_filling.CmdFill(command_buffer, projection);
+                gpu_profiler.EndZone(command_buffer, gpu_hole_filling_zone);
+
+                hole_filling.CmdBlitToImage(command_buffer, swapchain_images[current_image_index]);
+                command_buffer->CmdBeginRenderPass(upscale_render_pass, swpachain_framebuffers[current_image_index]);
+                record_time = glfwGetTime() - record_start_time;
+            }
+            else if (is_point_culling_frame)
+            {
+                double record_start_time = glfwGetTime();
+                std::vector<glm::vec4> clip_planes;
+                if (is_clip_plane)
+                {
+                    glm::vec3 clip_plane_normal(0.0f);
+                    clip_plane_normal[clip_plane_axis] = is_clip_plane_flipped ? 1.0f : -1.0f;
+                    clip_planes.push_back(glm::vec4(clip_plane_normal, is_clip_plane_flipped ? -clip_plane_offset : clip_plane_offset));
+                }
+                point_culling->SetClipPlanes(clip_planes);
+
+                uint32_t gpu_point_cull_zone = gpu_profiler.BeginZone(command_buffer, "Point cull");
+                point_culling->CmdCull(command_buffer);
+                gpu_profiler.EndZone(command_buffer, gpu_point_cull_zone);
+
+                command_buffer->CmdBeginRenderPass(render_pass, swpachain_framebuffers[current_image_index]);
+                command_buffer->CmdBindPipeline(indexed_graphics_pipeline);
+                command_buffer->CmdSetViewport({ frame_viewport });
+                command_buffer->CmdSetScissor({ frame_scissor });
+                point_culling->CmdDraw(command_buffer, graphics_pipeline_descriptor_sets, chunk_order.GetOrder());
+                record_time = glfwGetTime() - record_start_time;
+            }
+            else if (is_hiz_frame)
             {
-                command_buffer->CmdBindPipelineDescriptorSet(graphics_pipeline_descriptor_sets[points_image_index]);
-                command_buffer->CmdDraw(1, all_points_image_data[points_image_index].count, 0, 0);
+                double record_start_time = glfwGetTime();
+
+                // phase 1: what was visible last frame, its depth is what the other chunks are tested against
+                command_buffer->CmdBeginRenderPass(hiz_first_render_pass, swpachain_framebuffers[current_image_index]);
+                command_buffer->CmdBindPipeline(graphics_pipeline);
+                command_buffer->CmdSetViewport({ frame_viewport });
+                command_buffer->CmdSetScissor({ frame_scissor });
+                for (uint32_t points_chunk_index : hiz_culling.GetPhaseOneChunks())
+                {
+                    command_buffer->CmdBindPipelineDescriptorSet(graphics_pipeline_descriptor_sets[points_chunk_index]);
+                    command_buffer->CmdDraw(1, all_points_chunk_data[points_chunk_index].count, 0, 0);
+                }
+                command_buffer->CmdNextSubpass();
+                command_buffer->CmdEndRenderPass();
+
+                uint32_t gpu_hiz_zone = gpu_profiler.BeginZone(command_buffer, "HiZ pyramid + cull");
+                hiz_culling.CmdBuildPyramidAndCull(command_buffer, depth_image, projection * view * model, is_hiz_occlusion);
+                gpu_profiler.EndZone(command_buffer, gpu_hiz_zone);
+
+                // phase 2 blends over the color of phase 1
+                Turbo::Core::TMemoryBarrier color_barrier(Turbo::Core::TAccessBits::COLOR_ATTACHMENT_WRITE_BIT, Turbo::Core::TAccessBits::COLOR_ATTACHMENT_READ_BIT | Turbo::Core::TAccessBits::COLOR_ATTACHMENT_WRITE_BIT);
+                command_buffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, color_barrier);
+
+                command_buffer->CmdBeginRenderPass(hiz_second_render_pass, swpachain_framebuffers[current_image_index]);
+                command_buffer->CmdBindPipeline(graphics_pipeline);
+                command_buffer->CmdSetViewport({ frame_viewport });
+                command_buffer->CmdSetScissor({ frame_scissor });
+                hiz_culling.CmdDrawPhaseTwo(command_buffer, graphics_pipeline_descriptor_sets);
+                record_time = glfwGetTime() - record_start_time;
+            }
+            else if (record_thread_count == 0)
+            {
+                double record_start_time = glfwGetTime();
+                fragment_query_pool.CmdReset(command_buffer, 0, 1);
+                command_buffer->CmdBeginRenderPass(render_pass, swpachain_framebuffers[current_image_index]);
+                command_buffer->CmdBindPipeline(graphics_pipeline);
+                command_buffer->CmdSetViewport({ frame_viewport });
+                command_buffer->CmdSetScissor({ frame_scissor });
+
+                fragment_query_pool.CmdBeginQuery(command_buffer, 0);
+                for (uint32_t points_chunk_index : chunk_order.GetOrder())
+                {
+                    command_buffer->CmdBindPipelineDescriptorSet(graphics_pipeline_descriptor_sets[points_chunk_index]);
+                    command_buffer->CmdDraw(1, all_points_chunk_data[points_chunk_index].count, 0, 0);
+                }
+                fragment_query_pool.CmdEndQuery(command_buffer, 0);
+                record_time = glfwGetTime() - record_start_time;
+            }
+            else
+            {
+                PointsDrawRecorder& points_draw_recorder = *points_draw_recorders[current_image_index];
+                points_draw_recorder.SetRangeCount(record_thread_count);
+                if (is_cache_points_commands)
+                {
+                    // only the MVP uniform changes between frames, the recorded draws stay valid
+                    points_draw_recorder.Update(render_pass, swpachain_framebuffers[current_image_index], 0, graphics_pipeline, frame_viewport, frame_scissor, ordered_points_draw_items, points_commands_generation);
+                }
+                else
+                {
+                    points_draw_recorder.Record(render_pass, swpachain_framebuffers[current_image_index], 0, graphics_pipeline, frame_viewport, frame_scissor, ordered_points_draw_items);
+                }
+                record_time = points_draw_recorder.GetRecordTime();
+
+                command_buffer->CmdBeginRenderPass(render_pass, swpachain_framebuffers[current_image_index], Turbo::Core::TSubpassContents::SECONDARY_COMMAND_BUFFERS);
+                for (const auto& secondary_command_buffer_item : points_draw_recorder.GetCommandBuffers())
+                {
+                    command_buffer->CmdExecuteCommand(secondary_command_buffer_item);
+                }
             }
 
             command_buffer->CmdNextSubpass();
+            // subpass 0 may be SECONDARY_COMMAND_BUFFERS contents, so the points zone ends in the inline ImGui subpass
+            gpu_profiler.EndZone(command_buffer, gpu_points_zone);
+            uint32_t gpu_imgui_zone = gpu_profiler.BeginZone(command_buffer, "ImGui subpass");
 
             // <IMGUI Rendering>
             ImGui::Render();
@@ -1013,14 +1922,63 @@ int main()
             }
 
             command_buffer->CmdEndRenderPass();
+            gpu_profiler.EndZone(command_buffer, gpu_imgui_zone);
+            gpu_profiler.EndZone(command_buffer, gpu_frame_zone);
             command_buffer->End();
+            Trace::Record("Record", record_begin_time, Trace::Now());
 
-            Turbo::Core::TRefPtr<Turbo::Core::TFence> fence = new Turbo::Core::TFence(device);
-            queue->Submit({ wait_image_ready }, {}, command_buffer, fence);
-            fence->WaitUntil();
+            DevicePools::Fence fence = device_pools.AcquireFence();
+            {
+                TRACE_ZONE("Submit");
+                queue->Submit({ wait_image_ready->Get() }, {}, command_buffer, fence->Get());
+                gpu_profiler.EndFrame();
+            }
+            {
+                TRACE_ZONE("Fence wait");
+                fence->Get()->WaitUntil();
+            }
             command_buffer->Reset();
+            if (is_hiz_frame)
+            {
+                hiz_culling.Update();
+            }
+            if (is_point_culling_frame)
+            {
+                point_culling->Update();
+            }
+            if (is_fragment_query_frame)
+            {
+                std::vector<uint64_t> fragment_query_results;
+                if (fragment_query_pool.GetResults(0, 1, fragment_query_results) == VK_SUCCESS)
+                {
+                    is_points_visibles[is_front_to_back ? 1 : 0] = fragment_query_results[0] != 0;
+                }
+            }
 
-            if (queue->Present(swapchain, current_image_index) == Turbo::Core::TResult::MISMATCH)
+            Turbo::Core::TResult present_result;
+            {
+                TRACE_ZONE("Present");
+                present_result = queue->Present(swapchain, current_image_index);
+            }
+            frame_pacing.MarkPresent(swapchain->GetPresentMode(), static_cast<uint32_t>(swapchain_images.size()));
+
+            if (on_demand_frame_count > 0)
+            {
+                on_demand_frame_count--;
+            }
+            // an accumulation still converging or a running trace capture need the next frames too
+            if ((is_accumulation_frame && !progressive_accumulation.IsConverged()) || Trace::IsCapturing())
+            {
+                on_demand_frame_count = std::max(on_demand_frame_count, 1u);
+            }
+
+            if (trace_startup_frame_count > 0 && --trace_startup_frame_count == 0)
+            {
+                trace_status = Trace::EndCapture(TRACE_STARTUP_PATH) ? "Saved " + TRACE_STARTUP_PATH : "Failed to write " + TRACE_STARTUP_PATH;
+                std::cout << trace_status << std::endl;
+            }
+
+            if (present_result == Turbo::Core::TResult::MISMATCH || is_swapchain_dirty)
             {
                 device->WaitIdle();
 
@@ -1028,8 +1986,20 @@ int main()
                 swapchain_image_views.clear();
                 swpachain_framebuffers.clear();
 
-                Turbo::Core::TRefPtr<Turbo::Extension::TSwapchain> old_swapchain = swapchain;
-                swapchain = new Turbo::Extension::TSwapchain(old_swapchain);
+                if (is_swapchain_dirty)
+                {
+                    // the surface only takes one swapchain at a time, the old one goes first
+                    swapchain = nullptr;
+                    swapchain = CreateSwapchain(surface, swapchain_image_count, Turbo::Core::TFormatType::B8G8R8A8_SRGB, swapchain_usages, present_mode);
+                    present_mode = swapchain->GetPresentMode();
+                    swapchain_image_count = static_cast<uint32_t>(swapchain->GetImages().size());
+                    is_swapchain_dirty = false;
+                }
+                else
+                {
+                    Turbo::Core::TRefPtr<Turbo::Extension::TSwapchain> old_swapchain = swapchain;
+                    swapchain = new Turbo::Extension::TSwapchain(old_swapchain);
+                }
 
                 swapchain_images = swapchain->GetImages();
                 for (auto& swapchain_image_item : swapchain_images)
@@ -1038,14 +2008,24 @@ int main()
                     swapchain_image_views.emplace_back(swapchain_view);
                 }
 
-                depth_image = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::D32_SFLOAT, swapchain->GetWidth(), swapchain->GetHeight(), 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_DEPTH_STENCIL_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_INPUT_ATTACHMENT, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+                depth_image = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::D32_SFLOAT, swapchain->GetWidth(), swapchain->GetHeight(), 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_DEPTH_STENCIL_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_INPUT_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
                 depth_image_view = new Turbo::Core::TImageView(depth_image, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, depth_image->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_DEPTH_BIT, 0, 1, 0, 1);
+                hiz_culling.SetDepthImage(depth_image_view, swapchain->GetWidth(), swapchain->GetHeight());
+                progressive_accumulation.SetTargets(depth_image_view, swapchain->GetWidth(), swapchain->GetHeight());
+                dynamic_resolution.SetTargets(swapchain->GetWidth(), swapchain->GetHeight());
+                hole_filling.SetTargets(swapchain->GetWidth(), swapchain->GetHeight());
 
                 for (const auto& image_view_item : swapchain_image_views)
                 {
                     std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> views{ image_view_item, depth_image_view };
                     swpachain_framebuffers.emplace_back(new Turbo::Core::TFramebuffer(render_pass, views));
                 }
+
+                while (points_draw_recorders.size() < swapchain_images.size())
+                {
+                    points_draw_recorders.emplace_back(new PointsDrawRecorder(queue, worker_pool));
+                }
+                points_commands_generation++;
             }
         }
     }
@@ -1058,6 +2038,23 @@ int main()
 
     command_pool->Free(command_buffer);
 
+    if (!record_camera_path_file.empty())
+    {
+        if (SaveCameraPath(record_camera_path_file, recorded_camera_path))
+        {
+            std::cout << "Camera path:" << recorded_camera_path.size() << " frames -> " << record_camera_path_file << std::endl;
+        }
+        else
+        {
+            std::cerr << "Failed to write camera path " << record_camera_path_file << std::endl;
+        }
+    }
+
+    if (!SavePipelineCache(pipeline_cache, PIPELINE_CACHE_PATH))
+    {
+        std::cerr << "Failed to save pipeline cache " << PIPELINE_CACHE_PATH << std::endl;
+    }
+
     glfwTerminate();
 
     return 0;
@@ -0,0 +1,42 @@
+@echo off
+rem Compile every GLSL shader into a SPIR-V C header under shaders\spirv for the POINTCLOUD_EMBEDDED_SPIRV build.
+rem Needs glslangValidator from the Vulkan SDK and PowerShell in PATH. Keep the list in sync with src\EmbeddedShaders.h.
+cd /d "%~dp0"
+if not exist spirv mkdir spirv
+
+glslangValidator -V --target-env vulkan1.2 --vn HIZCULL_COMP_SPIRV -o spirv\HiZCull.comp.h HiZCull.comp || exit /b 1
+call :embed_source HiZCull.comp HIZCULL_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn HIZPYRAMID_COMP_SPIRV -o spirv\HiZPyramid.comp.h HiZPyramid.comp || exit /b 1
+call :embed_source HiZPyramid.comp HIZPYRAMID_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn POINTCLOUD_FRAG_SPIRV -o spirv\PointCloud.frag.h PointCloud.frag || exit /b 1
+call :embed_source PointCloud.frag POINTCLOUD_FRAG_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn POINTCLOUD_VERT_SPIRV -o spirv\PointCloud.vert.h PointCloud.vert || exit /b 1
+call :embed_source PointCloud.vert POINTCLOUD_VERT_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn POINTCLOUDBUFFER_VERT_SPIRV -o spirv\PointCloudBuffer.vert.h PointCloudBuffer.vert || exit /b 1
+call :embed_source PointCloudBuffer.vert POINTCLOUDBUFFER_VERT_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn PULLPUSH_COMP_SPIRV -o spirv\PullPush.comp.h PullPush.comp || exit /b 1
+call :embed_source PullPush.comp PULLPUSH_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn POINTCULL_COMP_SPIRV -o spirv\PointCull.comp.h PointCull.comp || exit /b 1
+call :embed_source PointCull.comp POINTCULL_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn REDUCE_COMP_SPIRV -o spirv\Reduce.comp.h Reduce.comp || exit /b 1
+call :embed_source Reduce.comp REDUCE_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn SCAN_COMP_SPIRV -o spirv\Scan.comp.h Scan.comp || exit /b 1
+call :embed_source Scan.comp SCAN_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn COMPACT_COMP_SPIRV -o spirv\Compact.comp.h Compact.comp || exit /b 1
+call :embed_source Compact.comp COMPACT_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn HISTOGRAM_COMP_SPIRV -o spirv\Histogram.comp.h Histogram.comp || exit /b 1
+call :embed_source Histogram.comp HISTOGRAM_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn RADIXSORT_COMP_SPIRV -o spirv\RadixSort.comp.h RadixSort.comp || exit /b 1
+call :embed_source RadixSort.comp RADIXSORT_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn MORTONSORT_COMP_SPIRV -o spirv\MortonSort.comp.h MortonSort.comp || exit /b 1
+call :embed_source MortonSort.comp MORTONSORT_COMP_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn IMGUI_FRAG_SPIRV -o spirv\imgui.frag.h imgui.frag || exit /b 1
+call :embed_source imgui.frag IMGUI_FRAG_SOURCE || exit /b 1
+glslangValidator -V --target-env vulkan1.2 --vn IMGUI_VERT_SPIRV -o spirv\imgui.vert.h imgui.vert || exit /b 1
+call :embed_source imgui.vert IMGUI_VERT_SOURCE || exit /b 1
+exit /b 0
+
+rem Write the GLSL source next to its SPIR-V as a byte array, ShaderCache only takes the embedded SPIR-V while the source still matches
+:embed_source
+powershell -NoProfile -Command "$bytes = [IO.File]::ReadAllBytes('%1'); Set-Content -Path 'spirv\%1.src.h' -Value ('const unsigned char %2[] = {' + ($bytes -join ',') + '};')" || exit /b 1
+exit /b 0
@@ -5,6 +5,8 @@ layout(set = 0, binding = 0) uniform MVP_MATRIXS
     mat4 model;
     mat4 view;
     mat4 project;
+    uint point_stride;
+    uint point_offset;
 };
 layout(set = 0, binding = 1, rgba32f) uniform image2D POINTS_POISITION_TEX;
 layout(set = 0, binding = 2, rgba32f) uniform image2D POINTS_COLOR_TEX;
@@ -14,8 +16,14 @@ layout(location = 0) out vec3 v_color;
 void main()
 {
     int tex_width = 512;
-    int row = gl_InstanceIndex / tex_width;
-    int column = gl_InstanceIndex - row * tex_width;
+#if defined(POINTS_INDEXED)
+    // drawn indexed from the POINT_INDICES of PointCull.comp, one vertex per point
+    int point_index = gl_VertexIndex;
+#else
+    int point_index = gl_InstanceIndex * int(point_stride) + int(point_offset);
+#endif
+    int row = point_index / tex_width;
+    int column = point_index - row * tex_width;
     ivec2 tex_coord = ivec2(column, row);
     // ivec2 tex_coord = ivec2(row, column);
 
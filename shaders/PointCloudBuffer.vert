@@ -0,0 +1,37 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform MVP_MATRIXS
+{
+    mat4 model;
+    mat4 view;
+    mat4 project;
+    uint point_stride;
+    uint point_offset;
+};
+layout(std430, set = 0, binding = 1) readonly buffer POINTS_POSITION_BUFFER
+{
+    vec4 points_position[];
+};
+layout(std430, set = 0, binding = 2) readonly buffer POINTS_COLOR_BUFFER
+{
+    vec4 points_color[];
+};
+
+layout(location = 0) out vec3 v_color;
+
+void main()
+{
+#if defined(POINTS_INDEXED)
+    // drawn indexed from the POINT_INDICES of PointCull.comp, one vertex per point
+    uint point_index = uint(gl_VertexIndex);
+#else
+    uint point_index = uint(gl_InstanceIndex) * point_stride + point_offset;
+#endif
+    vec3 point_pos = points_position[point_index].xyz;
+    vec4 point_color = points_color[point_index];
+
+    v_color = point_color.xyz;
+
+    gl_Position = project * view * model * vec4(point_pos, 1.0);
+    gl_PointSize = 1.0;
+}
\ No newline at end of file
@@ -0,0 +1,73 @@
+#include "CameraPath.h"
+
+#include <glm/ext.hpp>
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+glm::mat4 GetCameraView(const glm::vec3 &position, float yaw, float pitch)
+{
+    glm::mat4 forward_rotate_mat = glm::rotate(glm::mat4(1.0f), glm::radians(yaw), glm::vec3(0.0f, 0.0f, 1.0f));
+    forward_rotate_mat = glm::rotate(forward_rotate_mat, glm::radians(-pitch), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    glm::vec3 forward_dir = glm::normalize(glm::vec3(forward_rotate_mat * glm::vec4(1.0f, 0.0f, 0.0f, 1.0f)));
+    glm::vec3 up_dir = glm::vec3(0.0f, 0.0f, 1.0f);
+    glm::vec3 right_dir = glm::normalize(glm::cross(up_dir, forward_dir));
+    up_dir = glm::normalize(glm::cross(right_dir, forward_dir));
+
+    return glm::lookAt(position, position + forward_dir, up_dir);
+}
+
+glm::mat4 GetCameraView(const CameraPathFrame &frame)
+{
+    return GetCameraView(frame.position, frame.yaw, frame.pitch);
+}
+
+bool LoadCameraPath(const std::string &path, std::vector<CameraPathFrame> &frames)
+{
+    std::ifstream in_stream(path);
+    if (!in_stream.is_open())
+    {
+        return false;
+    }
+
+    frames.clear();
+    std::string line;
+    while (std::getline(in_stream, line))
+    {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+        {
+            continue;
+        }
+
+        std::istringstream line_stream(line);
+        CameraPathFrame frame;
+        if (!(line_stream >> frame.position.x >> frame.position.y >> frame.position.z >> frame.yaw >> frame.pitch))
+        {
+            return false;
+        }
+        frames.push_back(frame);
+    }
+
+    return true;
+}
+
+bool SaveCameraPath(const std::string &path, const std::vector<CameraPathFrame> &frames)
+{
+    std::ofstream out_stream(path, std::ios::trunc);
+    if (!out_stream.is_open())
+    {
+        return false;
+    }
+
+    out_stream << "# x y z yaw pitch" << std::endl;
+    out_stream << std::setprecision(9);
+    for (const CameraPathFrame &frame : frames)
+    {
+        out_stream << frame.position.x << " " << frame.position.y << " " << frame.position.z << " " << frame.yaw << " " << frame.pitch << "\n";
+    }
+
+    return out_stream.good();
+}
@@ -0,0 +1,25 @@
+#pragma once
+#ifndef POINTCLOUD_CAMERAPATH_H
+#define POINTCLOUD_CAMERAPATH_H
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+// One frame of a camera path, the same state the WASD/mouse controls drive in main.cpp
+typedef struct CameraPathFrame
+{
+    glm::vec3 position = glm::vec3(0.0f);
+    float yaw = 0.0f;   // degree, horizontal_angle
+    float pitch = 0.0f; // degree, vertical_angle
+} CameraPathFrame;
+
+// View matrix of the interactive camera: yaw turns around +Z, pitch is clamped to [-90, 90] and +X is forward at zero
+glm::mat4 GetCameraView(const glm::vec3 &position, float yaw, float pitch);
+glm::mat4 GetCameraView(const CameraPathFrame &frame);
+
+// Text file, one frame per line "x y z yaw pitch", empty lines and lines starting with '#' are skipped
+bool LoadCameraPath(const std::string &path, std::vector<CameraPathFrame> &frames);
+bool SaveCameraPath(const std::string &path, const std::vector<CameraPathFrame> &frames);
+
+#endif // !POINTCLOUD_CAMERAPATH_H
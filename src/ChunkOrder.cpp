@@ -0,0 +1,64 @@
+#include "ChunkOrder.h"
+
+#include <glm/gtx/norm.hpp>
+
+ChunkOrder::ChunkOrder(const std::vector<PointsChunkData> &pointsChunkDatas)
+{
+    for (const PointsChunkData &points_chunk_data_item : pointsChunkDatas)
+    {
+        const POSITION &centre = points_chunk_data_item.bounds.centre;
+        this->centres.push_back(glm::vec3(centre.x, centre.y, centre.z));
+    }
+    this->distances.resize(this->centres.size(), 0.0f);
+    this->Reset();
+}
+
+bool ChunkOrder::Update(const glm::vec3 &cameraPosition)
+{
+    for (size_t chunk_index = 0; chunk_index < this->centres.size(); chunk_index++)
+    {
+        this->distances[chunk_index] = glm::distance2(cameraPosition, this->centres[chunk_index]);
+    }
+
+    this->moveCount = 0;
+    for (size_t order_index = 1; order_index < this->order.size(); order_index++)
+    {
+        uint32_t chunk_index = this->order[order_index];
+        float distance = this->distances[chunk_index];
+
+        size_t insert_index = order_index;
+        while (insert_index > 0 && this->distances[this->order[insert_index - 1]] > distance)
+        {
+            this->order[insert_index] = this->order[insert_index - 1];
+            insert_index--;
+        }
+
+        if (insert_index != order_index)
+        {
+            this->order[insert_index] = chunk_index;
+            this->moveCount++;
+        }
+    }
+
+    return this->moveCount > 0;
+}
+
+void ChunkOrder::Reset()
+{
+    this->order.resize(this->centres.size());
+    for (size_t chunk_index = 0; chunk_index < this->order.size(); chunk_index++)
+    {
+        this->order[chunk_index] = static_cast<uint32_t>(chunk_index);
+    }
+    this->moveCount = 0;
+}
+
+const std::vector<uint32_t> &ChunkOrder::GetOrder() const
+{
+    return this->order;
+}
+
+uint32_t ChunkOrder::GetMoveCount() const
+{
+    return this->moveCount;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef POINTCLOUD_CHUNKORDER_H
+#define POINTCLOUD_CHUNKORDER_H
+#include "PointCloudData.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Front to back draw order of the points chunks, by the distance from the camera to their bounds centre (packing time),
+// so the depth test rejects the far points before they are shaded. Every Update() insertion sorts the previous order:
+// the camera moves little between frames, the order is nearly sorted and that is close to linear in the chunk count.
+class ChunkOrder
+{
+  private:
+    std::vector<glm::vec3> centres; // by chunk, PointsBounds::centre
+    std::vector<float> distances;   // by chunk, squared, of the last Update()
+    std::vector<uint32_t> order;    // chunk indices, nearest first
+    uint32_t moveCount = 0;         // chunks the last Update() moved
+
+  public:
+    explicit ChunkOrder(const std::vector<PointsChunkData> &pointsChunkDatas);
+
+  public:
+    // Return true if the order changed
+    bool Update(const glm::vec3 &cameraPosition);
+    // back to the load order
+    void Reset();
+
+    const std::vector<uint32_t> &GetOrder() const;
+    uint32_t GetMoveCount() const;
+};
+
+#endif // !POINTCLOUD_CHUNKORDER_H
@@ -0,0 +1,319 @@
+#include "ComputePrimitives.h"
+
+#include "../core/include/TBarrier.h"
+#include "../core/include/TVulkanLoader.h"
+
+#include <algorithm>
+
+constexpr uint32_t ComputePrimitives::GROUP_SIZE;
+constexpr uint32_t ComputePrimitives::HISTOGRAM_BIN_COUNT;
+
+namespace
+{
+// push_constant PRIMITIVE_CONSTANTS, the same in every shader of ComputePrimitives
+typedef struct PrimitiveConstants
+{
+    uint32_t count;
+    uint32_t shift;
+    uint32_t blockCount;
+    uint32_t isPairs;
+} PrimitiveConstants;
+
+const uint32_t MAX_GROUP_COUNT_X = 65535; // the minimum maxComputeWorkGroupCount[0]
+const uint32_t RADIX_DIGIT_BITS = 8;
+
+uint32_t GetGroupCount(uint32_t count)
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(count) + ComputePrimitives::GROUP_SIZE - 1) / ComputePrimitives::GROUP_SIZE);
+}
+
+void CmdComputeBarrier(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    Turbo::Core::TMemoryBarrier compute_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::SHADER_WRITE_BIT | Turbo::Core::TAccessBits::TRANSFER_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT | Turbo::Core::TPipelineStageBits::TRANSFER_BIT, compute_barrier);
+}
+
+void CmdTransferBarrier(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    Turbo::Core::TMemoryBarrier transfer_barrier(Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::SHADER_WRITE_BIT | Turbo::Core::TAccessBits::TRANSFER_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT | Turbo::Core::TPipelineStageBits::TRANSFER_BIT, transfer_barrier);
+}
+} // namespace
+
+bool ComputePrimitives::IsSubgroupSupported(const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physicalDevice)
+{
+    const Turbo::Core::TPhysicalDeviceDriver *physical_device_driver = physicalDevice->GetPhysicalDeviceDriver();
+    if (physical_device_driver->vkGetPhysicalDeviceProperties2 == nullptr)
+    {
+        return false;
+    }
+
+    VkPhysicalDeviceSubgroupProperties vk_physical_device_subgroup_properties = {};
+    vk_physical_device_subgroup_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+    vk_physical_device_subgroup_properties.pNext = nullptr;
+
+    VkPhysicalDeviceProperties2 vk_physical_device_properties2 = {};
+    vk_physical_device_properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+    vk_physical_device_properties2.pNext = &vk_physical_device_subgroup_properties;
+    physical_device_driver->vkGetPhysicalDeviceProperties2(physicalDevice->GetVkPhysicalDevice(), &vk_physical_device_properties2);
+
+    VkSubgroupFeatureFlags required_operations = VK_SUBGROUP_FEATURE_BASIC_BIT | VK_SUBGROUP_FEATURE_ARITHMETIC_BIT;
+    return (vk_physical_device_subgroup_properties.supportedStages & VK_SHADER_STAGE_COMPUTE_BIT) != 0 && (vk_physical_device_subgroup_properties.supportedOperations & required_operations) == required_operations;
+}
+
+ComputePrimitivesPipelineFutures ComputePrimitives::BuildPipelines(PipelineBuilder &pipelineBuilder, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const ComputePrimitivesShaderCodes &shaderCodes, const PipelineBuilder::ComputePipelineCreator &creator, bool isSubgroup)
+{
+    std::vector<std::string> subgroup_defines;
+    std::vector<std::string> scan_add_defines = {"SCAN_ADD"};
+    if (isSubgroup)
+    {
+        subgroup_defines.push_back("SUBGROUP");
+    }
+
+    ComputePrimitivesPipelineFutures pipeline_futures;
+    pipeline_futures.reduceMinMax = pipelineBuilder.BuildComputePipeline(device, "Reduce.comp", shaderCodes.reduce, PipelineBuilder::ComputePipelineCreator(creator), subgroup_defines);
+    pipeline_futures.scanBlocks = pipelineBuilder.BuildComputePipeline(device, "Scan.comp", shaderCodes.scan, PipelineBuilder::ComputePipelineCreator(creator), subgroup_defines);
+    pipeline_futures.scanAdd = pipelineBuilder.BuildComputePipeline(device, "Scan.comp", shaderCodes.scan, PipelineBuilder::ComputePipelineCreator(creator), scan_add_defines);
+    pipeline_futures.compact = pipelineBuilder.BuildComputePipeline(device, "Compact.comp", shaderCodes.compact, PipelineBuilder::ComputePipelineCreator(creator));
+    pipeline_futures.histogram = pipelineBuilder.BuildComputePipeline(device, "Histogram.comp", shaderCodes.histogram, PipelineBuilder::ComputePipelineCreator(creator));
+    pipeline_futures.radixCount32 = pipelineBuilder.BuildComputePipeline(device, "RadixSort.comp", shaderCodes.radixSort, PipelineBuilder::ComputePipelineCreator(creator));
+    pipeline_futures.radixScatter32 = pipelineBuilder.BuildComputePipeline(device, "RadixSort.comp", shaderCodes.radixSort, PipelineBuilder::ComputePipelineCreator(creator), {"RADIX_SCATTER"});
+    pipeline_futures.radixCount64 = pipelineBuilder.BuildComputePipeline(device, "RadixSort.comp", shaderCodes.radixSort, PipelineBuilder::ComputePipelineCreator(creator), {"KEY64"});
+    pipeline_futures.radixScatter64 = pipelineBuilder.BuildComputePipeline(device, "RadixSort.comp", shaderCodes.radixSort, PipelineBuilder::ComputePipelineCreator(creator), {"KEY64", "RADIX_SCATTER"});
+    return pipeline_futures;
+}
+
+ComputePrimitivesPipelines ComputePrimitives::GetPipelines(const ComputePrimitivesPipelineFutures &pipelineFutures)
+{
+    ComputePrimitivesPipelines pipelines;
+    pipelines.reduceMinMax = pipelineFutures.reduceMinMax.get();
+    pipelines.scanBlocks = pipelineFutures.scanBlocks.get();
+    pipelines.scanAdd = pipelineFutures.scanAdd.get();
+    pipelines.compact = pipelineFutures.compact.get();
+    pipelines.histogram = pipelineFutures.histogram.get();
+    pipelines.radixCount32 = pipelineFutures.radixCount32.get();
+    pipelines.radixScatter32 = pipelineFutures.radixScatter32.get();
+    pipelines.radixCount64 = pipelineFutures.radixCount64.get();
+    pipelines.radixScatter64 = pipelineFutures.radixScatter64.get();
+    return pipelines;
+}
+
+ComputePrimitives::ComputePrimitives(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const ComputePrimitivesPipelines &pipelines) : descriptorPool(descriptorPool), pipelines(pipelines)
+{
+}
+
+ComputePrimitives::~ComputePrimitives()
+{
+    this->Reset();
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> ComputePrimitives::AllocateDescriptorSet(const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pipeline)
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> descriptor_set = this->descriptorPool->Allocate(pipeline->GetPipelineLayout());
+    this->transientDescriptorSets.push_back(descriptor_set);
+    return descriptor_set;
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TBuffer> ComputePrimitives::AllocateBuffer(Turbo::Core::TDeviceSize size)
+{
+    // no zero sized buffers
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> buffer = new Turbo::Core::TBuffer(this->pipelines.scanBlocks->GetDevice(), 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_DST, 0, std::max<Turbo::Core::TDeviceSize>(size, sizeof(uint32_t)));
+    this->transientBuffers.push_back(buffer);
+    return buffer;
+}
+
+void ComputePrimitives::CmdDispatchGroups(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, uint32_t groupCount)
+{
+    uint32_t group_count_x = std::min(groupCount, MAX_GROUP_COUNT_X);
+    commandBuffer->CmdDispatch(group_count_x, (groupCount + group_count_x - 1) / group_count_x, 1);
+}
+
+void ComputePrimitives::Reset()
+{
+    for (Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> &descriptor_set_item : this->transientDescriptorSets)
+    {
+        this->descriptorPool->Free(descriptor_set_item);
+    }
+    this->transientDescriptorSets.clear();
+    this->transientBuffers.clear();
+}
+
+void ComputePrimitives::CmdReduceMinMax(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &values, uint32_t count, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &minMax)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    // every pass reduces 256 items into one pair, the last one writes minMax
+    PrimitiveConstants primitive_constants = {count, 0, 0, 0};
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> input = values;
+    commandBuffer->CmdBindPipeline(this->pipelines.reduceMinMax);
+    while (true)
+    {
+        uint32_t group_count = GetGroupCount(primitive_constants.count);
+        Turbo::Core::TRefPtr<Turbo::Core::TBuffer> output = minMax;
+        if (group_count > 1)
+        {
+            output = this->AllocateBuffer(static_cast<Turbo::Core::TDeviceSize>(group_count) * 2 * sizeof(float) * 4);
+        }
+
+        Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> descriptor_set = this->AllocateDescriptorSet(this->pipelines.reduceMinMax);
+        descriptor_set->BindData(0, 0, input);
+        descriptor_set->BindData(0, 1, output);
+        commandBuffer->CmdBindPipelineDescriptorSet(descriptor_set);
+
+        primitive_constants.blockCount = group_count;
+        commandBuffer->CmdPushConstants(0, sizeof(primitive_constants), &primitive_constants);
+        CmdDispatchGroups(commandBuffer, group_count);
+        CmdComputeBarrier(commandBuffer);
+
+        if (group_count == 1)
+        {
+            break;
+        }
+        input = output;
+        primitive_constants.count = group_count;
+        primitive_constants.isPairs = 1;
+    }
+}
+
+void ComputePrimitives::CmdExclusiveScan(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &input, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &output, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    uint32_t group_count = GetGroupCount(count);
+    PrimitiveConstants primitive_constants = {count, 0, group_count, 0};
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> block_sums = this->AllocateBuffer(static_cast<Turbo::Core::TDeviceSize>(group_count) * sizeof(uint32_t));
+
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> scan_descriptor_set = this->AllocateDescriptorSet(this->pipelines.scanBlocks);
+    scan_descriptor_set->BindData(0, 0, input);
+    scan_descriptor_set->BindData(0, 1, output);
+    scan_descriptor_set->BindData(0, 2, block_sums);
+    commandBuffer->CmdBindPipeline(this->pipelines.scanBlocks);
+    commandBuffer->CmdBindPipelineDescriptorSet(scan_descriptor_set);
+    commandBuffer->CmdPushConstants(0, sizeof(primitive_constants), &primitive_constants);
+    CmdDispatchGroups(commandBuffer, group_count);
+    CmdComputeBarrier(commandBuffer);
+
+    if (group_count == 1)
+    {
+        return;
+    }
+
+    // the block sums are scanned the same way, 256 times fewer items per level
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> block_offsets = this->AllocateBuffer(static_cast<Turbo::Core::TDeviceSize>(group_count) * sizeof(uint32_t));
+    this->CmdExclusiveScan(commandBuffer, block_sums, block_offsets, group_count);
+
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> add_descriptor_set = this->AllocateDescriptorSet(this->pipelines.scanAdd);
+    add_descriptor_set->BindData(0, 1, output);
+    add_descriptor_set->BindData(0, 2, block_offsets);
+    commandBuffer->CmdBindPipeline(this->pipelines.scanAdd);
+    commandBuffer->CmdBindPipelineDescriptorSet(add_descriptor_set);
+    commandBuffer->CmdPushConstants(0, sizeof(primitive_constants), &primitive_constants);
+    CmdDispatchGroups(commandBuffer, group_count);
+    CmdComputeBarrier(commandBuffer);
+}
+
+void ComputePrimitives::CmdCompact(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &values, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &flags, uint32_t count, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &output, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &outputCount)
+{
+    if (count == 0)
+    {
+        commandBuffer->CmdFillBuffer(outputCount, 0, sizeof(uint32_t), 0u);
+        CmdTransferBarrier(commandBuffer);
+        return;
+    }
+
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> offsets = this->AllocateBuffer(static_cast<Turbo::Core::TDeviceSize>(count) * sizeof(uint32_t));
+    this->CmdExclusiveScan(commandBuffer, flags, offsets, count);
+
+    uint32_t group_count = GetGroupCount(count);
+    PrimitiveConstants primitive_constants = {count, 0, group_count, 0};
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> descriptor_set = this->AllocateDescriptorSet(this->pipelines.compact);
+    descriptor_set->BindData(0, 0, values);
+    descriptor_set->BindData(0, 1, flags);
+    descriptor_set->BindData(0, 2, offsets);
+    descriptor_set->BindData(0, 3, output);
+    descriptor_set->BindData(0, 4, outputCount);
+    commandBuffer->CmdBindPipeline(this->pipelines.compact);
+    commandBuffer->CmdBindPipelineDescriptorSet(descriptor_set);
+    commandBuffer->CmdPushConstants(0, sizeof(primitive_constants), &primitive_constants);
+    CmdDispatchGroups(commandBuffer, group_count);
+    CmdComputeBarrier(commandBuffer);
+}
+
+void ComputePrimitives::CmdHistogram(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &keys, uint32_t count, uint32_t shift, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &histogram)
+{
+    commandBuffer->CmdFillBuffer(histogram, 0, HISTOGRAM_BIN_COUNT * sizeof(uint32_t), 0u);
+    CmdTransferBarrier(commandBuffer);
+    if (count == 0)
+    {
+        return;
+    }
+
+    uint32_t group_count = GetGroupCount(count);
+    PrimitiveConstants primitive_constants = {count, shift, group_count, 0};
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> descriptor_set = this->AllocateDescriptorSet(this->pipelines.histogram);
+    descriptor_set->BindData(0, 0, keys);
+    descriptor_set->BindData(0, 1, histogram);
+    commandBuffer->CmdBindPipeline(this->pipelines.histogram);
+    commandBuffer->CmdBindPipelineDescriptorSet(descriptor_set);
+    commandBuffer->CmdPushConstants(0, sizeof(primitive_constants), &primitive_constants);
+    CmdDispatchGroups(commandBuffer, group_count);
+    CmdComputeBarrier(commandBuffer);
+}
+
+void ComputePrimitives::CmdRadixSort(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, RadixKeyType keyType, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &keys, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &values, uint32_t count, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &scratchKeys, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &scratchValues)
+{
+    if (count <= 1)
+    {
+        return;
+    }
+
+    bool is_key64 = keyType == RadixKeyType::UINT64;
+    const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &count_pipeline = is_key64 ? this->pipelines.radixCount64 : this->pipelines.radixCount32;
+    const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &scatter_pipeline = is_key64 ? this->pipelines.radixScatter64 : this->pipelines.radixScatter32;
+    uint32_t pass_count = (is_key64 ? 64 : 32) / RADIX_DIGIT_BITS;
+
+    // the digit of a pass for every block, digit major, and its scan: where the block puts its items of that digit
+    uint32_t group_count = GetGroupCount(count);
+    uint32_t block_histogram_count = HISTOGRAM_BIN_COUNT * group_count;
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> block_histograms = this->AllocateBuffer(static_cast<Turbo::Core::TDeviceSize>(block_histogram_count) * sizeof(uint32_t));
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> block_offsets = this->AllocateBuffer(static_cast<Turbo::Core::TDeviceSize>(block_histogram_count) * sizeof(uint32_t));
+
+    for (uint32_t pass_index = 0; pass_index < pass_count; pass_index++)
+    {
+        bool is_from_scratch = pass_index % 2 == 1;
+        const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &keys_in = is_from_scratch ? scratchKeys : keys;
+        const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &values_in = is_from_scratch ? scratchValues : values;
+        const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &keys_out = is_from_scratch ? keys : scratchKeys;
+        const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &values_out = is_from_scratch ? values : scratchValues;
+        PrimitiveConstants primitive_constants = {count, pass_index * RADIX_DIGIT_BITS, group_count, 0};
+
+        Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> count_descriptor_set = this->AllocateDescriptorSet(count_pipeline);
+        count_descriptor_set->BindData(0, 0, keys_in);
+        count_descriptor_set->BindData(0, 1, block_histograms);
+        commandBuffer->CmdBindPipeline(count_pipeline);
+        commandBuffer->CmdBindPipelineDescriptorSet(count_descriptor_set);
+        commandBuffer->CmdPushConstants(0, sizeof(primitive_constants), &primitive_constants);
+        CmdDispatchGroups(commandBuffer, group_count);
+        CmdComputeBarrier(commandBuffer);
+
+        this->CmdExclusiveScan(commandBuffer, block_histograms, block_offsets, block_histogram_count);
+
+        Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> scatter_descriptor_set = this->AllocateDescriptorSet(scatter_pipeline);
+        scatter_descriptor_set->BindData(0, 0, keys_in);
+        scatter_descriptor_set->BindData(0, 1, values_in);
+        scatter_descriptor_set->BindData(0, 2, block_offsets);
+        scatter_descriptor_set->BindData(0, 3, keys_out);
+        scatter_descriptor_set->BindData(0, 4, values_out);
+        commandBuffer->CmdBindPipeline(scatter_pipeline);
+        commandBuffer->CmdBindPipelineDescriptorSet(scatter_descriptor_set);
+        commandBuffer->CmdPushConstants(0, sizeof(primitive_constants), &primitive_constants);
+        CmdDispatchGroups(commandBuffer, group_count);
+        CmdComputeBarrier(commandBuffer);
+    }
+}
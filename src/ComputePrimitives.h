@@ -0,0 +1,124 @@
+#pragma once
+#ifndef POINTCLOUD_COMPUTEPRIMITIVES_H
+#define POINTCLOUD_COMPUTEPRIMITIVES_H
+#include "PipelineBuilder.h"
+
+#include "../core/include/TBuffer.h"
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TComputePipeline.h"
+#include "../core/include/TDescriptorPool.h"
+#include "../core/include/TPhysicalDevice.h"
+#include "../core/include/TPipelineDescriptorSet.h"
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+typedef enum class RadixKeyType
+{
+    UINT32,
+    UINT64, // low word first, as uint64_t on the host
+} RadixKeyType;
+
+typedef struct ComputePrimitivesShaderCodes
+{
+    std::string reduce;    // Reduce.comp
+    std::string scan;      // Scan.comp
+    std::string compact;   // Compact.comp
+    std::string histogram; // Histogram.comp
+    std::string radixSort; // RadixSort.comp
+} ComputePrimitivesShaderCodes;
+
+typedef struct ComputePrimitivesPipelines
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> reduceMinMax;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> scanBlocks;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> scanAdd;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> compact;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> histogram;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> radixCount32;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> radixScatter32;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> radixCount64;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> radixScatter64;
+} ComputePrimitivesPipelines;
+
+typedef struct ComputePrimitivesPipelineFutures
+{
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> reduceMinMax;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> scanBlocks;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> scanAdd;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> compact;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> histogram;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> radixCount32;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> radixScatter32;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> radixCount64;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> radixScatter64;
+} ComputePrimitivesPipelineFutures;
+
+// Building blocks of GPU culling, sorting, LOD and filtering, on uint32_t (vec4 for the reduction) storage buffers:
+// min/max reduce, exclusive scan, stream compaction, 256 bin histogram and stable key-value radix sort of 32 or 64 bit keys.
+// Every Cmd*() records outside a render pass, binds its own pipelines, and ends with a compute -> compute/transfer barrier so the
+// next primitive or a copy can read the result, other consumers (indirect, vertex input, host) need their own barrier.
+// The scratch buffers and descriptor sets of the recorded primitives are kept until Reset(), call it after the fence of the submission.
+// With the SUBGROUP variants the reduction and the scans (so the compaction and the radix sort too) work inside subgroups first.
+// NOTE: the dispatches are split over x and y past maxComputeWorkGroupCount[0] (65535 at least), counts are uint32_t
+class ComputePrimitives
+{
+  public:
+    static constexpr uint32_t GROUP_SIZE = 256;          // local_size_x of the shaders, the block size of the scans and the radix sort
+    static constexpr uint32_t HISTOGRAM_BIN_COUNT = 256; // 8 bit digits
+
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> descriptorPool;
+    ComputePrimitivesPipelines pipelines;
+
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> transientDescriptorSets;
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TBuffer>> transientBuffers;
+
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> AllocateDescriptorSet(const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pipeline);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> AllocateBuffer(Turbo::Core::TDeviceSize size);
+
+  public:
+    // Subgroup basic and arithmetic operations in compute shaders, Vulkan 1.1
+    static bool IsSubgroupSupported(const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physicalDevice);
+
+    // Every pipeline on the worker pool, with SUBGROUP for the reduction and the scan if isSubgroup
+    static ComputePrimitivesPipelineFutures BuildPipelines(PipelineBuilder &pipelineBuilder, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const ComputePrimitivesShaderCodes &shaderCodes, const PipelineBuilder::ComputePipelineCreator &creator, bool isSubgroup);
+    // Wait the pipelines, rethrows the Turbo::Core::TException of a failed one
+    static ComputePrimitivesPipelines GetPipelines(const ComputePrimitivesPipelineFutures &pipelineFutures);
+
+    // groupCount groups split over x and y, the shader flattens them back with gl_WorkGroupID.y * gl_NumWorkGroups.x + gl_WorkGroupID.x
+    // and skips the groups past its count
+    static void CmdDispatchGroups(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, uint32_t groupCount);
+
+    ComputePrimitives(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const ComputePrimitivesPipelines &pipelines);
+    ~ComputePrimitives();
+
+    ComputePrimitives(const ComputePrimitives &) = delete;
+    ComputePrimitives &operator=(const ComputePrimitives &) = delete;
+
+  public:
+    // Release the scratch buffers and descriptor sets of everything recorded since the last Reset()
+    void Reset();
+
+    // values: count vec4, minMax: 2 vec4 (min then max, per component). count 0 records nothing
+    void CmdReduceMinMax(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &values, uint32_t count, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &minMax);
+
+    // output[i] = input[0] + ... + input[i - 1], input and output are different buffers of count uint32_t
+    void CmdExclusiveScan(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &input, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &output, uint32_t count);
+
+    // The values whose flag is 1 (flags are 0 or 1) in their order into output, and their count into outputCount (one uint32_t,
+    // needs BUFFER_TRANSFER_DST, it is filled with 0 for count 0)
+    void CmdCompact(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &values, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &flags, uint32_t count, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &output, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &outputCount);
+
+    // histogram (HISTOGRAM_BIN_COUNT uint32_t, needs BUFFER_TRANSFER_DST) of (key >> shift) & 255 over count uint32_t keys
+    void CmdHistogram(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &keys, uint32_t count, uint32_t shift, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &histogram);
+
+    // Stable ascending sort of count keys with their uint32_t values, in place. The scratch buffers are as large as keys and values,
+    // every pass swaps the two and the even pass count (4 or 8) leaves the result in keys and values
+    void CmdRadixSort(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, RadixKeyType keyType, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &keys, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &values, uint32_t count, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &scratchKeys, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &scratchValues);
+};
+
+#endif // !POINTCLOUD_COMPUTEPRIMITIVES_H
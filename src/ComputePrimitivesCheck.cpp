@@ -0,0 +1,303 @@
+#include "ComputePrimitivesCheck.h"
+#include "EmbeddedShaders.h"
+#include "HeadlessBenchmark.h"
+#include "PipelineBuilder.h"
+#include "ShaderCache.h"
+#include "WorkerPool.h"
+
+#include "../core/include/TBarrier.h"
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TCommandBufferPool.h"
+#include "../core/include/TDescriptorPool.h"
+#include "../core/include/TDevice.h"
+#include "../core/include/TDeviceQueue.h"
+#include "../core/include/TFence.h"
+#include "../core/include/TInstance.h"
+#include "../core/include/TPhysicalDevice.h"
+#include "../core/include/TPipelineCache.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <numeric>
+#include <random>
+
+namespace
+{
+// every buffer of the check is host visible, the primitives read and write them in place
+template <typename T>
+Turbo::Core::TRefPtr<Turbo::Core::TBuffer> CreateHostBuffer(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::vector<T> &items)
+{
+    Turbo::Core::TDeviceSize size = std::max<size_t>(1, items.size()) * sizeof(T);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_DST, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_RANDOM, size);
+    if (!items.empty())
+    {
+        memcpy(buffer->Map(), items.data(), items.size() * sizeof(T));
+        buffer->Unmap();
+    }
+    return buffer;
+}
+
+template <typename T>
+std::vector<T> ReadHostBuffer(const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &buffer, size_t count)
+{
+    std::vector<T> items(count);
+    if (count > 0)
+    {
+        memcpy(items.data(), buffer->Map(), count * sizeof(T));
+        buffer->Unmap();
+    }
+    return items;
+}
+
+class CheckRunner
+{
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> queue;
+    Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> commandPool;
+    uint32_t checkCount = 0;
+    uint32_t failCount = 0;
+
+  public:
+    explicit CheckRunner(const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &queue) : queue(queue)
+    {
+        this->commandPool = new Turbo::Core::TCommandBufferPool(queue);
+    }
+
+    // Record, submit and wait, the host can read the buffers afterwards
+    void Execute(ComputePrimitives &computePrimitives, const std::function<void(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &)> &record)
+    {
+        Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> command_buffer = this->commandPool->Allocate();
+        command_buffer->Begin();
+        record(command_buffer);
+        Turbo::Core::TMemoryBarrier host_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT | Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::HOST_READ_BIT);
+        command_buffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT | Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::HOST_BIT, host_barrier);
+        command_buffer->End();
+
+        Turbo::Core::TRefPtr<Turbo::Core::TFence> fence = new Turbo::Core::TFence(this->queue->GetDevice());
+        this->queue->Submit(command_buffer, fence);
+        fence->WaitUntil();
+        this->commandPool->Free(command_buffer);
+        computePrimitives.Reset();
+    }
+
+    // mismatch: index of the first wrong item, or -1
+    void Report(const std::string &name, const std::string &variant, uint32_t count, int64_t mismatch)
+    {
+        this->checkCount++;
+        if (mismatch < 0)
+        {
+            std::cout << "  ok       " << name << " (" << variant << ", " << count << " items)" << std::endl;
+            return;
+        }
+        this->failCount++;
+        std::cout << "  MISMATCH " << name << " (" << variant << ", " << count << " items) at item " << mismatch << std::endl;
+    }
+
+    uint32_t GetCheckCount() const
+    {
+        return this->checkCount;
+    }
+
+    uint32_t GetFailCount() const
+    {
+        return this->failCount;
+    }
+};
+
+template <typename T>
+int64_t FindMismatch(const std::vector<T> &result, const std::vector<T> &expected)
+{
+    std::pair<typename std::vector<T>::const_iterator, typename std::vector<T>::const_iterator> mismatch = std::mismatch(expected.begin(), expected.end(), result.begin());
+    return mismatch.first == expected.end() ? -1 : static_cast<int64_t>(mismatch.first - expected.begin());
+}
+
+void CheckReduceMinMax(CheckRunner &runner, ComputePrimitives &computePrimitives, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, std::mt19937 &random, uint32_t count, const std::string &variant)
+{
+    std::uniform_real_distribution<float> position_distribution(-1000.0f, 1000.0f);
+    std::vector<glm::vec4> values(count);
+    std::generate(values.begin(), values.end(), [&]() { return glm::vec4(position_distribution(random), position_distribution(random), position_distribution(random), 1.0f); });
+
+    std::vector<glm::vec4> expected = {values.front(), values.front()};
+    for (const glm::vec4 &value_item : values)
+    {
+        expected[0] = glm::min(expected[0], value_item);
+        expected[1] = glm::max(expected[1], value_item);
+    }
+
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> values_buffer = CreateHostBuffer(device, values);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> min_max_buffer = CreateHostBuffer(device, std::vector<glm::vec4>(2));
+    runner.Execute(computePrimitives, [&](const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer) { computePrimitives.CmdReduceMinMax(commandBuffer, values_buffer, count, min_max_buffer); });
+    runner.Report("reduce min/max", variant, count, FindMismatch(ReadHostBuffer<glm::vec4>(min_max_buffer, 2), expected));
+}
+
+void CheckExclusiveScan(CheckRunner &runner, ComputePrimitives &computePrimitives, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, std::mt19937 &random, uint32_t count, const std::string &variant)
+{
+    std::uniform_int_distribution<uint32_t> value_distribution(0, 16);
+    std::vector<uint32_t> values(count);
+    std::generate(values.begin(), values.end(), [&]() { return value_distribution(random); });
+
+    // exclusive: the inclusive sum shifted by one
+    std::vector<uint32_t> expected(count, 0);
+    std::partial_sum(values.begin(), values.end() - 1, expected.begin() + 1);
+
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> values_buffer = CreateHostBuffer(device, values);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> output_buffer = CreateHostBuffer(device, std::vector<uint32_t>(count));
+    runner.Execute(computePrimitives, [&](const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer) { computePrimitives.CmdExclusiveScan(commandBuffer, values_buffer, output_buffer, count); });
+    runner.Report("exclusive scan", variant, count, FindMismatch(ReadHostBuffer<uint32_t>(output_buffer, count), expected));
+}
+
+void CheckCompact(CheckRunner &runner, ComputePrimitives &computePrimitives, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, std::mt19937 &random, uint32_t count, const std::string &variant)
+{
+    std::bernoulli_distribution flag_distribution(0.3);
+    std::vector<uint32_t> values(count);
+    std::vector<uint32_t> flags(count);
+    std::generate(values.begin(), values.end(), [&]() { return static_cast<uint32_t>(random()); });
+    std::generate(flags.begin(), flags.end(), [&]() { return flag_distribution(random) ? 1u : 0u; });
+
+    std::vector<uint32_t> expected;
+    size_t value_index = 0;
+    std::copy_if(values.begin(), values.end(), std::back_inserter(expected), [&](uint32_t) { return flags[value_index++] != 0; });
+
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> values_buffer = CreateHostBuffer(device, values);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> flags_buffer = CreateHostBuffer(device, flags);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> output_buffer = CreateHostBuffer(device, std::vector<uint32_t>(count));
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> output_count_buffer = CreateHostBuffer(device, std::vector<uint32_t>(1, UINT32_MAX));
+    runner.Execute(computePrimitives, [&](const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer) { computePrimitives.CmdCompact(commandBuffer, values_buffer, flags_buffer, count, output_buffer, output_count_buffer); });
+
+    uint32_t output_count = ReadHostBuffer<uint32_t>(output_count_buffer, 1).front();
+    int64_t mismatch = output_count == expected.size() ? FindMismatch(ReadHostBuffer<uint32_t>(output_buffer, output_count), expected) : static_cast<int64_t>(std::min<size_t>(output_count, expected.size()));
+    runner.Report("compact", variant, count, mismatch);
+}
+
+void CheckHistogram(CheckRunner &runner, ComputePrimitives &computePrimitives, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, std::mt19937 &random, uint32_t count, const std::string &variant)
+{
+    const uint32_t shift = 8;
+    std::vector<uint32_t> keys(count);
+    std::generate(keys.begin(), keys.end(), [&]() { return static_cast<uint32_t>(random()); });
+
+    std::vector<uint32_t> expected(ComputePrimitives::HISTOGRAM_BIN_COUNT, 0);
+    std::for_each(keys.begin(), keys.end(), [&](uint32_t key) { expected[(key >> shift) & 255u]++; });
+
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> keys_buffer = CreateHostBuffer(device, keys);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> histogram_buffer = CreateHostBuffer(device, std::vector<uint32_t>(ComputePrimitives::HISTOGRAM_BIN_COUNT, UINT32_MAX));
+    runner.Execute(computePrimitives, [&](const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer) { computePrimitives.CmdHistogram(commandBuffer, keys_buffer, count, shift, histogram_buffer); });
+    runner.Report("histogram", variant, count, FindMismatch(ReadHostBuffer<uint32_t>(histogram_buffer, ComputePrimitives::HISTOGRAM_BIN_COUNT), expected));
+}
+
+template <typename KEY>
+void CheckRadixSort(CheckRunner &runner, ComputePrimitives &computePrimitives, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, std::mt19937_64 &random, uint32_t count, const std::string &variant)
+{
+    // full range keys (every digit pass sees all its bits) drawn from a pool a quarter of count large, so every key repeats
+    // about four times and the stability shows in the values. The smallest and the largest key are in the pool
+    std::vector<KEY> key_pool(std::max(1u, count / 4));
+    std::generate(key_pool.begin(), key_pool.end(), [&]() { return static_cast<KEY>(random() >> (64 - sizeof(KEY) * 8)); });
+    key_pool.front() = 0;
+    key_pool.back() = std::numeric_limits<KEY>::max();
+    std::uniform_int_distribution<size_t> key_pool_distribution(0, key_pool.size() - 1);
+    std::vector<KEY> keys(count);
+    std::generate(keys.begin(), keys.end(), [&]() { return key_pool[key_pool_distribution(random)]; });
+    std::vector<uint32_t> values(count);
+    std::iota(values.begin(), values.end(), 0u);
+
+    std::vector<uint32_t> expected_values = values;
+    std::stable_sort(expected_values.begin(), expected_values.end(), [&](uint32_t left, uint32_t right) { return keys[left] < keys[right]; });
+    std::vector<KEY> expected_keys(count);
+    std::transform(expected_values.begin(), expected_values.end(), expected_keys.begin(), [&](uint32_t value) { return keys[value]; });
+
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> keys_buffer = CreateHostBuffer(device, keys);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> values_buffer = CreateHostBuffer(device, values);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> scratch_keys_buffer = CreateHostBuffer(device, std::vector<KEY>(count));
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> scratch_values_buffer = CreateHostBuffer(device, std::vector<uint32_t>(count));
+    RadixKeyType key_type = sizeof(KEY) == sizeof(uint64_t) ? RadixKeyType::UINT64 : RadixKeyType::UINT32;
+    runner.Execute(computePrimitives, [&](const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer) { computePrimitives.CmdRadixSort(commandBuffer, key_type, keys_buffer, values_buffer, count, scratch_keys_buffer, scratch_values_buffer); });
+
+    int64_t mismatch = FindMismatch(ReadHostBuffer<KEY>(keys_buffer, count), expected_keys);
+    if (mismatch < 0)
+    {
+        mismatch = FindMismatch(ReadHostBuffer<uint32_t>(values_buffer, count), expected_values);
+    }
+    runner.Report(key_type == RadixKeyType::UINT64 ? "radix sort 64" : "radix sort 32", variant, count, mismatch);
+}
+} // namespace
+
+int RunComputePrimitivesCheck(const ComputePrimitivesCheckOptions &options)
+{
+    Turbo::Core::TVersion instance_version(1, 2, 0, 0);
+    Turbo::Core::TRefPtr<Turbo::Core::TInstance> instance = new Turbo::Core::TInstance(nullptr, nullptr, &instance_version);
+    Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> physical_device = FindPhysicalDevice(instance, options.deviceName);
+    if (physical_device.Get() == nullptr)
+    {
+        std::cerr << "No physical device matches " << options.deviceName << std::endl;
+        return 1;
+    }
+    std::cout << "Compute primitives check on " << physical_device->GetDeviceName() << std::endl;
+
+    Turbo::Core::TRefPtr<Turbo::Core::TDevice> device = new Turbo::Core::TDevice(physical_device, nullptr, nullptr, nullptr);
+    Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> queue = device->GetBestGraphicsQueue();
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> pipeline_cache = new Turbo::Core::TPipelineCache(device);
+
+    std::vector<Turbo::Core::TDescriptorSize> descriptor_sizes = {{Turbo::Core::TDescriptorType::STORAGE_BUFFER, 4096}};
+    Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> descriptor_pool = new Turbo::Core::TDescriptorPool(device, 1024, descriptor_sizes);
+
+    // the portable variants first, they also run where subgroups are missing
+    std::vector<bool> subgroup_variants = {false};
+    if (ComputePrimitives::IsSubgroupSupported(physical_device))
+    {
+        subgroup_variants.push_back(true);
+    }
+    else
+    {
+        std::cout << "No subgroup arithmetic in compute shaders, the SUBGROUP variants are skipped" << std::endl;
+    }
+
+    std::vector<ComputePrimitivesPipelines> variant_pipelines;
+    {
+        WorkerPool worker_pool;
+        ShaderCache shader_cache;
+        EmbedShaders(shader_cache);
+        PipelineBuilder pipeline_builder(worker_pool, shader_cache);
+        PipelineBuilder::ComputePipelineCreator create_compute_pipeline = [&](const Turbo::Core::TRefPtr<Turbo::Core::TComputeShader> &computeShader) {
+            return Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>(new Turbo::Core::TComputePipeline(pipeline_cache, computeShader));
+        };
+
+        std::vector<ComputePrimitivesPipelineFutures> variant_pipeline_futures;
+        for (bool is_subgroup : subgroup_variants)
+        {
+            variant_pipeline_futures.push_back(ComputePrimitives::BuildPipelines(pipeline_builder, device, options.shaderCodes, create_compute_pipeline, is_subgroup));
+        }
+        pipeline_builder.Wait();
+        for (const ComputePrimitivesPipelineFutures &pipeline_futures_item : variant_pipeline_futures)
+        {
+            variant_pipelines.push_back(ComputePrimitives::GetPipelines(pipeline_futures_item));
+        }
+    }
+
+    // the block edges, a single block, and counts which need a second and a third scan level
+    std::vector<uint32_t> counts = {1, 255, 256, 257, 65537, std::max(options.itemCount, 1u)};
+    CheckRunner runner(queue);
+    for (size_t variant_index = 0; variant_index < subgroup_variants.size(); variant_index++)
+    {
+        std::string variant = subgroup_variants[variant_index] ? "subgroup" : "shared memory";
+        ComputePrimitives compute_primitives(descriptor_pool, variant_pipelines[variant_index]);
+        std::mt19937 random(options.seed);
+        std::mt19937_64 random64(options.seed);
+        for (uint32_t count : counts)
+        {
+            CheckReduceMinMax(runner, compute_primitives, device, random, count, variant);
+            CheckExclusiveScan(runner, compute_primitives, device, random, count, variant);
+            CheckCompact(runner, compute_primitives, device, random, count, variant);
+            CheckHistogram(runner, compute_primitives, device, random, count, variant);
+            CheckRadixSort<uint32_t>(runner, compute_primitives, device, random64, count, variant);
+            CheckRadixSort<uint64_t>(runner, compute_primitives, device, random64, count, variant);
+        }
+    }
+
+    std::cout << runner.GetCheckCount() - runner.GetFailCount() << " of " << runner.GetCheckCount() << " checks match" << std::endl;
+    return runner.GetFailCount() == 0 ? 0 : 1;
+}
@@ -0,0 +1,23 @@
+#pragma once
+#ifndef POINTCLOUD_COMPUTEPRIMITIVESCHECK_H
+#define POINTCLOUD_COMPUTEPRIMITIVESCHECK_H
+#include "ComputePrimitives.h"
+
+#include <cstdint>
+#include <string>
+
+typedef struct ComputePrimitivesCheckOptions
+{
+    std::string deviceName;      // pick the first physical device whose name contains it (e.g. "llvmpipe"), the best one if empty
+    uint32_t itemCount = 1048579; // the largest count checked, enough for three scan levels; the smaller ones cover the block edges
+    uint32_t seed = 1;
+
+    ComputePrimitivesShaderCodes shaderCodes;
+} ComputePrimitivesCheckOptions;
+
+// Run every ComputePrimitives primitive on random data of several counts, with the portable and (if supported) the SUBGROUP
+// variants, and compare the results with the std:: algorithms on the host (std::partial_sum, std::copy_if, std::stable_sort, ...).
+// No layers, no surface, works on software ICDs such as lavapipe. Print a line per check, return the process exit code (0 if all match).
+int RunComputePrimitivesCheck(const ComputePrimitivesCheckOptions &options);
+
+#endif // !POINTCLOUD_COMPUTEPRIMITIVESCHECK_H
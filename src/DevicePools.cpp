@@ -0,0 +1,80 @@
+#include "DevicePools.h"
+
+#include "../core/include/TDevice.h"
+#include "../core/include/TVulkanLoader.h"
+
+DevicePools::DevicePools(const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &queue) : queue(queue), commandPoolMutex(std::make_shared<std::mutex>())
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TDevice> device = this->queue->GetDevice();
+
+    // WaitUntil() leaves the fence signaled, a fence comes back out of the pool unsignaled
+    this->fencePool = new Turbo::Core::TPool<Turbo::Core::TFence>(
+        0, [device]() -> Turbo::Core::TRefPtr<Turbo::Core::TFence> { return new Turbo::Core::TFence(device); },
+        [device](const Turbo::Core::TRefPtr<Turbo::Core::TFence> &fence) {
+            VkFence vk_fence = fence->GetVkFence();
+            device->GetDeviceDriver()->vkResetFences(device->GetVkDevice(), 1, &vk_fence);
+        });
+
+    // the command pool is externally synchronized, and Allocate()/Free() change the child list of the TCommandBufferPool
+    Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> command_pool = new Turbo::Core::TCommandBufferPool(this->queue);
+    std::shared_ptr<std::mutex> command_pool_mutex = this->commandPoolMutex;
+    this->commandBufferPool = new Turbo::Core::TPool<Turbo::Core::TCommandBuffer>(
+        0,
+        [command_pool, command_pool_mutex]() -> Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> {
+            std::lock_guard<std::mutex> lock(*command_pool_mutex);
+            return command_pool->Allocate();
+        },
+        [command_pool_mutex](const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer) {
+            std::lock_guard<std::mutex> lock(*command_pool_mutex);
+            commandBuffer->Reset();
+        },
+        // the command buffers hold their pool and the pool holds them until Free()
+        [command_pool, command_pool_mutex](const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer) {
+            std::lock_guard<std::mutex> lock(*command_pool_mutex);
+            Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> command_buffer = commandBuffer;
+            command_pool->Free(command_buffer);
+        });
+}
+
+DevicePools::Fence DevicePools::AcquireFence()
+{
+    return this->fencePool->Allocate();
+}
+
+DevicePools::Semaphore DevicePools::AcquireSemaphore(Turbo::Core::TPipelineStages waitDstStageMask)
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TPool<Turbo::Core::TSemaphore>> semaphore_pool;
+    {
+        std::lock_guard<std::mutex> lock(this->semaphoreMutex);
+        Turbo::Core::TRefPtr<Turbo::Core::TPool<Turbo::Core::TSemaphore>> &pool_item = this->semaphorePools[waitDstStageMask];
+        if (pool_item.Get() == nullptr)
+        {
+            Turbo::Core::TRefPtr<Turbo::Core::TDevice> device = this->queue->GetDevice();
+            // a waited binary semaphore is unsignaled again, nothing to recycle
+            pool_item = new Turbo::Core::TPool<Turbo::Core::TSemaphore>(0, [device, waitDstStageMask]() -> Turbo::Core::TRefPtr<Turbo::Core::TSemaphore> { return new Turbo::Core::TSemaphore(device, waitDstStageMask); });
+        }
+        semaphore_pool = pool_item;
+    }
+    return semaphore_pool->Allocate();
+}
+
+DevicePools::CommandBuffer DevicePools::AcquireCommandBuffer()
+{
+    return this->commandBufferPool->Allocate();
+}
+
+const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &DevicePools::GetQueue() const
+{
+    return this->queue;
+}
+
+uint32_t DevicePools::GetCreatedCount()
+{
+    uint32_t created_count = this->fencePool->GetCreatedCount() + this->commandBufferPool->GetCreatedCount();
+    std::lock_guard<std::mutex> lock(this->semaphoreMutex);
+    for (auto &semaphore_pool_item : this->semaphorePools)
+    {
+        created_count += semaphore_pool_item.second->GetCreatedCount();
+    }
+    return created_count;
+}
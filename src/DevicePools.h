@@ -0,0 +1,52 @@
+#pragma once
+#ifndef POINTCLOUD_DEVICEPOOLS_H
+#define POINTCLOUD_DEVICEPOOLS_H
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TCommandBufferPool.h"
+#include "../core/include/TDeviceQueue.h"
+#include "../core/include/TFence.h"
+#include "../core/include/TPool.h"
+#include "../core/include/TSemaphore.h"
+
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Recycled per frame and per submission objects of one queue: unsignaled fences, binary semaphores and reset primary command buffers.
+// Each goes back to its pool when the last TRefPtr of its handle drops, so only the first use of each creates a Vulkan object.
+// NOTE: Drop a fence or a command buffer only once its submission was waited on (or it was never submitted), a semaphore only once nothing
+//       waits on or signals it any more (its frame fence was waited on). Discard() the handle otherwise, it is destroyed instead.
+// NOTE: The recyclers reset the Vulkan objects, acquire and drop the handles on the thread which owns the DevicePools (never inside a WorkerPool task)
+// NOTE: A handle may outlive the DevicePools, it holds its TPool<T> and that holds the device objects it needs
+class DevicePools
+{
+  public:
+    typedef Turbo::Core::TRefPtr<Turbo::Core::TPoolObject<Turbo::Core::TFence>> Fence;
+    typedef Turbo::Core::TRefPtr<Turbo::Core::TPoolObject<Turbo::Core::TSemaphore>> Semaphore;
+    typedef Turbo::Core::TRefPtr<Turbo::Core::TPoolObject<Turbo::Core::TCommandBuffer>> CommandBuffer;
+
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> queue;
+    std::shared_ptr<std::mutex> commandPoolMutex; // the creator, recycler and destroyer of the command buffers may outlive this
+    Turbo::Core::TRefPtr<Turbo::Core::TPool<Turbo::Core::TFence>> fencePool;
+    Turbo::Core::TRefPtr<Turbo::Core::TPool<Turbo::Core::TCommandBuffer>> commandBufferPool;
+
+    std::mutex semaphoreMutex;
+    std::map<Turbo::Core::TPipelineStages, Turbo::Core::TRefPtr<Turbo::Core::TPool<Turbo::Core::TSemaphore>>> semaphorePools; // by wait stage
+
+  public:
+    explicit DevicePools(const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &queue);
+
+    DevicePools(const DevicePools &) = delete;
+    DevicePools &operator=(const DevicePools &) = delete;
+
+  public:
+    Fence AcquireFence();
+    Semaphore AcquireSemaphore(Turbo::Core::TPipelineStages waitDstStageMask);
+    CommandBuffer AcquireCommandBuffer();
+
+    const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &GetQueue() const;
+    uint32_t GetCreatedCount(); // fences, semaphores and command buffers created so far and still alive
+};
+
+#endif // !POINTCLOUD_DEVICEPOOLS_H
@@ -0,0 +1,160 @@
+#include "DynamicResolution.h"
+
+#include "../core/include/TAttachment.h"
+#include "../core/include/TBarrier.h"
+
+#include <algorithm>
+#include <cmath>
+
+constexpr double DynamicResolution::MIN_SCALE;
+constexpr double DynamicResolution::MAX_SCALE;
+
+namespace
+{
+const double SCALE_DAMPING = 0.25;    // share of the step taken per resolved frame, the GPU times lag GpuProfiler::FRAME_COUNT frames
+const double SCALE_UP_HEADROOM = 1.1; // only scale up below target / 1.1, keeps the scale from hunting around the target
+
+// One axis of the upscale. A LINEAR blit of [0, renderSize) reaches half a texel past its far edge into texel renderSize, which is
+// outside the rendered region. So the LINEAR part stops one texel short and the last texel is stretched over the rest with NEAREST
+typedef struct BlitSplit
+{
+    int32_t srcSplit; // [0, srcSplit) LINEAR, [srcSplit, renderSize) NEAREST
+    int32_t dstSplit;
+} BlitSplit;
+
+BlitSplit GetBlitSplit(int32_t renderSize, int32_t targetSize, int32_t dstSize)
+{
+    BlitSplit split;
+    if (renderSize >= targetSize)
+    {
+        // the whole target, the sampling clamps at the edge of the image
+        split.srcSplit = renderSize;
+        split.dstSplit = dstSize;
+        return split;
+    }
+
+    split.srcSplit = renderSize - 1;
+    split.dstSplit = static_cast<int32_t>(std::lround(static_cast<double>(dstSize) * split.srcSplit / renderSize));
+    return split;
+}
+} // namespace
+
+DynamicResolution::DynamicResolution(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, Turbo::Core::TFormatInfo colorFormat, Turbo::Core::TFormatInfo depthFormat, std::vector<Turbo::Core::TSubpass> &subpasses) : colorFormat(colorFormat), depthFormat(depthFormat)
+{
+    Turbo::Core::TAttachment color_attachment(colorFormat, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_SRC_OPTIMAL);
+    Turbo::Core::TAttachment depth_attachment(depthFormat, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    std::vector<Turbo::Core::TAttachment> attachments = {color_attachment, depth_attachment};
+    this->renderPass = new Turbo::Core::TRenderPass(device, attachments, subpasses);
+}
+
+DynamicResolution::~DynamicResolution()
+{
+}
+
+void DynamicResolution::SetTargets(uint32_t width, uint32_t height)
+{
+    const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device = this->renderPass->GetDevice();
+    this->width = std::max(1u, width);
+    this->height = std::max(1u, height);
+
+    this->colorImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, this->colorFormat.GetFormatType(), this->width, this->height, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_COLOR_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    this->colorImageView = new Turbo::Core::TImageView(this->colorImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->colorImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+    this->depthImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, this->depthFormat.GetFormatType(), this->width, this->height, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_DEPTH_STENCIL_ATTACHMENT, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    this->depthImageView = new Turbo::Core::TImageView(this->depthImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->depthImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_DEPTH_BIT, 0, 1, 0, 1);
+
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> image_views = {this->colorImageView, this->depthImageView};
+    this->framebuffer = new Turbo::Core::TFramebuffer(this->renderPass, image_views);
+}
+
+void DynamicResolution::Update(double gpuFrameTime)
+{
+    double ratio = this->targetFrameTime / std::max(gpuFrameTime, 0.01);
+    if (ratio >= 1.0 && ratio <= SCALE_UP_HEADROOM)
+    {
+        return;
+    }
+
+    double desired_scale = this->scale * std::sqrt(ratio);
+    this->SetScale(this->scale + (desired_scale - this->scale) * SCALE_DAMPING);
+}
+
+void DynamicResolution::SetScale(double scale)
+{
+    this->scale = std::min(std::max(scale, MIN_SCALE), MAX_SCALE);
+}
+
+double DynamicResolution::GetScale() const
+{
+    return this->scale;
+}
+
+void DynamicResolution::SetTargetFrameTime(double targetFrameTime)
+{
+    this->targetFrameTime = std::max(targetFrameTime, 0.1);
+}
+
+double DynamicResolution::GetTargetFrameTime() const
+{
+    return this->targetFrameTime;
+}
+
+uint32_t DynamicResolution::GetRenderWidth() const
+{
+    return std::min(this->width, std::max(1u, static_cast<uint32_t>(this->width * this->scale + 0.5)));
+}
+
+uint32_t DynamicResolution::GetRenderHeight() const
+{
+    return std::min(this->height, std::max(1u, static_cast<uint32_t>(this->height * this->scale + 0.5)));
+}
+
+void DynamicResolution::CmdBegin(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    // the clear and the stores only touch the render area, the rest of the targets is never read
+    commandBuffer->CmdBeginRenderPass(this->renderPass, this->framebuffer, Turbo::Core::TSubpassContents::INLINE, 0, 0, this->GetRenderWidth(), this->GetRenderHeight());
+}
+
+void DynamicResolution::CmdEnd(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    // subpass 1 is the ImGui subpass of the points render pass, nothing is drawn there
+    commandBuffer->CmdNextSubpass();
+    commandBuffer->CmdEndRenderPass();
+}
+
+void DynamicResolution::CmdBlitToImage(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TImage> &image)
+{
+    Turbo::Core::TMemoryBarrier render_barrier(Turbo::Core::TAccessBits::COLOR_ATTACHMENT_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, render_barrier);
+
+    // the swapchain image acquire semaphore is waited at COLOR_ATTACHMENT_OUTPUT, the blit has to wait for it too
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, 0, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, image, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+    int32_t render_width = static_cast<int32_t>(this->GetRenderWidth());
+    int32_t render_height = static_cast<int32_t>(this->GetRenderHeight());
+    int32_t image_width = static_cast<int32_t>(image->GetWidth());
+    int32_t image_height = static_cast<int32_t>(image->GetHeight());
+    BlitSplit x_split = GetBlitSplit(render_width, static_cast<int32_t>(this->width), image_width);
+    BlitSplit y_split = GetBlitSplit(render_height, static_cast<int32_t>(this->height), image_height);
+    int32_t src_xs[3] = {0, x_split.srcSplit, render_width};
+    int32_t src_ys[3] = {0, y_split.srcSplit, render_height};
+    int32_t dst_xs[3] = {0, x_split.dstSplit, image_width};
+    int32_t dst_ys[3] = {0, y_split.dstSplit, image_height};
+
+    // the inner part, the right and bottom edge strips and their corner
+    for (uint32_t y_part = 0; y_part < 2; y_part++)
+    {
+        for (uint32_t x_part = 0; x_part < 2; x_part++)
+        {
+            if (src_xs[x_part] == src_xs[x_part + 1] || src_ys[y_part] == src_ys[y_part + 1] || dst_xs[x_part] == dst_xs[x_part + 1] || dst_ys[y_part] == dst_ys[y_part + 1])
+            {
+                continue;
+            }
+
+            Turbo::Core::TFilter filter = x_part == 0 && y_part == 0 ? Turbo::Core::TFilter::LINEAR : Turbo::Core::TFilter::NEAREST;
+            commandBuffer->CmdBlitImage(this->colorImage, Turbo::Core::TImageLayout::TRANSFER_SRC_OPTIMAL, image, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, src_xs[x_part], src_ys[y_part], 0, src_xs[x_part + 1], src_ys[y_part + 1], 1, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, dst_xs[x_part], dst_ys[y_part], 0, dst_xs[x_part + 1], dst_ys[y_part + 1], 1, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, filter);
+        }
+    }
+
+    Turbo::Core::TMemoryBarrier blit_barrier(Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::COLOR_ATTACHMENT_READ_BIT | Turbo::Core::TAccessBits::COLOR_ATTACHMENT_WRITE_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, blit_barrier);
+}
@@ -0,0 +1,72 @@
+#pragma once
+#ifndef POINTCLOUD_DYNAMICRESOLUTION_H
+#define POINTCLOUD_DYNAMICRESOLUTION_H
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TFramebuffer.h"
+#include "../core/include/TImage.h"
+#include "../core/include/TImageView.h"
+#include "../core/include/TRenderPass.h"
+
+#include <cstdint>
+#include <vector>
+
+// Points pass at a scaled resolution: the points are drawn into the top left GetRenderWidth() x GetRenderHeight() of an offscreen
+// color and depth target and CmdBlitToImage() upscales that region into the swapchain image, the caller draws ImGui over it.
+// The targets are allocated at the full swapchain size, so changing the scale every frame never reallocates.
+// Update() moves the scale between the min and max scale to hold the measured GPU frame time at the target frame time.
+class DynamicResolution
+{
+  public:
+    static constexpr double MIN_SCALE = 0.5;
+    static constexpr double MAX_SCALE = 1.0;
+
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> renderPass; // clears both, color ends in TRANSFER_SRC_OPTIMAL
+    Turbo::Core::TFormatInfo colorFormat;
+    Turbo::Core::TFormatInfo depthFormat;
+
+    uint32_t width = 0; // swapchain size
+    uint32_t height = 0;
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> colorImage;
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> colorImageView;
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> depthImage;
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> depthImageView;
+    Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> framebuffer;
+
+    double scale = MAX_SCALE;               // per axis
+    double targetFrameTime = 1000.0 / 60.0; // millisecond
+
+  public:
+    // subpasses of the points render pass, so the points pipelines stay compatible with the scaled render pass
+    DynamicResolution(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, Turbo::Core::TFormatInfo colorFormat, Turbo::Core::TFormatInfo depthFormat, std::vector<Turbo::Core::TSubpass> &subpasses);
+    ~DynamicResolution();
+
+    DynamicResolution(const DynamicResolution &) = delete;
+    DynamicResolution &operator=(const DynamicResolution &) = delete;
+
+  public:
+    // After every (re)creation of the swapchain
+    void SetTargets(uint32_t width, uint32_t height);
+
+    // With every newly resolved GPU frame time in millisecond. The pixel cost grows with the square of the scale,
+    // so the scale moves by the square root of target / measured, damped against the latency of the timestamps.
+    void Update(double gpuFrameTime);
+
+    void SetScale(double scale);
+    double GetScale() const;
+    void SetTargetFrameTime(double targetFrameTime);
+    double GetTargetFrameTime() const;
+
+    uint32_t GetRenderWidth() const;
+    uint32_t GetRenderHeight() const;
+
+    // Outside a render pass. Begins subpass 0 of the scaled render pass, the caller binds the points pipeline with a
+    // GetRenderWidth() x GetRenderHeight() viewport and draws, CmdEnd() finishes the render pass.
+    void CmdBegin(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer);
+    void CmdEnd(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer);
+
+    // Outside a render pass. Leaves image in TRANSFER_DST_OPTIMAL, its content before is discarded.
+    void CmdBlitToImage(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TImage> &image);
+};
+
+#endif // !POINTCLOUD_DYNAMICRESOLUTION_H
@@ -0,0 +1,64 @@
+#pragma once
+#ifndef POINTCLOUD_EMBEDDEDSHADERS_H
+#define POINTCLOUD_EMBEDDEDSHADERS_H
+#include "ShaderCache.h"
+
+// Build with POINTCLOUD_EMBEDDED_SPIRV defined after running shaders/CompileShaders.bat to link the SPIR-V into the binary,
+// the source of each shader goes along so an edited shader is compiled again instead of running the embedded build
+#if defined(POINTCLOUD_EMBEDDED_SPIRV)
+#include "../shaders/spirv/HiZCull.comp.h"
+#include "../shaders/spirv/HiZCull.comp.src.h"
+#include "../shaders/spirv/HiZPyramid.comp.h"
+#include "../shaders/spirv/HiZPyramid.comp.src.h"
+#include "../shaders/spirv/PointCloud.frag.h"
+#include "../shaders/spirv/PointCloud.frag.src.h"
+#include "../shaders/spirv/PointCloud.vert.h"
+#include "../shaders/spirv/PointCloud.vert.src.h"
+#include "../shaders/spirv/PointCloudBuffer.vert.h"
+#include "../shaders/spirv/PointCloudBuffer.vert.src.h"
+#include "../shaders/spirv/PullPush.comp.h"
+#include "../shaders/spirv/PullPush.comp.src.h"
+#include "../shaders/spirv/PointCull.comp.h"
+#include "../shaders/spirv/PointCull.comp.src.h"
+#include "../shaders/spirv/Reduce.comp.h"
+#include "../shaders/spirv/Reduce.comp.src.h"
+#include "../shaders/spirv/Scan.comp.h"
+#include "../shaders/spirv/Scan.comp.src.h"
+#include "../shaders/spirv/Compact.comp.h"
+#include "../shaders/spirv/Compact.comp.src.h"
+#include "../shaders/spirv/Histogram.comp.h"
+#include "../shaders/spirv/Histogram.comp.src.h"
+#include "../shaders/spirv/RadixSort.comp.h"
+#include "../shaders/spirv/RadixSort.comp.src.h"
+#include "../shaders/spirv/MortonSort.comp.h"
+#include "../shaders/spirv/MortonSort.comp.src.h"
+#include "../shaders/spirv/imgui.frag.h"
+#include "../shaders/spirv/imgui.frag.src.h"
+#include "../shaders/spirv/imgui.vert.h"
+#include "../shaders/spirv/imgui.vert.src.h"
+#endif
+
+inline void EmbedShaders(ShaderCache &shaderCache)
+{
+#if defined(POINTCLOUD_EMBEDDED_SPIRV)
+    shaderCache.Embed("HiZCull.comp", HIZCULL_COMP_SPIRV, sizeof(HIZCULL_COMP_SPIRV), HIZCULL_COMP_SOURCE, sizeof(HIZCULL_COMP_SOURCE));
+    shaderCache.Embed("HiZPyramid.comp", HIZPYRAMID_COMP_SPIRV, sizeof(HIZPYRAMID_COMP_SPIRV), HIZPYRAMID_COMP_SOURCE, sizeof(HIZPYRAMID_COMP_SOURCE)); // HIZ_FROM_DEPTH still goes through the cache
+    shaderCache.Embed("PointCloud.frag", POINTCLOUD_FRAG_SPIRV, sizeof(POINTCLOUD_FRAG_SPIRV), POINTCLOUD_FRAG_SOURCE, sizeof(POINTCLOUD_FRAG_SOURCE));
+    shaderCache.Embed("PointCloud.vert", POINTCLOUD_VERT_SPIRV, sizeof(POINTCLOUD_VERT_SPIRV), POINTCLOUD_VERT_SOURCE, sizeof(POINTCLOUD_VERT_SOURCE));
+    shaderCache.Embed("PointCloudBuffer.vert", POINTCLOUDBUFFER_VERT_SPIRV, sizeof(POINTCLOUDBUFFER_VERT_SPIRV), POINTCLOUDBUFFER_VERT_SOURCE, sizeof(POINTCLOUDBUFFER_VERT_SOURCE));
+    shaderCache.Embed("PullPush.comp", PULLPUSH_COMP_SPIRV, sizeof(PULLPUSH_COMP_SPIRV), PULLPUSH_COMP_SOURCE, sizeof(PULLPUSH_COMP_SOURCE)); // PUSH, the PULL variants still go through the cache
+    shaderCache.Embed("PointCull.comp", POINTCULL_COMP_SPIRV, sizeof(POINTCULL_COMP_SPIRV), POINTCULL_COMP_SOURCE, sizeof(POINTCULL_COMP_SOURCE)); // buffer storage, POINTS_IMAGE still goes through the cache
+    shaderCache.Embed("Reduce.comp", REDUCE_COMP_SPIRV, sizeof(REDUCE_COMP_SPIRV), REDUCE_COMP_SOURCE, sizeof(REDUCE_COMP_SOURCE)); // shared memory, SUBGROUP still goes through the cache
+    shaderCache.Embed("Scan.comp", SCAN_COMP_SPIRV, sizeof(SCAN_COMP_SPIRV), SCAN_COMP_SOURCE, sizeof(SCAN_COMP_SOURCE)); // SCAN_BLOCKS in shared memory, SUBGROUP and SCAN_ADD still go through the cache
+    shaderCache.Embed("Compact.comp", COMPACT_COMP_SPIRV, sizeof(COMPACT_COMP_SPIRV), COMPACT_COMP_SOURCE, sizeof(COMPACT_COMP_SOURCE));
+    shaderCache.Embed("Histogram.comp", HISTOGRAM_COMP_SPIRV, sizeof(HISTOGRAM_COMP_SPIRV), HISTOGRAM_COMP_SOURCE, sizeof(HISTOGRAM_COMP_SOURCE));
+    shaderCache.Embed("RadixSort.comp", RADIXSORT_COMP_SPIRV, sizeof(RADIXSORT_COMP_SPIRV), RADIXSORT_COMP_SOURCE, sizeof(RADIXSORT_COMP_SOURCE)); // RADIX_COUNT of 32 bit keys, the other variants still go through the cache
+    shaderCache.Embed("MortonSort.comp", MORTONSORT_COMP_SPIRV, sizeof(MORTONSORT_COMP_SPIRV), MORTONSORT_COMP_SOURCE, sizeof(MORTONSORT_COMP_SOURCE)); // MORTON_KEYS, MORTON_SPLIT and MORTON_GATHER still go through the cache
+    shaderCache.Embed("imgui.frag", IMGUI_FRAG_SPIRV, sizeof(IMGUI_FRAG_SPIRV), IMGUI_FRAG_SOURCE, sizeof(IMGUI_FRAG_SOURCE));
+    shaderCache.Embed("imgui.vert", IMGUI_VERT_SPIRV, sizeof(IMGUI_VERT_SPIRV), IMGUI_VERT_SOURCE, sizeof(IMGUI_VERT_SOURCE));
+#else
+    (void)shaderCache;
+#endif
+}
+
+#endif // !POINTCLOUD_EMBEDDEDSHADERS_H
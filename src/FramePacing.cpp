@@ -0,0 +1,149 @@
+#include "FramePacing.h"
+
+#include <algorithm>
+
+constexpr double FramePacing::AVERAGE_WEIGHT;
+
+Turbo::Extension::TPresentMode ChoosePresentMode(const Turbo::Core::TRefPtr<Turbo::Extension::TSurface> &surface, Turbo::Extension::TPresentMode presentMode)
+{
+    switch (presentMode)
+    {
+    case Turbo::Extension::TPresentMode::IMMEDIATE:
+        return surface->IsSupportPresentModeImmediate() ? presentMode : Turbo::Extension::TPresentMode::FIFO;
+    case Turbo::Extension::TPresentMode::MAILBOX:
+        return surface->IsSupportPresentModeMailbox() ? presentMode : Turbo::Extension::TPresentMode::FIFO;
+    case Turbo::Extension::TPresentMode::FIFO_RELAXED:
+        return surface->IsSupportPresentModeFifoRelaxed() ? presentMode : Turbo::Extension::TPresentMode::FIFO;
+    default:
+        return Turbo::Extension::TPresentMode::FIFO;
+    }
+}
+
+const char *GetPresentModeName(Turbo::Extension::TPresentMode presentMode)
+{
+    switch (presentMode)
+    {
+    case Turbo::Extension::TPresentMode::IMMEDIATE:
+        return "Immediate";
+    case Turbo::Extension::TPresentMode::MAILBOX:
+        return "Mailbox";
+    case Turbo::Extension::TPresentMode::FIFO:
+        return "FIFO";
+    case Turbo::Extension::TPresentMode::FIFO_RELAXED:
+        return "FIFO relaxed";
+    default:
+        return "Unknown";
+    }
+}
+
+Turbo::Core::TRefPtr<Turbo::Extension::TSwapchain> CreateSwapchain(const Turbo::Core::TRefPtr<Turbo::Extension::TSurface> &surface, uint32_t imageCount, Turbo::Core::TFormatType formatType, Turbo::Core::TImageUsages usages, Turbo::Extension::TPresentMode presentMode)
+{
+    uint32_t image_count = std::max(imageCount, surface->GetMinImageCount());
+    if (surface->GetMaxImageCount() > 0) // 0 means no limit
+    {
+        image_count = std::min(image_count, surface->GetMaxImageCount());
+    }
+
+    Turbo::Extension::TCompositeAlphaBits composite_alpha = Turbo::Extension::TCompositeAlphaBits::ALPHA_OPAQUE_BIT;
+    if (!surface->IsSupportCompositeAlphaOpaque())
+    {
+        composite_alpha = surface->IsSupportCompositeAlphaInherit() ? Turbo::Extension::TCompositeAlphaBits::ALPHA_INHERIT_BIT : Turbo::Extension::TCompositeAlphaBits::ALPHA_PRE_MULTIPLIED_BIT;
+    }
+
+    return new Turbo::Extension::TSwapchain(surface, image_count, formatType, surface->GetCurrentWidth(), surface->GetCurrentHeight(), 1, usages, surface->GetCurrentTransform(), composite_alpha, ChoosePresentMode(surface, presentMode), true);
+}
+
+void FramePacing::SetPolicy(FramePacingPolicy policy)
+{
+    this->policy = policy;
+}
+
+FramePacingPolicy FramePacing::GetPolicy() const
+{
+    return this->policy;
+}
+
+void FramePacing::SetRefreshRate(int refreshRate)
+{
+    this->refreshPeriod = 1000.0 / (refreshRate > 0 ? refreshRate : 60);
+}
+
+double FramePacing::GetRefreshPeriod() const
+{
+    return this->refreshPeriod;
+}
+
+void FramePacing::BeginAcquire()
+{
+    this->acquireBeginTime = std::chrono::steady_clock::now();
+}
+
+void FramePacing::EndAcquire()
+{
+    this->acquireWaitTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->acquireBeginTime).count();
+}
+
+void FramePacing::MarkInput()
+{
+    this->inputTime = std::chrono::steady_clock::now();
+}
+
+void FramePacing::MarkPresent(Turbo::Extension::TPresentMode presentMode, uint32_t imageCount)
+{
+    double input_to_present_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->inputTime).count();
+    // THROUGHPUT samples before the acquire, so its wait is part of the latency
+    if (this->policy == FramePacingPolicy::THROUGHPUT)
+    {
+        input_to_present_time += this->acquireWaitTime;
+    }
+
+    double display_delay = this->refreshPeriod;
+    switch (presentMode)
+    {
+    case Turbo::Extension::TPresentMode::IMMEDIATE:
+        display_delay = this->refreshPeriod * 0.5;
+        break;
+    case Turbo::Extension::TPresentMode::MAILBOX:
+        display_delay = this->refreshPeriod;
+        break;
+    default: {
+        // a wait longer than half a refresh means the present queue was full
+        uint32_t queued_count = this->acquireWaitTime > this->refreshPeriod * 0.5 && imageCount > 1 ? imageCount - 1 : 0;
+        display_delay = this->refreshPeriod * (1 + queued_count);
+    }
+    break;
+    }
+
+    double latency = input_to_present_time + display_delay;
+    if (!this->isAverageValid)
+    {
+        this->inputToPresentTime = input_to_present_time;
+        this->displayDelay = display_delay;
+        this->latency = latency;
+        this->isAverageValid = true;
+        return;
+    }
+    this->inputToPresentTime += (input_to_present_time - this->inputToPresentTime) * AVERAGE_WEIGHT;
+    this->displayDelay += (display_delay - this->displayDelay) * AVERAGE_WEIGHT;
+    this->latency += (latency - this->latency) * AVERAGE_WEIGHT;
+}
+
+double FramePacing::GetAcquireWaitTime() const
+{
+    return this->acquireWaitTime;
+}
+
+double FramePacing::GetInputToPresentTime() const
+{
+    return this->inputToPresentTime;
+}
+
+double FramePacing::GetDisplayDelay() const
+{
+    return this->displayDelay;
+}
+
+double FramePacing::GetLatency() const
+{
+    return this->latency;
+}
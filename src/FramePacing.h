@@ -0,0 +1,68 @@
+#pragma once
+#ifndef POINTCLOUD_FRAMEPACING_H
+#define POINTCLOUD_FRAMEPACING_H
+#include "../core/include/TSurface.h"
+#include "../core/include/TSwapchain.h"
+
+#include <chrono>
+#include <cstdint>
+
+typedef enum class FramePacingPolicy
+{
+    THROUGHPUT,  // input is sampled before AcquireNextImageUntil() blocks, it is as old as the wait for a free image
+    LOW_LATENCY, // events are polled again once the image is acquired, the input is sampled right before recording
+} FramePacingPolicy;
+
+// FIFO is the only present mode every surface supports, it replaces an unsupported one
+Turbo::Extension::TPresentMode ChoosePresentMode(const Turbo::Core::TRefPtr<Turbo::Extension::TSurface> &surface, Turbo::Extension::TPresentMode presentMode);
+const char *GetPresentModeName(Turbo::Extension::TPresentMode presentMode);
+
+// The image count is clamped to what the surface supports, its current extent, transform and an opaque composite alpha are used
+Turbo::Core::TRefPtr<Turbo::Extension::TSwapchain> CreateSwapchain(const Turbo::Core::TRefPtr<Turbo::Extension::TSurface> &surface, uint32_t imageCount, Turbo::Core::TFormatType formatType, Turbo::Core::TImageUsages usages, Turbo::Extension::TPresentMode presentMode);
+
+// Input to photon latency estimate. Without present timing extensions the moment the image reaches the display is not observable,
+// so the estimate is the measured time from the input sample to the return of vkQueuePresentKHR plus a display delay modeled
+// from the present mode and the refresh period:
+//   IMMEDIATE           half a refresh, the tear line is on average halfway down the scanout
+//   MAILBOX             the wait for the next vblank plus half a scanout, one refresh
+//   FIFO, FIFO_RELAXED  the same plus a refresh per image queued ahead, all but one image are queued when the last acquire had to wait
+class FramePacing
+{
+  public:
+    static constexpr double AVERAGE_WEIGHT = 0.05; // of the newest frame in the averages
+
+  private:
+    FramePacingPolicy policy = FramePacingPolicy::THROUGHPUT;
+    double refreshPeriod = 1000.0 / 60.0; // millisecond
+
+    std::chrono::steady_clock::time_point acquireBeginTime;
+    std::chrono::steady_clock::time_point inputTime;
+    double acquireWaitTime = 0; // millisecond, of the current frame
+
+    double inputToPresentTime = 0; // millisecond, averages
+    double displayDelay = 0;
+    double latency = 0;
+    bool isAverageValid = false;
+
+  public:
+    void SetPolicy(FramePacingPolicy policy);
+    FramePacingPolicy GetPolicy() const;
+    // 0 or less keeps 60 Hz
+    void SetRefreshRate(int refreshRate);
+    double GetRefreshPeriod() const;
+
+    // Around AcquireNextImageUntil()
+    void BeginAcquire();
+    void EndAcquire();
+    // Right before the camera reads the input
+    void MarkInput();
+    // Right after the present returned
+    void MarkPresent(Turbo::Extension::TPresentMode presentMode, uint32_t imageCount);
+
+    double GetAcquireWaitTime() const;
+    double GetInputToPresentTime() const;
+    double GetDisplayDelay() const;
+    double GetLatency() const;
+};
+
+#endif // !POINTCLOUD_FRAMEPACING_H
@@ -0,0 +1,245 @@
+#include "GpuProfiler.h"
+
+#include "../core/include/TDevice.h"
+#include "../core/include/TPhysicalDevice.h"
+
+#include <algorithm>
+#include <fstream>
+
+constexpr uint32_t GpuProfiler::FRAME_COUNT;
+constexpr uint32_t GpuProfiler::MAX_ZONE_COUNT;
+constexpr uint32_t GpuProfiler::HISTORY_SIZE;
+
+GpuProfiler::GpuProfiler(const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &queue)
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TDevice> device = queue->GetDevice();
+
+    uint32_t timestamp_valid_bits = queue->GetQueueFamily().GetTimestampValidBits();
+    this->timestampPeriod = device->GetPhysicalDevice()->GetDeviceLimits().timestampPeriod;
+    this->timestampMask = timestamp_valid_bits >= 64 ? UINT64_MAX : ((uint64_t(1) << timestamp_valid_bits) - 1);
+
+    // timestampValidBits == 0 means the queue does not support timestamps at all
+    if (timestamp_valid_bits != 0)
+    {
+        this->frames.resize(GpuProfiler::FRAME_COUNT);
+        for (Frame &frame_item : this->frames)
+        {
+            frame_item.queryPool.reset(new QueryPool(device, VK_QUERY_TYPE_TIMESTAMP, GpuProfiler::MAX_ZONE_COUNT * 2));
+        }
+    }
+}
+
+bool GpuProfiler::IsSupported() const
+{
+    return !this->frames.empty();
+}
+
+void GpuProfiler::Resolve(Frame &frame)
+{
+    frame.isPending = false;
+
+    uint32_t query_count = static_cast<uint32_t>(frame.zoneNames.size() * 2);
+    std::vector<uint64_t> timestamps;
+    if (frame.queryPool->GetResults(0, query_count, timestamps) != VK_SUCCESS)
+    {
+        this->droppedFrameCount++;
+        return;
+    }
+
+    std::vector<float> frame_times(this->zones.size(), 0.0f);
+    std::vector<bool> frame_recorded(this->zones.size(), false);
+    for (size_t zone_index = 0; zone_index < frame.zoneNames.size(); zone_index++)
+    {
+        uint64_t begin = timestamps[zone_index * 2] & this->timestampMask;
+        uint64_t end = timestamps[zone_index * 2 + 1] & this->timestampMask;
+        uint64_t ticks = (end - begin) & this->timestampMask; // the counter may wrap around within the valid bits
+        float time = static_cast<float>(ticks * this->timestampPeriod / 1000000.0);
+
+        size_t profiler_zone_index = 0;
+        while (profiler_zone_index < this->zones.size() && this->zones[profiler_zone_index].name != frame.zoneNames[zone_index])
+        {
+            profiler_zone_index++;
+        }
+        if (profiler_zone_index == this->zones.size())
+        {
+            Zone zone;
+            zone.name = frame.zoneNames[zone_index];
+            this->zones.push_back(zone);
+            frame_times.push_back(0.0f);
+            frame_recorded.push_back(false);
+        }
+        frame_times[profiler_zone_index] += time;
+        frame_recorded[profiler_zone_index] = true;
+    }
+
+    for (size_t zone_index = 0; zone_index < this->zones.size(); zone_index++)
+    {
+        Zone &zone = this->zones[zone_index];
+        zone.history[this->historyOffset] = frame_times[zone_index];
+        zone.isRecorded[this->historyOffset] = frame_recorded[zone_index];
+        zone.time = frame_times[zone_index];
+
+        // a frame which skipped the zone is no 0 ms sample
+        uint32_t sample_count = std::min<uint32_t>(this->resolvedFrameCount + 1, GpuProfiler::HISTORY_SIZE);
+        uint32_t recorded_count = 0;
+        double total_time = 0;
+        for (uint32_t sample_index = 0; sample_index < sample_count; sample_index++)
+        {
+            uint32_t history_index = (this->historyOffset + GpuProfiler::HISTORY_SIZE - sample_index) % GpuProfiler::HISTORY_SIZE;
+            if (zone.isRecorded[history_index])
+            {
+                total_time += zone.history[history_index];
+                recorded_count++;
+            }
+        }
+        zone.average = recorded_count > 0 ? total_time / recorded_count : 0;
+    }
+
+    this->historyOffset = (this->historyOffset + 1) % GpuProfiler::HISTORY_SIZE;
+    this->resolvedFrameCount++;
+    this->lastResolvedFrameIndex = frame.index;
+}
+
+void GpuProfiler::BeginFrame(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer)
+{
+    if (!this->IsSupported())
+    {
+        return;
+    }
+
+    Frame &frame = this->frames[this->frameIndex % GpuProfiler::FRAME_COUNT];
+    if (frame.isPending)
+    {
+        this->Resolve(frame);
+    }
+
+    frame.queryPool->CmdReset(commandBuffer, 0, frame.queryPool->GetCount());
+    frame.zoneNames.clear();
+    this->isRecording = true;
+}
+
+uint32_t GpuProfiler::BeginZone(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, const std::string &name)
+{
+    if (!this->isRecording)
+    {
+        return UINT32_MAX;
+    }
+
+    Frame &frame = this->frames[this->frameIndex % GpuProfiler::FRAME_COUNT];
+    if (frame.zoneNames.size() >= GpuProfiler::MAX_ZONE_COUNT)
+    {
+        return UINT32_MAX;
+    }
+
+    uint32_t zone = static_cast<uint32_t>(frame.zoneNames.size());
+    frame.zoneNames.push_back(name);
+    frame.queryPool->CmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, zone * 2);
+    return zone;
+}
+
+void GpuProfiler::EndZone(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, uint32_t zone)
+{
+    if (!this->isRecording || zone == UINT32_MAX)
+    {
+        return;
+    }
+
+    Frame &frame = this->frames[this->frameIndex % GpuProfiler::FRAME_COUNT];
+    frame.queryPool->CmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, zone * 2 + 1);
+}
+
+void GpuProfiler::EndFrame()
+{
+    if (!this->isRecording)
+    {
+        return;
+    }
+
+    Frame &frame = this->frames[this->frameIndex % GpuProfiler::FRAME_COUNT];
+    frame.index = this->frameIndex;
+    frame.isPending = true;
+    this->frameIndex++;
+    this->isRecording = false;
+}
+
+bool GpuProfiler::ResolveNext()
+{
+    if (this->isRecording)
+    {
+        return false;
+    }
+
+    uint64_t oldest_frame_index = this->frameIndex >= this->frames.size() ? this->frameIndex - this->frames.size() : 0;
+    for (uint64_t frame_index = oldest_frame_index; frame_index < this->frameIndex; frame_index++)
+    {
+        Frame &frame = this->frames[frame_index % GpuProfiler::FRAME_COUNT];
+        if (frame.isPending)
+        {
+            this->Resolve(frame);
+            return true;
+        }
+    }
+    return false;
+}
+
+const std::vector<GpuProfiler::Zone> &GpuProfiler::GetZones() const
+{
+    return this->zones;
+}
+
+uint32_t GpuProfiler::GetHistoryOffset() const
+{
+    return this->historyOffset;
+}
+
+uint32_t GpuProfiler::GetResolvedFrameCount() const
+{
+    return this->resolvedFrameCount;
+}
+
+uint64_t GpuProfiler::GetLastResolvedFrameIndex() const
+{
+    return this->lastResolvedFrameIndex;
+}
+
+uint32_t GpuProfiler::GetDroppedFrameCount() const
+{
+    return this->droppedFrameCount;
+}
+
+bool GpuProfiler::ExportCsv(const std::string &path) const
+{
+    std::ofstream out_stream(path, std::ios::trunc);
+    if (!out_stream.is_open())
+    {
+        return false;
+    }
+
+    out_stream << "frame";
+    for (const Zone &zone_item : this->zones)
+    {
+        out_stream << "," << zone_item.name << " (ms)";
+    }
+    out_stream << "\n";
+
+    uint32_t sample_count = std::min<uint32_t>(this->resolvedFrameCount, GpuProfiler::HISTORY_SIZE);
+    uint32_t first_frame = this->resolvedFrameCount - sample_count;
+    for (uint32_t sample_index = 0; sample_index < sample_count; sample_index++)
+    {
+        // the oldest sample sits at historyOffset once the ring buffer is full
+        uint32_t history_index = (this->historyOffset + GpuProfiler::HISTORY_SIZE - sample_count + sample_index) % GpuProfiler::HISTORY_SIZE;
+        out_stream << first_frame + sample_index;
+        for (const Zone &zone_item : this->zones)
+        {
+            // an empty cell where the zone was not recorded
+            out_stream << ",";
+            if (zone_item.isRecorded[history_index])
+            {
+                out_stream << zone_item.history[history_index];
+            }
+        }
+        out_stream << "\n";
+    }
+
+    return out_stream.good();
+}
@@ -0,0 +1,87 @@
+#pragma once
+#ifndef POINTCLOUD_GPUPROFILER_H
+#define POINTCLOUD_GPUPROFILER_H
+#include "QueryPool.h"
+
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TDeviceQueue.h"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// GPU zones measured with timestamp queries. Every frame slot owns its query pool and a slot is only read back
+// when it comes around again FRAME_COUNT frames later, with vkGetQueryPoolResults never waiting (not ready means the sample is dropped).
+// Zones are matched by name, so a zone may be skipped for some frames.
+class GpuProfiler
+{
+  public:
+    static constexpr uint32_t FRAME_COUNT = 3;
+    static constexpr uint32_t MAX_ZONE_COUNT = 16; // per frame
+    static constexpr uint32_t HISTORY_SIZE = 240;  // frames
+
+    typedef struct Zone
+    {
+        std::string name;
+        double time = 0;    // millisecond, last resolved frame
+        double average = 0; // millisecond, over the history frames which recorded the zone
+        std::vector<float> history = std::vector<float>(HISTORY_SIZE, 0.0f); // millisecond, ring buffer starting at GetHistoryOffset(), 0 where not recorded
+        std::vector<bool> isRecorded = std::vector<bool>(HISTORY_SIZE, false); // per history frame
+    } Zone;
+
+  private:
+    typedef struct Frame
+    {
+        std::unique_ptr<QueryPool> queryPool;
+        std::vector<std::string> zoneNames; // zone i uses the queries 2 * i and 2 * i + 1
+        uint64_t index = 0;                 // the EndFrame() count when it was submitted
+        bool isPending = false;
+    } Frame;
+
+  private:
+    std::vector<Frame> frames;
+    uint64_t frameIndex = 0;
+    bool isRecording = false;
+
+    double timestampPeriod = 0; // nanosecond per tick
+    uint64_t timestampMask = 0;
+
+    std::vector<Zone> zones;
+    uint32_t historyOffset = 0;
+    uint32_t resolvedFrameCount = 0;
+    uint32_t droppedFrameCount = 0;
+    uint64_t lastResolvedFrameIndex = 0;
+
+  private:
+    void Resolve(Frame &frame);
+
+  public:
+    explicit GpuProfiler(const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &queue);
+
+  public:
+    bool IsSupported() const;
+
+    // Right after TCommandBuffer::Begin(), outside of any render pass
+    void BeginFrame(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer);
+    // Return the zone index for EndZone(), UINT32_MAX if unsupported or MAX_ZONE_COUNT is reached.
+    // NOTE: not allowed inside a subpass recorded with TSubpassContents::SECONDARY_COMMAND_BUFFERS
+    uint32_t BeginZone(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, const std::string &name);
+    void EndZone(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, uint32_t zone);
+    // After the frame command buffer is submitted
+    void EndFrame();
+    // Resolve the oldest pending frame now instead of FRAME_COUNT frames later, false if none is pending.
+    // Only once its submission was waited on, otherwise its sample is dropped
+    bool ResolveNext();
+
+    const std::vector<Zone> &GetZones() const;
+    uint32_t GetHistoryOffset() const; // oldest sample of Zone::history
+    uint32_t GetResolvedFrameCount() const;
+    uint64_t GetLastResolvedFrameIndex() const; // Frame::index of the last resolved frame, the zones hold its times
+    uint32_t GetDroppedFrameCount() const;
+
+    // One row per history frame, one column per zone, in millisecond
+    bool ExportCsv(const std::string &path) const;
+};
+
+#endif // !POINTCLOUD_GPUPROFILER_H
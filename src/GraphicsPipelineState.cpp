@@ -0,0 +1,208 @@
+#include "GraphicsPipelineState.h"
+
+namespace
+{
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t Fnv1a(const void *data, size_t size)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+template <typename T>
+void AppendKey(std::string &key, const T &value)
+{
+    // enums, bools, integers and floats only, so the bytes are the value
+    key.append(reinterpret_cast<const char *>(&value), sizeof(T));
+}
+
+void AppendKey(std::string &key, bool value)
+{
+    key.push_back(value ? 1 : 0);
+}
+} // namespace
+
+std::string GraphicsPipelineState::GetKey() const
+{
+    std::string key;
+    key.reserve(256);
+
+    AppendKey(key, static_cast<uint32_t>(this->vertexBindings.size()));
+    for (const Turbo::Core::TVertexBinding &vertex_binding_item : this->vertexBindings)
+    {
+        AppendKey(key, vertex_binding_item.GetBinding());
+        AppendKey(key, vertex_binding_item.GetStride());
+        AppendKey(key, vertex_binding_item.GetVertexRate());
+        AppendKey(key, static_cast<uint32_t>(vertex_binding_item.GetVertexAttributes().size()));
+        for (const Turbo::Core::TVertexAttribute &vertex_attribute_item : vertex_binding_item.GetVertexAttributes())
+        {
+            AppendKey(key, vertex_attribute_item.GetLocation());
+            AppendKey(key, vertex_attribute_item.GetFormatType());
+            AppendKey(key, vertex_attribute_item.GetOffset());
+        }
+    }
+
+    AppendKey(key, this->topology);
+    AppendKey(key, this->primitiveRestartEnable);
+    AppendKey(key, this->depthClampEnable);
+    AppendKey(key, this->rasterizerDiscardEnable);
+    AppendKey(key, this->polygonMode);
+    AppendKey(key, this->cullMode);
+    AppendKey(key, this->frontFace);
+    AppendKey(key, this->depthBiasEnable);
+    AppendKey(key, this->depthBiasConstantFactor);
+    AppendKey(key, this->depthBiasClamp);
+    AppendKey(key, this->depthBiasSlopeFactor);
+    AppendKey(key, this->lineWidth);
+    AppendKey(key, this->multisampleEnable);
+    AppendKey(key, this->sample);
+    AppendKey(key, this->depthTestEnable);
+    AppendKey(key, this->depthWriteEnable);
+    AppendKey(key, this->depthCompareOp);
+    AppendKey(key, this->depthBoundsTestEnable);
+    AppendKey(key, this->stencilTestEnable);
+    AppendKey(key, this->frontFailOp);
+    AppendKey(key, this->frontPassOp);
+    AppendKey(key, this->frontDepthFailOp);
+    AppendKey(key, this->frontCompareOp);
+    AppendKey(key, this->frontCompareMask);
+    AppendKey(key, this->frontWriteMask);
+    AppendKey(key, this->frontReference);
+    AppendKey(key, this->backFailOp);
+    AppendKey(key, this->backPassOp);
+    AppendKey(key, this->backDepthFailOp);
+    AppendKey(key, this->backCompareOp);
+    AppendKey(key, this->backCompareMask);
+    AppendKey(key, this->backWriteMask);
+    AppendKey(key, this->backReference);
+    AppendKey(key, this->minDepthBounds);
+    AppendKey(key, this->maxDepthBounds);
+    AppendKey(key, this->logicOpEnable);
+    AppendKey(key, this->logicOp);
+    AppendKey(key, this->blendEnable);
+    AppendKey(key, this->srcColorBlendFactor);
+    AppendKey(key, this->dstColorBlendFactor);
+    AppendKey(key, this->colorBlendOp);
+    AppendKey(key, this->srcAlphaBlendFactor);
+    AppendKey(key, this->dstAlphaBlendFactor);
+    AppendKey(key, this->alphaBlendOp);
+    AppendKey(key, this->constantR);
+    AppendKey(key, this->constantG);
+    AppendKey(key, this->constantB);
+    AppendKey(key, this->constantA);
+
+    return key;
+}
+
+uint64_t GraphicsPipelineState::Hash() const
+{
+    std::string key = this->GetKey();
+    return Fnv1a(key.data(), key.size());
+}
+
+bool GraphicsPipelineState::operator==(const GraphicsPipelineState &other) const
+{
+    return this->GetKey() == other.GetKey();
+}
+
+bool GraphicsPipelineState::operator!=(const GraphicsPipelineState &other) const
+{
+    return !(*this == other);
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> CreateGraphicsPipeline(const Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> &pipelineCache, const Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> &renderPass, uint32_t subpass, const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> &vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> &fragmentShader, const GraphicsPipelineState &state)
+{
+    // TGraphicsPipeline takes the vertex bindings by non-const reference
+    std::vector<Turbo::Core::TVertexBinding> vertex_bindings = state.vertexBindings;
+    return new Turbo::Core::TGraphicsPipeline(pipelineCache, renderPass, subpass, vertex_bindings, vertexShader, fragmentShader, state.topology, state.primitiveRestartEnable, state.depthClampEnable, state.rasterizerDiscardEnable, state.polygonMode, state.cullMode, state.frontFace, state.depthBiasEnable, state.depthBiasConstantFactor, state.depthBiasClamp, state.depthBiasSlopeFactor, state.lineWidth, state.multisampleEnable, state.sample, state.depthTestEnable, state.depthWriteEnable, state.depthCompareOp, state.depthBoundsTestEnable, state.stencilTestEnable, state.frontFailOp, state.frontPassOp, state.frontDepthFailOp, state.frontCompareOp, state.frontCompareMask, state.frontWriteMask, state.frontReference, state.backFailOp, state.backPassOp, state.backDepthFailOp, state.backCompareOp, state.backCompareMask, state.backWriteMask, state.backReference, state.minDepthBounds, state.maxDepthBounds, state.logicOpEnable, state.logicOp, state.blendEnable, state.srcColorBlendFactor, state.dstColorBlendFactor, state.colorBlendOp, state.srcAlphaBlendFactor, state.dstAlphaBlendFactor, state.alphaBlendOp, state.constantR, state.constantG, state.constantB, state.constantA);
+}
+
+GraphicsPipelineCache::GraphicsPipelineCache(const Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> &pipelineCache)
+{
+    this->pipelineCache = pipelineCache;
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> GraphicsPipelineCache::Get(const Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> &renderPass, uint32_t subpass, const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> &vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> &fragmentShader, const GraphicsPipelineState &state)
+{
+    // The cached pipeline keeps its render pass alive, so the render pass address can not be reused by another one while the entry exists.
+    // Shaders are compared by their SPIR-V, two TShader compiled from the same source share a pipeline
+    std::string key = state.GetKey();
+    AppendKey(key, reinterpret_cast<uintptr_t>(renderPass.Get()));
+    AppendKey(key, subpass);
+    std::vector<uint32_t> vertex_spirv = vertexShader->GetSpirV();
+    std::vector<uint32_t> fragment_spirv = fragmentShader->GetSpirV();
+    AppendKey(key, Fnv1a(vertex_spirv.data(), vertex_spirv.size() * sizeof(uint32_t)));
+    AppendKey(key, Fnv1a(fragment_spirv.data(), fragment_spirv.size() * sizeof(uint32_t)));
+    uint64_t hash = Fnv1a(key.data(), key.size());
+
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        for (Entry &entry_item : this->entries[hash])
+        {
+            if (entry_item.key == key)
+            {
+                this->hitCount++;
+                return entry_item.pipeline;
+            }
+        }
+    }
+
+    // create without holding the lock, the pipeline compile is the slow part
+    Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> pipeline = CreateGraphicsPipeline(this->pipelineCache, renderPass, subpass, vertexShader, fragmentShader, state);
+
+    std::lock_guard<std::mutex> lock(this->mutex);
+    std::vector<Entry> &bucket = this->entries[hash];
+    for (Entry &entry_item : bucket)
+    {
+        if (entry_item.key == key)
+        {
+            // another thread created the same pipeline meanwhile, keep the first one
+            this->hitCount++;
+            return entry_item.pipeline;
+        }
+    }
+
+    this->missCount++;
+    Entry entry;
+    entry.key = key;
+    entry.pipeline = pipeline;
+    bucket.push_back(entry);
+    return pipeline;
+}
+
+void GraphicsPipelineCache::Clear()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->entries.clear();
+}
+
+size_t GraphicsPipelineCache::GetPipelineCount()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    size_t pipeline_count = 0;
+    for (const auto &bucket_item : this->entries)
+    {
+        pipeline_count += bucket_item.second.size();
+    }
+    return pipeline_count;
+}
+
+uint32_t GraphicsPipelineCache::GetHitCount()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->hitCount;
+}
+
+uint32_t GraphicsPipelineCache::GetMissCount()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->missCount;
+}
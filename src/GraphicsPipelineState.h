@@ -0,0 +1,110 @@
+#pragma once
+#ifndef POINTCLOUD_GRAPHICSPIPELINESTATE_H
+#define POINTCLOUD_GRAPHICSPIPELINESTATE_H
+#include "../core/include/TGraphicsPipeline.h"
+#include "../core/include/TPipelineCache.h"
+#include "../core/include/TRenderPass.h"
+#include "../core/include/TShader.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Value type for the fixed function state of Turbo::Core::TGraphicsPipeline, every member defaults to the constructor default.
+// Only set what differs from the defaults and keep it around instead of spelling the ~50 constructor arguments out.
+typedef struct GraphicsPipelineState
+{
+    std::vector<Turbo::Core::TVertexBinding> vertexBindings;
+    Turbo::Core::TTopologyType topology = Turbo::Core::TTopologyType::TRIANGLE_LIST;
+    bool primitiveRestartEnable = false;
+    bool depthClampEnable = false;
+    bool rasterizerDiscardEnable = false;
+    Turbo::Core::TPolygonMode polygonMode = Turbo::Core::TPolygonMode::FILL;
+    Turbo::Core::TCullModes cullMode = Turbo::Core::TCullModeBits::MODE_BACK_BIT;
+    Turbo::Core::TFrontFace frontFace = Turbo::Core::TFrontFace::CLOCKWISE;
+    bool depthBiasEnable = false;
+    float depthBiasConstantFactor = 0;
+    float depthBiasClamp = 0;
+    float depthBiasSlopeFactor = 0;
+    float lineWidth = 1;
+    bool multisampleEnable = false;
+    Turbo::Core::TSampleCountBits sample = Turbo::Core::TSampleCountBits::SAMPLE_1_BIT;
+    bool depthTestEnable = true;
+    bool depthWriteEnable = true;
+    Turbo::Core::TCompareOp depthCompareOp = Turbo::Core::TCompareOp::LESS_OR_EQUAL;
+    bool depthBoundsTestEnable = false;
+    bool stencilTestEnable = false;
+    Turbo::Core::TStencilOp frontFailOp = Turbo::Core::TStencilOp::KEEP;
+    Turbo::Core::TStencilOp frontPassOp = Turbo::Core::TStencilOp::KEEP;
+    Turbo::Core::TStencilOp frontDepthFailOp = Turbo::Core::TStencilOp::KEEP;
+    Turbo::Core::TCompareOp frontCompareOp = Turbo::Core::TCompareOp::ALWAYS;
+    uint32_t frontCompareMask = 0;
+    uint32_t frontWriteMask = 0;
+    uint32_t frontReference = 0;
+    Turbo::Core::TStencilOp backFailOp = Turbo::Core::TStencilOp::KEEP;
+    Turbo::Core::TStencilOp backPassOp = Turbo::Core::TStencilOp::KEEP;
+    Turbo::Core::TStencilOp backDepthFailOp = Turbo::Core::TStencilOp::KEEP;
+    Turbo::Core::TCompareOp backCompareOp = Turbo::Core::TCompareOp::ALWAYS;
+    uint32_t backCompareMask = 0;
+    uint32_t backWriteMask = 0;
+    uint32_t backReference = 0;
+    float minDepthBounds = 0;
+    float maxDepthBounds = 0;
+    bool logicOpEnable = false;
+    Turbo::Core::TLogicOp logicOp = Turbo::Core::TLogicOp::NO_OP;
+    bool blendEnable = false;
+    Turbo::Core::TBlendFactor srcColorBlendFactor = Turbo::Core::TBlendFactor::ZERO;
+    Turbo::Core::TBlendFactor dstColorBlendFactor = Turbo::Core::TBlendFactor::ZERO;
+    Turbo::Core::TBlendOp colorBlendOp = Turbo::Core::TBlendOp::ADD;
+    Turbo::Core::TBlendFactor srcAlphaBlendFactor = Turbo::Core::TBlendFactor::ZERO;
+    Turbo::Core::TBlendFactor dstAlphaBlendFactor = Turbo::Core::TBlendFactor::ZERO;
+    Turbo::Core::TBlendOp alphaBlendOp = Turbo::Core::TBlendOp::ADD;
+    float constantR = 1;
+    float constantG = 1;
+    float constantB = 1;
+    float constantA = 1;
+
+    // Every member serialized in declaration order, floats by their bits. Equal states give equal keys on every run
+    std::string GetKey() const;
+    uint64_t Hash() const; // FNV-1a of GetKey()
+
+    bool operator==(const GraphicsPipelineState &other) const;
+    bool operator!=(const GraphicsPipelineState &other) const;
+} GraphicsPipelineState;
+
+Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> CreateGraphicsPipeline(const Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> &pipelineCache, const Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> &renderPass, uint32_t subpass, const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> &vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> &fragmentShader, const GraphicsPipelineState &state);
+
+// Map render pass + subpass + shaders (by their SPIR-V) + GraphicsPipelineState to the TGraphicsPipeline created for it,
+// so asking for a state twice returns the first pipeline instead of compiling it again. Get() may be called from several threads.
+class GraphicsPipelineCache
+{
+  private:
+    typedef struct Entry
+    {
+        std::string key;
+        Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> pipeline;
+    } Entry;
+
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> pipelineCache;
+
+    std::mutex mutex;
+    std::unordered_map<uint64_t, std::vector<Entry>> entries; // hash of the key -> entries with that hash
+    uint32_t hitCount = 0;
+    uint32_t missCount = 0;
+
+  public:
+    explicit GraphicsPipelineCache(const Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> &pipelineCache);
+
+  public:
+    Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> Get(const Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> &renderPass, uint32_t subpass, const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> &vertexShader, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> &fragmentShader, const GraphicsPipelineState &state);
+    void Clear(); // e.g. when the render pass is recreated
+
+    size_t GetPipelineCount();
+    uint32_t GetHitCount();
+    uint32_t GetMissCount();
+};
+
+#endif // !POINTCLOUD_GRAPHICSPIPELINESTATE_H
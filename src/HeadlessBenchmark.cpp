@@ -0,0 +1,311 @@
+#include "HeadlessBenchmark.h"
+#include "CameraPath.h"
+#include "EmbeddedShaders.h"
+#include "GpuProfiler.h"
+#include "GraphicsPipelineState.h"
+#include "PipelineCacheFile.h"
+#include "PointCloudUpload.h"
+#include "ShaderCache.h"
+#include "WorkerPool.h"
+
+#include "../core/include/TAttachment.h"
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TCommandBufferPool.h"
+#include "../core/include/TDescriptorPool.h"
+#include "../core/include/TDevice.h"
+#include "../core/include/TDeviceQueue.h"
+#include "../core/include/TFence.h"
+#include "../core/include/TFramebuffer.h"
+#include "../core/include/TInstance.h"
+#include "../core/include/TPhysicalDevice.h"
+#include "../core/include/TRenderPass.h"
+#include "../core/include/TSubpass.h"
+
+#include <glm/ext.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+const std::string BENCHMARK_PIPELINE_CACHE_PATH = "./pipeline_cache_headless.bin";
+
+double GetElapsedMilliseconds(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+void WriteJsonString(std::ofstream &outStream, const std::string &value)
+{
+    outStream << '"';
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            outStream << '\\';
+        }
+        outStream << c;
+    }
+    outStream << '"';
+}
+
+void WriteFrameTimeStatistics(std::ofstream &outStream, const FrameTimeStatistics &statistics)
+{
+    outStream << "{\"frames\": " << statistics.frameCount << ", \"mean\": " << statistics.mean << ", \"min\": " << statistics.min << ", \"max\": " << statistics.max << ", \"p50\": " << statistics.p50 << ", \"p95\": " << statistics.p95 << ", \"p99\": " << statistics.p99 << "}";
+}
+} // namespace
+
+Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> FindPhysicalDevice(const Turbo::Core::TRefPtr<Turbo::Core::TInstance> &instance, const std::string &deviceName)
+{
+    if (deviceName.empty())
+    {
+        return instance->GetBestPhysicalDevice();
+    }
+
+    for (const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physical_device_item : instance->GetPhysicalDevices())
+    {
+        if (physical_device_item->GetDeviceName().find(deviceName) != std::string::npos)
+        {
+            return physical_device_item;
+        }
+    }
+
+    return nullptr;
+}
+
+FrameTimeStatistics GetFrameTimeStatistics(std::vector<double> frameTimes)
+{
+    FrameTimeStatistics statistics;
+    if (frameTimes.empty())
+    {
+        return statistics;
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    auto percentile = [&](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * frameTimes.size()));
+        return frameTimes[std::min(frameTimes.size() - 1, rank > 0 ? rank - 1 : 0)];
+    };
+
+    double sum = 0;
+    for (double frame_time : frameTimes)
+    {
+        sum += frame_time;
+    }
+
+    statistics.frameCount = static_cast<uint32_t>(frameTimes.size());
+    statistics.mean = sum / frameTimes.size();
+    statistics.min = frameTimes.front();
+    statistics.max = frameTimes.back();
+    statistics.p50 = percentile(50);
+    statistics.p95 = percentile(95);
+    statistics.p99 = percentile(99);
+    return statistics;
+}
+
+int RunHeadlessBenchmark(const HeadlessBenchmarkOptions &options, const std::vector<Point> &points)
+{
+    std::vector<CameraPathFrame> camera_path;
+    if (!LoadCameraPath(options.cameraPathFile, camera_path) || camera_path.empty())
+    {
+        std::cerr << "Failed to load camera path " << options.cameraPathFile << std::endl;
+        return 1;
+    }
+
+    // no layers and no surface extensions, validation would only distort the timings
+    Turbo::Core::TVersion instance_version(1, 2, 0, 0);
+    Turbo::Core::TRefPtr<Turbo::Core::TInstance> instance = new Turbo::Core::TInstance(nullptr, nullptr, &instance_version);
+    Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> physical_device = FindPhysicalDevice(instance, options.deviceName);
+    if (physical_device.Get() == nullptr)
+    {
+        std::cerr << "No physical device matches " << options.deviceName << std::endl;
+        return 1;
+    }
+    std::cout << "Headless benchmark on " << physical_device->GetDeviceName() << std::endl;
+
+    Turbo::Core::TPhysicalDeviceFeatures physical_device_features = {};
+    physical_device_features.sampleRateShading = true;
+    physical_device_features.fillModeNonSolid = true;
+
+    Turbo::Core::TRefPtr<Turbo::Core::TDevice> device = new Turbo::Core::TDevice(physical_device, nullptr, nullptr, &physical_device_features);
+    Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> queue = device->GetBestGraphicsQueue();
+    Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> command_pool = new Turbo::Core::TCommandBufferPool(queue);
+    DevicePools device_pools(queue);
+
+    WorkerPool worker_pool;
+
+    std::chrono::steady_clock::time_point upload_start_time = std::chrono::steady_clock::now();
+    PointsStorageType points_storage_type = IsSupportDirectWriteUpload(physical_device, points.size() * (sizeof(POSITION) + sizeof(COLOR))) ? PointsStorageType::BUFFER : PointsStorageType::IMAGE;
+    std::vector<PointsChunkData> all_points_chunk_data = points_storage_type == PointsStorageType::BUFFER ? CreateAllPointsBufferData(points, device, worker_pool) : CreateAllPointsImageData(points, device, device_pools);
+    double upload_time = GetElapsedMilliseconds(upload_start_time);
+
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> color_image = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R8G8B8A8_UNORM, options.width, options.height, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_COLOR_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> color_image_view = new Turbo::Core::TImageView(color_image, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, color_image->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> depth_image = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::D32_SFLOAT, options.width, options.height, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_DEPTH_STENCIL_ATTACHMENT, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> depth_image_view = new Turbo::Core::TImageView(depth_image, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, depth_image->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_DEPTH_BIT, 0, 1, 0, 1);
+
+    // same attachments as the points subpass of the interactive render pass, without the ImGui subpass
+    Turbo::Core::TSubpass subpass(Turbo::Core::TPipelineType::Graphics);
+    subpass.AddColorAttachmentReference(0, Turbo::Core::TImageLayout::COLOR_ATTACHMENT_OPTIMAL);
+    subpass.SetDepthStencilAttachmentReference(1, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    std::vector<Turbo::Core::TSubpass> subpasses = {subpass};
+
+    Turbo::Core::TAttachment color_attachment(color_image->GetFormat(), color_image->GetSampleCountBits(), Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_SRC_OPTIMAL);
+    Turbo::Core::TAttachment depth_attachment(depth_image->GetFormat(), depth_image->GetSampleCountBits(), Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    std::vector<Turbo::Core::TAttachment> attachments = {color_attachment, depth_attachment};
+
+    Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> render_pass = new Turbo::Core::TRenderPass(device, attachments, subpasses);
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> framebuffer_image_views = {color_image_view, depth_image_view};
+    Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> framebuffer = new Turbo::Core::TFramebuffer(render_pass, framebuffer_image_views);
+
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> pipeline_cache = LoadPipelineCache(device, BENCHMARK_PIPELINE_CACHE_PATH);
+    ShaderCache shader_cache;
+    EmbedShaders(shader_cache);
+
+    bool is_buffer_storage = points_storage_type == PointsStorageType::BUFFER;
+    Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> vertex_shader = shader_cache.CreateVertexShader(device, is_buffer_storage ? "PointCloudBuffer.vert" : "PointCloud.vert", is_buffer_storage ? options.pointsBufferVertexShaderCode : options.pointsVertexShaderCode);
+    Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> fragment_shader = shader_cache.CreateFragmentShader(device, "PointCloud.frag", options.pointsFragmentShaderCode);
+
+    GraphicsPipelineState points_pipeline_state;
+    points_pipeline_state.topology = Turbo::Core::TTopologyType::POINT_LIST;
+    points_pipeline_state.polygonMode = Turbo::Core::TPolygonMode::POINT;
+    points_pipeline_state.blendEnable = true;
+    points_pipeline_state.srcColorBlendFactor = Turbo::Core::TBlendFactor::SRC_ALPHA;
+    points_pipeline_state.dstColorBlendFactor = Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA;
+    points_pipeline_state.srcAlphaBlendFactor = Turbo::Core::TBlendFactor::ONE_MINUS_SRC_ALPHA;
+    points_pipeline_state.dstAlphaBlendFactor = Turbo::Core::TBlendFactor::ZERO;
+    Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> graphics_pipeline = CreateGraphicsPipeline(pipeline_cache, render_pass, 0, vertex_shader, fragment_shader, points_pipeline_state);
+
+    MATRIXS_BUFFER_DATA matrixs_buffer_data = {};
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> matrixs_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_UNIFORM_BUFFER, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, sizeof(matrixs_buffer_data));
+
+    // one set per chunk, each with a uniform buffer and two storage buffers or images
+    uint32_t descriptor_count = std::max<uint32_t>(1000, static_cast<uint32_t>(all_points_chunk_data.size()) * 2);
+    std::vector<Turbo::Core::TDescriptorSize> descriptor_sizes = {{Turbo::Core::TDescriptorType::UNIFORM_BUFFER, descriptor_count}, {Turbo::Core::TDescriptorType::STORAGE_BUFFER, descriptor_count}, {Turbo::Core::TDescriptorType::STORAGE_IMAGE, descriptor_count}, {Turbo::Core::TDescriptorType::SAMPLED_IMAGE, descriptor_count}};
+    Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> descriptor_pool = new Turbo::Core::TDescriptorPool(device, descriptor_count, descriptor_sizes);
+
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> pipeline_descriptor_sets;
+    uint64_t points_per_frame = 0;
+    for (const PointsChunkData &points_chunk_data_item : all_points_chunk_data)
+    {
+        pipeline_descriptor_sets.push_back(CreatePointsDescriptorSet(descriptor_pool, graphics_pipeline->GetPipelineLayout(), matrixs_buffer, points_chunk_data_item, points_storage_type));
+        points_per_frame += points_chunk_data_item.count;
+    }
+
+    Turbo::Core::TViewport viewport(0, 0, options.width, options.height, 0, 1);
+    Turbo::Core::TScissor scissor(0, 0, options.width, options.height);
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), static_cast<float>(options.width) / options.height, 0.1f, 300.0f);
+
+    Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> command_buffer = command_pool->Allocate();
+    GpuProfiler gpu_profiler(queue);
+    uint32_t gpu_resolved_frame_count = 0;
+
+    std::vector<double> cpu_frame_times;
+    std::vector<double> gpu_frame_times;
+    uint64_t points_drawn = 0;
+
+    // The profiler resolves a frame GpuProfiler::FRAME_COUNT frames later (or in ResolveNext()), the frame index it was tagged
+    // with tells a warmup frame from a measured one. The profiler counts its EndFrame()s, one per frame here too
+    auto collect_gpu_frame_time = [&]() {
+        if (gpu_profiler.GetResolvedFrameCount() == gpu_resolved_frame_count || gpu_profiler.GetZones().empty())
+        {
+            return;
+        }
+        gpu_resolved_frame_count = gpu_profiler.GetResolvedFrameCount();
+        if (gpu_profiler.GetLastResolvedFrameIndex() >= options.warmupFrameCount)
+        {
+            gpu_frame_times.push_back(gpu_profiler.GetZones().front().time);
+        }
+    };
+
+    uint32_t measured_frame_count = static_cast<uint32_t>(camera_path.size()) * std::max(1u, options.loopCount);
+    for (uint32_t frame_index = 0; frame_index < options.warmupFrameCount + measured_frame_count; frame_index++)
+    {
+        bool is_warmup = frame_index < options.warmupFrameCount;
+        const CameraPathFrame &camera_frame = is_warmup ? camera_path.front() : camera_path[(frame_index - options.warmupFrameCount) % camera_path.size()];
+
+        std::chrono::steady_clock::time_point frame_start_time = std::chrono::steady_clock::now();
+
+        matrixs_buffer_data.m = glm::mat4(1.0f);
+        matrixs_buffer_data.v = GetCameraView(camera_frame);
+        matrixs_buffer_data.p = projection;
+        void *matrixs_ptr = matrixs_buffer->Map();
+        memcpy(matrixs_ptr, &matrixs_buffer_data, sizeof(matrixs_buffer_data));
+        matrixs_buffer->Unmap();
+
+        command_buffer->Begin();
+        gpu_profiler.BeginFrame(command_buffer);
+        uint32_t gpu_frame_zone = gpu_profiler.BeginZone(command_buffer, "Frame");
+        command_buffer->CmdBeginRenderPass(render_pass, framebuffer);
+        command_buffer->CmdBindPipeline(graphics_pipeline);
+        command_buffer->CmdSetViewport({viewport});
+        command_buffer->CmdSetScissor({scissor});
+        for (size_t points_chunk_index = 0; points_chunk_index < all_points_chunk_data.size(); points_chunk_index++)
+        {
+            command_buffer->CmdBindPipelineDescriptorSet(pipeline_descriptor_sets[points_chunk_index]);
+            command_buffer->CmdDraw(1, all_points_chunk_data[points_chunk_index].count, 0, 0);
+        }
+        command_buffer->CmdEndRenderPass();
+        gpu_profiler.EndZone(command_buffer, gpu_frame_zone);
+        command_buffer->End();
+
+        DevicePools::Fence fence = device_pools.AcquireFence();
+        queue->Submit(command_buffer, fence->Get());
+        gpu_profiler.EndFrame();
+        fence->Get()->WaitUntil();
+        command_buffer->Reset();
+        collect_gpu_frame_time(); // BeginFrame() resolved the frame submitted FRAME_COUNT frames ago
+
+        if (is_warmup)
+        {
+            continue;
+        }
+
+        cpu_frame_times.push_back(GetElapsedMilliseconds(frame_start_time));
+        points_drawn += points_per_frame;
+    }
+
+    device->WaitIdle();
+    // the last FRAME_COUNT frames are still pending, every fence was waited on so none of them is dropped for not being ready
+    while (gpu_profiler.ResolveNext())
+    {
+        collect_gpu_frame_time();
+    }
+    for (Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> &pipeline_descriptor_set_item : pipeline_descriptor_sets)
+    {
+        descriptor_pool->Free(pipeline_descriptor_set_item);
+    }
+    command_pool->Free(command_buffer);
+    SavePipelineCache(pipeline_cache, BENCHMARK_PIPELINE_CACHE_PATH);
+
+    FrameTimeStatistics cpu_statistics = GetFrameTimeStatistics(cpu_frame_times);
+    FrameTimeStatistics gpu_statistics = GetFrameTimeStatistics(gpu_frame_times);
+
+    std::ofstream out_stream(options.outputFile, std::ios::trunc);
+    if (!out_stream.is_open())
+    {
+        std::cerr << "Failed to write " << options.outputFile << std::endl;
+        return 1;
+    }
+
+    out_stream << "{\n  \"device\": ";
+    WriteJsonString(out_stream, physical_device->GetDeviceName());
+    out_stream << ",\n  \"camera_path\": ";
+    WriteJsonString(out_stream, options.cameraPathFile);
+    out_stream << ",\n  \"width\": " << options.width << ",\n  \"height\": " << options.height;
+    out_stream << ",\n  \"storage\": \"" << (is_buffer_storage ? "buffer" : "image") << "\"";
+    out_stream << ",\n  \"upload_ms\": " << upload_time;
+    out_stream << ",\n  \"points\": " << points.size() << ",\n  \"points_drawn\": " << points_drawn << ",\n  \"points_drawn_per_frame\": " << points_per_frame;
+    out_stream << ",\n  \"frame_ms\": ";
+    WriteFrameTimeStatistics(out_stream, cpu_statistics);
+    out_stream << ",\n  \"gpu_frame_ms\": ";
+    WriteFrameTimeStatistics(out_stream, gpu_statistics);
+    out_stream << "\n}\n";
+
+    std::cout << "Benchmark::frames::" << cpu_statistics.frameCount << "::mean::" << cpu_statistics.mean << "ms::p50::" << cpu_statistics.p50 << "ms::p95::" << cpu_statistics.p95 << "ms::p99::" << cpu_statistics.p99 << "ms" << std::endl;
+    return out_stream.good() ? 0 : 1;
+}
@@ -0,0 +1,50 @@
+#pragma once
+#ifndef POINTCLOUD_HEADLESSBENCHMARK_H
+#define POINTCLOUD_HEADLESSBENCHMARK_H
+#include "PointCloudData.h"
+
+#include "../core/include/TInstance.h"
+#include "../core/include/TPhysicalDevice.h"
+
+#include <string>
+#include <vector>
+
+typedef struct HeadlessBenchmarkOptions
+{
+    std::string cameraPathFile;                  // see CameraPath.h
+    std::string outputFile = "./benchmark.json"; // frame statistics
+    std::string deviceName;                      // pick the first physical device whose name contains it (e.g. "llvmpipe"), the best one if empty
+    uint32_t width = 1920;
+    uint32_t height = 1080;
+    uint32_t warmupFrameCount = 16; // rendered with the first path frame, not measured
+    uint32_t loopCount = 1;         // how many times the whole path is played
+
+    std::string pointsVertexShaderCode;       // PointCloud.vert
+    std::string pointsBufferVertexShaderCode; // PointCloudBuffer.vert
+    std::string pointsFragmentShaderCode;     // PointCloud.frag
+} HeadlessBenchmarkOptions;
+
+typedef struct FrameTimeStatistics
+{
+    uint32_t frameCount = 0;
+    double mean = 0; // millisecond
+    double min = 0;
+    double max = 0;
+    double p50 = 0;
+    double p95 = 0;
+    double p99 = 0;
+} FrameTimeStatistics;
+
+// The first physical device whose name contains deviceName, GetBestPhysicalDevice() if deviceName is empty, nullptr if none matches
+Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> FindPhysicalDevice(const Turbo::Core::TRefPtr<Turbo::Core::TInstance> &instance, const std::string &deviceName);
+
+// Nearest rank percentiles of frame times in millisecond
+FrameTimeStatistics GetFrameTimeStatistics(std::vector<double> frameTimes);
+
+// Render the points into an offscreen color/depth image along the camera path, without GLFW, surface or swapchain,
+// and write the frame time statistics as JSON to options.outputFile. Works on software ICDs such as lavapipe
+// (VK_ICD_FILENAMES=.../lvp_icd.x86_64.json). Return the process exit code.
+// NOTE: a frame is timed from the uniform update to its fence, so it is CPU record + submit + GPU execution, nothing is presented
+int RunHeadlessBenchmark(const HeadlessBenchmarkOptions &options, const std::vector<Point> &points);
+
+#endif // !POINTCLOUD_HEADLESSBENCHMARK_H
@@ -0,0 +1,262 @@
+#include "HiZCulling.h"
+
+#include "../core/include/TBarrier.h"
+#include "../core/include/TVulkanLoader.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+// std430 ChunkBounds of HiZCull.comp
+typedef struct ChunkBounds
+{
+    float min[3];
+    uint32_t count;
+    float max[3];
+    uint32_t padding;
+} ChunkBounds;
+
+// push_constant CULL_CONSTANTS of HiZCull.comp
+typedef struct CullConstants
+{
+    glm::mat4 viewProjection;
+    uint32_t chunkCount;
+    uint32_t depthWidth;
+    uint32_t depthHeight;
+    uint32_t isOcclusion;
+} CullConstants;
+
+const uint32_t PYRAMID_GROUP_SIZE = 8; // local_size_x/y of HiZPyramid.comp
+const uint32_t CULL_GROUP_SIZE = 64;   // local_size_x of HiZCull.comp
+} // namespace
+
+HiZCulling::HiZCulling(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pyramidFromDepthPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pyramidPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &cullPipeline, const std::vector<PointsChunkData> &pointsChunkDatas)
+    : descriptorPool(descriptorPool), pyramidFromDepthPipeline(pyramidFromDepthPipeline), pyramidPipeline(pyramidPipeline), cullPipeline(cullPipeline)
+{
+    const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device = cullPipeline->GetDevice();
+    this->sampler = new Turbo::Core::TSampler(device, Turbo::Core::TFilter::NEAREST, Turbo::Core::TFilter::NEAREST, Turbo::Core::TMipmapMode::NEAREST, Turbo::Core::TAddressMode::CLAMP_TO_EDGE, Turbo::Core::TAddressMode::CLAMP_TO_EDGE, Turbo::Core::TAddressMode::CLAMP_TO_EDGE);
+
+    this->chunkCount = static_cast<uint32_t>(pointsChunkDatas.size());
+    size_t buffer_item_count = std::max<size_t>(1, pointsChunkDatas.size()); // no zero sized buffers
+
+    this->chunkBoundsBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, buffer_item_count * sizeof(ChunkBounds));
+    ChunkBounds *chunk_bounds_ptr = static_cast<ChunkBounds *>(this->chunkBoundsBuffer->Map());
+    for (size_t chunk_index = 0; chunk_index < pointsChunkDatas.size(); chunk_index++)
+    {
+        const PointsBounds &bounds = pointsChunkDatas[chunk_index].bounds;
+        chunk_bounds_ptr[chunk_index] = {{bounds.min.x, bounds.min.y, bounds.min.z}, pointsChunkDatas[chunk_index].count, {bounds.max.x, bounds.max.y, bounds.max.z}, 0};
+    }
+    this->chunkBoundsBuffer->Unmap();
+
+    this->drawCommandsBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_INDIRECT_BUFFER, 0, buffer_item_count * sizeof(VkDrawIndirectCommand));
+
+    // every chunk starts frustum culled: the first frame draws nothing in phase 1 and everything in view in phase 2
+    this->visibilityBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_RANDOM, buffer_item_count * sizeof(uint32_t));
+    void *visibility_ptr = this->visibilityBuffer->Map();
+    memset(visibility_ptr, 0, buffer_item_count * sizeof(uint32_t));
+    this->visibilityBuffer->Unmap();
+
+    this->isPhaseOneChunks.resize(this->chunkCount, false);
+}
+
+HiZCulling::~HiZCulling()
+{
+    this->FreeDescriptorSets();
+}
+
+void HiZCulling::FreeDescriptorSets()
+{
+    for (Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> &pyramid_descriptor_set_item : this->pyramidDescriptorSets)
+    {
+        this->descriptorPool->Free(pyramid_descriptor_set_item);
+    }
+    this->pyramidDescriptorSets.clear();
+
+    if (this->cullDescriptorSet.Get() != nullptr)
+    {
+        this->descriptorPool->Free(this->cullDescriptorSet);
+        this->cullDescriptorSet = nullptr;
+    }
+}
+
+void HiZCulling::SetDepthImage(const Turbo::Core::TRefPtr<Turbo::Core::TImageView> &depthImageView, uint32_t width, uint32_t height)
+{
+    this->FreeDescriptorSets();
+    this->pyramidLevelImageViews.clear();
+
+    const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device = this->cullPipeline->GetDevice();
+    this->depthWidth = std::max(1u, width);
+    this->depthHeight = std::max(1u, height);
+
+    uint32_t pyramid_width = (this->depthWidth + 1) / 2;
+    uint32_t pyramid_height = (this->depthHeight + 1) / 2;
+    uint32_t level_count = 1;
+    while ((std::max(pyramid_width, pyramid_height) >> level_count) > 0)
+    {
+        level_count++;
+    }
+
+    this->pyramidImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R32_SFLOAT, pyramid_width, pyramid_height, 1, level_count, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_STORAGE | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    this->pyramidImageView = new Turbo::Core::TImageView(this->pyramidImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->pyramidImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, level_count, 0, 1);
+
+    for (uint32_t level = 0; level < level_count; level++)
+    {
+        this->pyramidLevelImageViews.push_back(new Turbo::Core::TImageView(this->pyramidImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->pyramidImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, level, 1, 0, 1));
+
+        const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pipeline = level == 0 ? this->pyramidFromDepthPipeline : this->pyramidPipeline;
+        Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> pyramid_descriptor_set = this->descriptorPool->Allocate(pipeline->GetPipelineLayout());
+        if (level == 0)
+        {
+            std::vector<std::pair<Turbo::Core::TRefPtr<Turbo::Core::TImageView>, Turbo::Core::TRefPtr<Turbo::Core::TSampler>>> depth_combined_image_samplers = {std::make_pair(depthImageView, this->sampler)};
+            pyramid_descriptor_set->BindData(0, 0, 0, depth_combined_image_samplers);
+        }
+        else
+        {
+            std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> source_image_views = {this->pyramidLevelImageViews[level - 1]};
+            pyramid_descriptor_set->BindData(0, 0, 0, source_image_views);
+        }
+        std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> destination_image_views = {this->pyramidLevelImageViews[level]};
+        pyramid_descriptor_set->BindData(0, 1, 0, destination_image_views);
+        this->pyramidDescriptorSets.push_back(pyramid_descriptor_set);
+    }
+
+    this->cullDescriptorSet = this->descriptorPool->Allocate(this->cullPipeline->GetPipelineLayout());
+    this->cullDescriptorSet->BindData(0, 0, this->chunkBoundsBuffer);
+    this->cullDescriptorSet->BindData(0, 1, this->drawCommandsBuffer);
+    this->cullDescriptorSet->BindData(0, 2, this->visibilityBuffer);
+    std::vector<std::pair<Turbo::Core::TRefPtr<Turbo::Core::TImageView>, Turbo::Core::TRefPtr<Turbo::Core::TSampler>>> pyramid_combined_image_samplers = {std::make_pair(this->pyramidImageView, this->sampler)};
+    this->cullDescriptorSet->BindData(0, 3, 0, pyramid_combined_image_samplers);
+}
+
+void HiZCulling::CmdBuildPyramidAndCull(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TImage> &depthImage, const glm::mat4 &viewProjection, bool isOcclusion)
+{
+    uint32_t level_count = this->GetPyramidLevelCount();
+
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::LATE_FRAGMENT_TESTS_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TAccessBits::DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL, Turbo::Core::TImageLayout::SHADER_READ_ONLY_OPTIMAL, depthImage, Turbo::Core::TImageAspectBits::ASPECT_DEPTH_BIT, 0, 1, 0, 1);
+    // the content of last frame is never read again
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, 0, Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::GENERAL, this->pyramidImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, level_count, 0, 1);
+
+    for (uint32_t level = 0; level < level_count; level++)
+    {
+        uint32_t level_width = std::max(1u, this->pyramidImage->GetWidth() >> level);
+        uint32_t level_height = std::max(1u, this->pyramidImage->GetHeight() >> level);
+
+        commandBuffer->CmdBindPipeline(level == 0 ? this->pyramidFromDepthPipeline : this->pyramidPipeline);
+        commandBuffer->CmdBindPipelineDescriptorSet(this->pyramidDescriptorSets[level]);
+        commandBuffer->CmdDispatch((level_width + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, (level_height + PYRAMID_GROUP_SIZE - 1) / PYRAMID_GROUP_SIZE, 1);
+
+        Turbo::Core::TMemoryBarrier level_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT);
+        commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, level_barrier);
+    }
+
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TImageLayout::GENERAL, Turbo::Core::TImageLayout::SHADER_READ_ONLY_OPTIMAL, this->pyramidImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, level_count, 0, 1);
+
+    CullConstants cull_constants;
+    cull_constants.viewProjection = viewProjection;
+    cull_constants.chunkCount = this->chunkCount;
+    cull_constants.depthWidth = this->depthWidth;
+    cull_constants.depthHeight = this->depthHeight;
+    cull_constants.isOcclusion = isOcclusion ? 1 : 0;
+
+    commandBuffer->CmdBindPipeline(this->cullPipeline);
+    commandBuffer->CmdBindPipelineDescriptorSet(this->cullDescriptorSet);
+    commandBuffer->CmdPushConstants(0, sizeof(cull_constants), &cull_constants);
+    commandBuffer->CmdDispatch((this->chunkCount + CULL_GROUP_SIZE - 1) / CULL_GROUP_SIZE, 1, 1);
+
+    // the draw commands feed phase 2, the visibility is read by Update() after the fence
+    Turbo::Core::TMemoryBarrier cull_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::INDIRECT_COMMAND_READ_BIT | Turbo::Core::TAccessBits::HOST_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::DRAW_INDIRECT_BIT | Turbo::Core::TPipelineStageBits::HOST_BIT, cull_barrier);
+
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::EARLY_FRAGMENT_TESTS_BIT | Turbo::Core::TPipelineStageBits::LATE_FRAGMENT_TESTS_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TAccessBits::DEPTH_STENCIL_ATTACHMENT_READ_BIT | Turbo::Core::TAccessBits::DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, Turbo::Core::TImageLayout::SHADER_READ_ONLY_OPTIMAL, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL, depthImage, Turbo::Core::TImageAspectBits::ASPECT_DEPTH_BIT, 0, 1, 0, 1);
+}
+
+void HiZCulling::CmdDrawPhaseTwo(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> &descriptorSets)
+{
+    const Turbo::Core::TDeviceDriver *device_driver = this->cullPipeline->GetDevice()->GetDeviceDriver();
+    VkCommandBuffer vk_command_buffer = commandBuffer->GetVkCommandBuffer();
+    VkBuffer vk_draw_commands_buffer = this->drawCommandsBuffer->GetVkBuffer();
+
+    // Turbo::Core::TCommandBuffer::CmdDrawIndirect() takes no arguments yet
+    for (uint32_t chunk_index = 0; chunk_index < this->chunkCount; chunk_index++)
+    {
+        if (this->isPhaseOneChunks[chunk_index])
+        {
+            continue;
+        }
+
+        commandBuffer->CmdBindPipelineDescriptorSet(descriptorSets[chunk_index]);
+        device_driver->vkCmdDrawIndirect(vk_command_buffer, vk_draw_commands_buffer, chunk_index * sizeof(VkDrawIndirectCommand), 1, sizeof(VkDrawIndirectCommand));
+    }
+}
+
+void HiZCulling::Update()
+{
+    // HOST_ACCESS_RANDOM memory is host cached and coherent on desktop and software devices
+    const uint32_t *visibility_ptr = static_cast<const uint32_t *>(this->visibilityBuffer->Map());
+
+    this->visibleCount = 0;
+    this->frustumCulledCount = 0;
+    this->occlusionCulledCount = 0;
+    this->newlyVisibleCount = 0;
+    this->phaseOneChunks.clear();
+    for (uint32_t chunk_index = 0; chunk_index < this->chunkCount; chunk_index++)
+    {
+        switch (visibility_ptr[chunk_index])
+        {
+        case CHUNK_VISIBLE:
+            this->visibleCount++;
+            this->newlyVisibleCount += this->isPhaseOneChunks[chunk_index] ? 0 : 1;
+            this->phaseOneChunks.push_back(chunk_index);
+            break;
+        case CHUNK_OCCLUSION_CULLED:
+            this->occlusionCulledCount++;
+            break;
+        default:
+            this->frustumCulledCount++;
+            break;
+        }
+    }
+    this->visibilityBuffer->Unmap();
+
+    std::fill(this->isPhaseOneChunks.begin(), this->isPhaseOneChunks.end(), false);
+    for (uint32_t chunk_index : this->phaseOneChunks)
+    {
+        this->isPhaseOneChunks[chunk_index] = true;
+    }
+}
+
+const std::vector<uint32_t> &HiZCulling::GetPhaseOneChunks() const
+{
+    return this->phaseOneChunks;
+}
+
+uint32_t HiZCulling::GetChunkCount() const
+{
+    return this->chunkCount;
+}
+
+uint32_t HiZCulling::GetVisibleCount() const
+{
+    return this->visibleCount;
+}
+
+uint32_t HiZCulling::GetFrustumCulledCount() const
+{
+    return this->frustumCulledCount;
+}
+
+uint32_t HiZCulling::GetOcclusionCulledCount() const
+{
+    return this->occlusionCulledCount;
+}
+
+uint32_t HiZCulling::GetNewlyVisibleCount() const
+{
+    return this->newlyVisibleCount;
+}
+
+uint32_t HiZCulling::GetPyramidLevelCount() const
+{
+    return static_cast<uint32_t>(this->pyramidLevelImageViews.size());
+}
@@ -0,0 +1,91 @@
+#pragma once
+#ifndef POINTCLOUD_HIZCULLING_H
+#define POINTCLOUD_HIZCULLING_H
+#include "PointCloudData.h"
+
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TComputePipeline.h"
+#include "../core/include/TDescriptorPool.h"
+#include "../core/include/TPipelineDescriptorSet.h"
+#include "../core/include/TSampler.h"
+
+#include <cstdint>
+#include <vector>
+
+// Two phase occlusion culling of the points chunks against a hierarchical Z (depth pyramid):
+//   phase 1  the caller draws GetPhaseOneChunks(), the chunks found visible last frame
+//   CmdBuildPyramidAndCull()  a compute pass builds the max depth pyramid of that depth and tests every chunk AABB against it (HiZCull.comp)
+//   phase 2  CmdDrawPhaseTwo() draws every other chunk indirectly, the shader set instanceCount = 0 unless it became visible
+// Update() reads the visibility back once the frame fence signaled and makes it the phase 1 list of the next frame.
+// NOTE: single frame in flight, the visibility buffer is read by the CPU and rewritten by the GPU every frame
+class HiZCulling
+{
+  public:
+    typedef enum ChunkVisibility
+    {
+        CHUNK_FRUSTUM_CULLED = 0,
+        CHUNK_VISIBLE = 1,
+        CHUNK_OCCLUSION_CULLED = 2,
+    } ChunkVisibility;
+
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> descriptorPool;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> pyramidFromDepthPipeline; // HiZPyramid.comp with HIZ_FROM_DEPTH
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> pyramidPipeline;          // HiZPyramid.comp
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> cullPipeline;             // HiZCull.comp
+    Turbo::Core::TRefPtr<Turbo::Core::TSampler> sampler;
+
+    uint32_t chunkCount = 0;
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> chunkBoundsBuffer;
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> drawCommandsBuffer; // VkDrawIndirectCommand per chunk
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> visibilityBuffer;   // ChunkVisibility per chunk
+
+    uint32_t depthWidth = 0;
+    uint32_t depthHeight = 0;
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> pyramidImage; // R32_SFLOAT, level 0 is half of the depth attachment
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> pyramidImageView;
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> pyramidLevelImageViews;
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> pyramidDescriptorSets; // level i reads level i - 1 (or the depth) and writes level i
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> cullDescriptorSet;
+
+    std::vector<uint32_t> phaseOneChunks;
+    std::vector<bool> isPhaseOneChunks;
+    uint32_t visibleCount = 0;
+    uint32_t frustumCulledCount = 0;
+    uint32_t occlusionCulledCount = 0;
+    uint32_t newlyVisibleCount = 0;
+
+  private:
+    void FreeDescriptorSets();
+
+  public:
+    HiZCulling(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pyramidFromDepthPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pyramidPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &cullPipeline, const std::vector<PointsChunkData> &pointsChunkDatas);
+    ~HiZCulling();
+
+    HiZCulling(const HiZCulling &) = delete;
+    HiZCulling &operator=(const HiZCulling &) = delete;
+
+  public:
+    // After every (re)creation of the depth attachment, it needs IMAGE_SAMPLED usage
+    void SetDepthImage(const Turbo::Core::TRefPtr<Turbo::Core::TImageView> &depthImageView, uint32_t width, uint32_t height);
+
+    // Outside a render pass, right after phase 1. Expects the depth image in DEPTH_STENCIL_ATTACHMENT_OPTIMAL and leaves it there.
+    void CmdBuildPyramidAndCull(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TImage> &depthImage, const glm::mat4 &viewProjection, bool isOcclusion);
+
+    // Inside the phase 2 render pass with the points pipeline bound, descriptorSets are the points descriptor sets of the chunks
+    void CmdDrawPhaseTwo(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> &descriptorSets);
+
+    // After the fence of the frame which called CmdBuildPyramidAndCull()
+    void Update();
+
+    const std::vector<uint32_t> &GetPhaseOneChunks() const;
+    uint32_t GetChunkCount() const;
+    // counts of the last Update()
+    uint32_t GetVisibleCount() const; // passed both tests, drawn in phase 1 of the next frame
+    uint32_t GetFrustumCulledCount() const;
+    uint32_t GetOcclusionCulledCount() const;
+    uint32_t GetNewlyVisibleCount() const; // drawn in phase 2
+    uint32_t GetPyramidLevelCount() const;
+};
+
+#endif // !POINTCLOUD_HIZCULLING_H
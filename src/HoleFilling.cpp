@@ -0,0 +1,232 @@
+#include "HoleFilling.h"
+
+#include "../core/include/TAttachment.h"
+#include "../core/include/TBarrier.h"
+
+#include <algorithm>
+
+constexpr uint32_t HoleFilling::MAX_LEVEL_COUNT;
+
+namespace
+{
+// push_constant PULL_PUSH_CONSTANTS of PullPush.comp
+typedef struct PullPushConstants
+{
+    float depthParams[2];
+    float depthThreshold;
+    float minCoverage;
+    uint32_t isResolve;
+} PullPushConstants;
+
+const uint32_t PULL_PUSH_GROUP_SIZE = 8; // local_size_x/y of PullPush.comp
+} // namespace
+
+HoleFilling::HoleFilling(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pullFromTargetPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pullPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pushPipeline, Turbo::Core::TFormatInfo colorFormat, Turbo::Core::TFormatInfo depthFormat, std::vector<Turbo::Core::TSubpass> &subpasses)
+    : descriptorPool(descriptorPool), pullFromTargetPipeline(pullFromTargetPipeline), pullPipeline(pullPipeline), pushPipeline(pushPipeline), colorFormat(colorFormat), depthFormat(depthFormat)
+{
+    const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device = pushPipeline->GetDevice();
+    this->sampler = new Turbo::Core::TSampler(device, Turbo::Core::TFilter::NEAREST, Turbo::Core::TFilter::NEAREST, Turbo::Core::TMipmapMode::NEAREST, Turbo::Core::TAddressMode::CLAMP_TO_EDGE, Turbo::Core::TAddressMode::CLAMP_TO_EDGE, Turbo::Core::TAddressMode::CLAMP_TO_EDGE);
+
+    Turbo::Core::TAttachment color_attachment(colorFormat, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::SHADER_READ_ONLY_OPTIMAL);
+    Turbo::Core::TAttachment depth_attachment(depthFormat, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::SHADER_READ_ONLY_OPTIMAL);
+    std::vector<Turbo::Core::TAttachment> attachments = {color_attachment, depth_attachment};
+    this->renderPass = new Turbo::Core::TRenderPass(device, attachments, subpasses);
+}
+
+HoleFilling::~HoleFilling()
+{
+    this->FreeDescriptorSets();
+}
+
+void HoleFilling::FreeDescriptorSets()
+{
+    for (Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> &pull_descriptor_set_item : this->pullDescriptorSets)
+    {
+        this->descriptorPool->Free(pull_descriptor_set_item);
+    }
+    this->pullDescriptorSets.clear();
+
+    for (Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> &push_descriptor_set_item : this->pushDescriptorSets)
+    {
+        this->descriptorPool->Free(push_descriptor_set_item);
+    }
+    this->pushDescriptorSets.clear();
+}
+
+void HoleFilling::SetTargets(uint32_t width, uint32_t height)
+{
+    this->FreeDescriptorSets();
+    this->pyramidColorLevelImageViews.clear();
+    this->pyramidDepthLevelImageViews.clear();
+
+    const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device = this->renderPass->GetDevice();
+    this->width = std::max(1u, width);
+    this->height = std::max(1u, height);
+
+    this->colorImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, this->colorFormat.GetFormatType(), this->width, this->height, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_COLOR_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    this->colorImageView = new Turbo::Core::TImageView(this->colorImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->colorImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+    this->depthImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, this->depthFormat.GetFormatType(), this->width, this->height, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_DEPTH_STENCIL_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    this->depthImageView = new Turbo::Core::TImageView(this->depthImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->depthImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_DEPTH_BIT, 0, 1, 0, 1);
+
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> image_views = {this->colorImageView, this->depthImageView};
+    this->framebuffer = new Turbo::Core::TFramebuffer(this->renderPass, image_views);
+
+    uint32_t level_count = 1;
+    while (level_count < MAX_LEVEL_COUNT && (std::max(this->width, this->height) >> level_count) > 0)
+    {
+        level_count++;
+    }
+
+    this->pyramidColorImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R16G16B16A16_SFLOAT, this->width, this->height, 1, level_count, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_STORAGE | Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    this->pyramidDepthImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R32_SFLOAT, this->width, this->height, 1, level_count, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    for (uint32_t level = 0; level < level_count; level++)
+    {
+        this->pyramidColorLevelImageViews.push_back(new Turbo::Core::TImageView(this->pyramidColorImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->pyramidColorImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, level, 1, 0, 1));
+        this->pyramidDepthLevelImageViews.push_back(new Turbo::Core::TImageView(this->pyramidDepthImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->pyramidDepthImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, level, 1, 0, 1));
+    }
+
+    for (uint32_t level = 0; level < level_count; level++)
+    {
+        const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pull_pipeline = level == 0 ? this->pullFromTargetPipeline : this->pullPipeline;
+        Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> pull_descriptor_set = this->descriptorPool->Allocate(pull_pipeline->GetPipelineLayout());
+        if (level == 0)
+        {
+            std::vector<std::pair<Turbo::Core::TRefPtr<Turbo::Core::TImageView>, Turbo::Core::TRefPtr<Turbo::Core::TSampler>>> color_combined_image_samplers = {std::make_pair(this->colorImageView, this->sampler)};
+            std::vector<std::pair<Turbo::Core::TRefPtr<Turbo::Core::TImageView>, Turbo::Core::TRefPtr<Turbo::Core::TSampler>>> depth_combined_image_samplers = {std::make_pair(this->depthImageView, this->sampler)};
+            pull_descriptor_set->BindData(0, 0, 0, color_combined_image_samplers);
+            pull_descriptor_set->BindData(0, 1, 0, depth_combined_image_samplers);
+        }
+        else
+        {
+            std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> source_color_image_views = {this->pyramidColorLevelImageViews[level - 1]};
+            std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> source_depth_image_views = {this->pyramidDepthLevelImageViews[level - 1]};
+            pull_descriptor_set->BindData(0, 0, 0, source_color_image_views);
+            pull_descriptor_set->BindData(0, 1, 0, source_depth_image_views);
+        }
+        std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> destination_color_image_views = {this->pyramidColorLevelImageViews[level]};
+        std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> destination_depth_image_views = {this->pyramidDepthLevelImageViews[level]};
+        pull_descriptor_set->BindData(0, 2, 0, destination_color_image_views);
+        pull_descriptor_set->BindData(0, 3, 0, destination_depth_image_views);
+        this->pullDescriptorSets.push_back(pull_descriptor_set);
+
+        if (level + 1 < level_count)
+        {
+            Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> push_descriptor_set = this->descriptorPool->Allocate(this->pushPipeline->GetPipelineLayout());
+            std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> source_color_image_views = {this->pyramidColorLevelImageViews[level + 1]};
+            std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> source_depth_image_views = {this->pyramidDepthLevelImageViews[level + 1]};
+            push_descriptor_set->BindData(0, 0, 0, source_color_image_views);
+            push_descriptor_set->BindData(0, 1, 0, source_depth_image_views);
+            push_descriptor_set->BindData(0, 2, 0, destination_color_image_views);
+            push_descriptor_set->BindData(0, 3, 0, destination_depth_image_views);
+            this->pushDescriptorSets.push_back(push_descriptor_set);
+        }
+    }
+}
+
+void HoleFilling::SetLevelCount(uint32_t levelCount)
+{
+    this->levelCount = std::min(std::max(levelCount, 1u), MAX_LEVEL_COUNT);
+}
+
+uint32_t HoleFilling::GetLevelCount() const
+{
+    return std::min(this->levelCount, this->GetMaxLevelCount());
+}
+
+uint32_t HoleFilling::GetMaxLevelCount() const
+{
+    return static_cast<uint32_t>(this->pyramidColorLevelImageViews.size());
+}
+
+void HoleFilling::SetDepthThreshold(float depthThreshold)
+{
+    this->depthThreshold = std::max(depthThreshold, 0.0f);
+}
+
+float HoleFilling::GetDepthThreshold() const
+{
+    return this->depthThreshold;
+}
+
+void HoleFilling::SetMinCoverage(float minCoverage)
+{
+    this->minCoverage = std::min(std::max(minCoverage, 0.0f), 1.0f);
+}
+
+float HoleFilling::GetMinCoverage() const
+{
+    return this->minCoverage;
+}
+
+void HoleFilling::CmdBegin(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    commandBuffer->CmdBeginRenderPass(this->renderPass, this->framebuffer);
+}
+
+void HoleFilling::CmdEnd(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    // subpass 1 is the ImGui subpass of the points render pass, nothing is drawn there
+    commandBuffer->CmdNextSubpass();
+    commandBuffer->CmdEndRenderPass();
+}
+
+void HoleFilling::CmdFill(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const glm::mat4 &projection)
+{
+    uint32_t level_count = this->GetLevelCount();
+
+    Turbo::Core::TMemoryBarrier target_barrier(Turbo::Core::TAccessBits::COLOR_ATTACHMENT_WRITE_BIT | Turbo::Core::TAccessBits::DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT | Turbo::Core::TPipelineStageBits::LATE_FRAGMENT_TESTS_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, target_barrier);
+    // the content of last frame is never read again
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, 0, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::GENERAL, this->pyramidColorImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, this->GetMaxLevelCount(), 0, 1);
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, 0, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::GENERAL, this->pyramidDepthImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, this->GetMaxLevelCount(), 0, 1);
+
+    // view distance = projection[3][2] / (depth + projection[2][2]) for any glm perspective projection
+    PullPushConstants pull_push_constants;
+    pull_push_constants.depthParams[0] = projection[2][2];
+    pull_push_constants.depthParams[1] = projection[3][2];
+    pull_push_constants.depthThreshold = this->depthThreshold;
+    pull_push_constants.minCoverage = this->minCoverage;
+    pull_push_constants.isResolve = 0;
+
+    Turbo::Core::TMemoryBarrier level_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::SHADER_WRITE_BIT);
+    for (uint32_t level = 0; level < level_count; level++)
+    {
+        uint32_t level_width = std::max(1u, this->width >> level);
+        uint32_t level_height = std::max(1u, this->height >> level);
+
+        commandBuffer->CmdBindPipeline(level == 0 ? this->pullFromTargetPipeline : this->pullPipeline);
+        commandBuffer->CmdBindPipelineDescriptorSet(this->pullDescriptorSets[level]);
+        commandBuffer->CmdPushConstants(0, sizeof(pull_push_constants), &pull_push_constants);
+        commandBuffer->CmdDispatch((level_width + PULL_PUSH_GROUP_SIZE - 1) / PULL_PUSH_GROUP_SIZE, (level_height + PULL_PUSH_GROUP_SIZE - 1) / PULL_PUSH_GROUP_SIZE, 1);
+        commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, level_barrier);
+    }
+
+    // a single level has nothing to push, level 0 is then the target as drawn with its coverage in alpha
+    for (uint32_t level = level_count - 1; level-- > 0;)
+    {
+        uint32_t level_width = std::max(1u, this->width >> level);
+        uint32_t level_height = std::max(1u, this->height >> level);
+        pull_push_constants.isResolve = level == 0 ? 1 : 0;
+
+        commandBuffer->CmdBindPipeline(this->pushPipeline);
+        commandBuffer->CmdBindPipelineDescriptorSet(this->pushDescriptorSets[level]);
+        commandBuffer->CmdPushConstants(0, sizeof(pull_push_constants), &pull_push_constants);
+        commandBuffer->CmdDispatch((level_width + PULL_PUSH_GROUP_SIZE - 1) / PULL_PUSH_GROUP_SIZE, (level_height + PULL_PUSH_GROUP_SIZE - 1) / PULL_PUSH_GROUP_SIZE, 1);
+        commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, level_barrier);
+    }
+}
+
+void HoleFilling::CmdBlitToImage(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TImage> &image)
+{
+    Turbo::Core::TMemoryBarrier fill_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, fill_barrier);
+
+    // the swapchain image acquire semaphore is waited at COLOR_ATTACHMENT_OUTPUT, the blit has to wait for it too
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, 0, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, image, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+    // a blit, not a copy: R16G16B16A16_SFLOAT to the sRGB swapchain format
+    commandBuffer->CmdBlitImage(this->pyramidColorImage, Turbo::Core::TImageLayout::GENERAL, image, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, 0, 0, 0, static_cast<int32_t>(this->width), static_cast<int32_t>(this->height), 1, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, static_cast<int32_t>(image->GetWidth()), static_cast<int32_t>(image->GetHeight()), 1, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, Turbo::Core::TFilter::NEAREST);
+
+    Turbo::Core::TMemoryBarrier blit_barrier(Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::COLOR_ATTACHMENT_READ_BIT | Turbo::Core::TAccessBits::COLOR_ATTACHMENT_WRITE_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, blit_barrier);
+}
@@ -0,0 +1,96 @@
+#pragma once
+#ifndef POINTCLOUD_HOLEFILLING_H
+#define POINTCLOUD_HOLEFILLING_H
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TComputePipeline.h"
+#include "../core/include/TDescriptorPool.h"
+#include "../core/include/TFramebuffer.h"
+#include "../core/include/TImage.h"
+#include "../core/include/TImageView.h"
+#include "../core/include/TPipelineDescriptorSet.h"
+#include "../core/include/TRenderPass.h"
+#include "../core/include/TSampler.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Screen space hole filling of the 1 pixel points: the points are drawn into an offscreen color and depth target,
+// CmdFill() runs a depth aware pull-push filter over it (PullPush.comp) and CmdBlitToImage() copies the result into the swapchain image:
+//   pull  every level averages the covered texels of the level below that belong to the nearest surface, up to GetLevelCount() levels
+//   push  from the coarsest level down, empty texels and background texels seen through the surface take the coarser level
+// A hole is filled when it is smaller than about 2^(level count - 1) pixels and the coarser level covers it enough,
+// so the background around the cloud stays the clear color.
+class HoleFilling
+{
+  public:
+    static constexpr uint32_t MAX_LEVEL_COUNT = 10;
+
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> descriptorPool;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> pullFromTargetPipeline; // PullPush.comp with PULL_FROM_TARGET
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> pullPipeline;           // PullPush.comp with PULL
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> pushPipeline;           // PullPush.comp with PUSH
+    Turbo::Core::TRefPtr<Turbo::Core::TSampler> sampler;
+
+    Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> renderPass; // clears both, both end in SHADER_READ_ONLY_OPTIMAL
+    Turbo::Core::TFormatInfo colorFormat;
+    Turbo::Core::TFormatInfo depthFormat;
+
+    uint32_t width = 0; // swapchain size
+    uint32_t height = 0;
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> colorImage;
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> colorImageView;
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> depthImage;
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> depthImageView;
+    Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> framebuffer;
+
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> pyramidColorImage; // R16G16B16A16_SFLOAT, color and coverage, level 0 is the target size
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> pyramidDepthImage;  // R32_SFLOAT, view distance
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> pyramidColorLevelImageViews;
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> pyramidDepthLevelImageViews;
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> pullDescriptorSets; // level i reads level i - 1 (or the target) and writes level i
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> pushDescriptorSets; // level i reads level i + 1 and updates level i, the last has none
+
+    uint32_t levelCount = 6;
+    float depthThreshold = 0.1f;
+    float minCoverage = 0.25f;
+
+  private:
+    void FreeDescriptorSets();
+
+  public:
+    // subpasses of the points render pass, so the points pipelines stay compatible with the offscreen render pass
+    HoleFilling(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pullFromTargetPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pullPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &pushPipeline, Turbo::Core::TFormatInfo colorFormat, Turbo::Core::TFormatInfo depthFormat, std::vector<Turbo::Core::TSubpass> &subpasses);
+    ~HoleFilling();
+
+    HoleFilling(const HoleFilling &) = delete;
+    HoleFilling &operator=(const HoleFilling &) = delete;
+
+  public:
+    // After every (re)creation of the swapchain
+    void SetTargets(uint32_t width, uint32_t height);
+
+    // 1 draws the target as is, clamped to the levels the target size allows
+    void SetLevelCount(uint32_t levelCount);
+    uint32_t GetLevelCount() const;
+    uint32_t GetMaxLevelCount() const;
+    // relative view distance a texel may lie behind the nearest one and still count as the same surface
+    void SetDepthThreshold(float depthThreshold);
+    float GetDepthThreshold() const;
+    // coverage of the coarser level below which a hole is left empty
+    void SetMinCoverage(float minCoverage);
+    float GetMinCoverage() const;
+
+    // Around the points draws, in subpass 0 of the offscreen render pass
+    void CmdBegin(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer);
+    void CmdEnd(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer);
+
+    // Outside a render pass after CmdEnd(), projection is the one the points were drawn with
+    void CmdFill(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const glm::mat4 &projection);
+    // After CmdFill(), the image is left in TRANSFER_DST_OPTIMAL for a render pass loading it
+    void CmdBlitToImage(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TImage> &image);
+};
+
+#endif // !POINTCLOUD_HOLEFILLING_H
@@ -0,0 +1,328 @@
+#include "MortonSort.h"
+#include "PointCloudUpload.h"
+#include "Trace.h"
+#include "WorkerPool.h"
+
+#include "../core/include/TBarrier.h"
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TDescriptorPool.h"
+#include "../core/include/TFence.h"
+#include "../core/include/TImage.h"
+#include "../core/include/TImageView.h"
+#include "../core/include/TPipelineDescriptorSet.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+namespace
+{
+// push_constant MORTON_CONSTANTS of MortonSort.comp
+typedef struct MortonConstants
+{
+    uint32_t count;
+    uint32_t firstIndex;
+    uint32_t chunkIndex;
+    uint32_t chunkCount;
+} MortonConstants;
+
+const uint32_t MORTON_AXIS_CELL_COUNT = 1024; // 10 bits per axis
+
+uint32_t SpreadBits(uint32_t value)
+{
+    value &= 0x3FFu;
+    value = (value | (value << 16)) & 0x030000FFu;
+    value = (value | (value << 8)) & 0x0300F00Fu;
+    value = (value | (value << 4)) & 0x030C30C3u;
+    value = (value | (value << 2)) & 0x09249249u;
+    return value;
+}
+
+uint32_t GetAxisCell(float value, float min, float max)
+{
+    float cell = (value - min) / std::max(max - min, 1e-20f) * static_cast<float>(MORTON_AXIS_CELL_COUNT);
+    return static_cast<uint32_t>(std::min(std::max(cell, 0.0f), static_cast<float>(MORTON_AXIS_CELL_COUNT - 1)));
+}
+
+// inverse of FloatToOrdered() of MortonSort.comp
+float OrderedToFloat(uint32_t ordered)
+{
+    uint32_t bits = (ordered & 0x80000000u) != 0 ? ordered & 0x7FFFFFFFu : ~ordered;
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+void CmdComputeBarrier(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    Turbo::Core::TMemoryBarrier compute_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::SHADER_WRITE_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, compute_barrier);
+}
+
+uint32_t GetGroupCount(uint32_t count)
+{
+    return static_cast<uint32_t>((static_cast<uint64_t>(count) + ComputePrimitives::GROUP_SIZE - 1) / ComputePrimitives::GROUP_SIZE);
+}
+} // namespace
+
+uint32_t GetMortonKey(const POSITION &position, const PointsBounds &bounds)
+{
+    uint32_t cell_x = GetAxisCell(position.x, bounds.min.x, bounds.max.x);
+    uint32_t cell_y = GetAxisCell(position.y, bounds.min.y, bounds.max.y);
+    uint32_t cell_z = GetAxisCell(position.z, bounds.min.z, bounds.max.z);
+    return SpreadBits(cell_x) | (SpreadBits(cell_y) << 1) | (SpreadBits(cell_z) << 2);
+}
+
+void SortPointsMorton(std::vector<Point> &points, WorkerPool &workerPool)
+{
+    TRACE_ZONE("SortPointsMorton");
+    if (points.size() <= 1)
+    {
+        return;
+    }
+
+    PointsBounds empty_bounds;
+    empty_bounds.min = {FLT_MAX, FLT_MAX, FLT_MAX, 0};
+    empty_bounds.max = {-FLT_MAX, -FLT_MAX, -FLT_MAX, 0};
+    auto merge_bounds = [](const PointsBounds &left, const PointsBounds &right) {
+        PointsBounds merged = left;
+        merged.min.x = std::min(left.min.x, right.min.x);
+        merged.min.y = std::min(left.min.y, right.min.y);
+        merged.min.z = std::min(left.min.z, right.min.z);
+        merged.max.x = std::max(left.max.x, right.max.x);
+        merged.max.y = std::max(left.max.y, right.max.y);
+        merged.max.z = std::max(left.max.z, right.max.z);
+        return merged;
+    };
+    PointsBounds bounds = workerPool.ParallelReduce(points.size(), empty_bounds, [&](size_t begin, size_t end) {
+        PointsBounds range_bounds = empty_bounds;
+        for (size_t point_index = begin; point_index < end; point_index++)
+        {
+            const POSITION &position = points[point_index].position;
+            range_bounds.min.x = std::min(range_bounds.min.x, position.x);
+            range_bounds.min.y = std::min(range_bounds.min.y, position.y);
+            range_bounds.min.z = std::min(range_bounds.min.z, position.z);
+            range_bounds.max.x = std::max(range_bounds.max.x, position.x);
+            range_bounds.max.y = std::max(range_bounds.max.y, position.y);
+            range_bounds.max.z = std::max(range_bounds.max.z, position.z);
+        }
+        return range_bounds;
+    }, merge_bounds);
+
+    // key in the high word, point index in the low word: sorting the pairs is the stable sort by key the GPU radix sort does
+    std::vector<uint64_t> key_indices(points.size());
+    workerPool.ParallelFor(points.size(), [&](size_t begin, size_t end) {
+        for (size_t point_index = begin; point_index < end; point_index++)
+        {
+            key_indices[point_index] = (static_cast<uint64_t>(GetMortonKey(points[point_index].position, bounds)) << 32) | point_index;
+        }
+    });
+    std::sort(key_indices.begin(), key_indices.end());
+
+    std::vector<Point> sorted_points(points.size());
+    workerPool.ParallelFor(points.size(), [&](size_t begin, size_t end) {
+        for (size_t point_index = begin; point_index < end; point_index++)
+        {
+            sorted_points[point_index] = points[static_cast<uint32_t>(key_indices[point_index])];
+        }
+    });
+    points.swap(sorted_points);
+}
+
+MortonSortPipelineFutures MortonSort::BuildPipelines(PipelineBuilder &pipelineBuilder, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &shaderCode, const ComputePrimitivesShaderCodes &primitivesShaderCodes, const PipelineBuilder::ComputePipelineCreator &creator, PointsStorageType storageType, bool isSubgroup)
+{
+    std::vector<std::string> gather_defines = {"MORTON_GATHER"};
+    if (storageType == PointsStorageType::IMAGE)
+    {
+        gather_defines.push_back("POINTS_IMAGE");
+        gather_defines.push_back("TEX_SIZE " + std::to_string(TEX_SIZE));
+    }
+
+    MortonSortPipelineFutures pipeline_futures;
+    pipeline_futures.split = pipelineBuilder.BuildComputePipeline(device, "MortonSort.comp", shaderCode, PipelineBuilder::ComputePipelineCreator(creator), {"MORTON_SPLIT"});
+    pipeline_futures.keys = pipelineBuilder.BuildComputePipeline(device, "MortonSort.comp", shaderCode, PipelineBuilder::ComputePipelineCreator(creator));
+    pipeline_futures.gather = pipelineBuilder.BuildComputePipeline(device, "MortonSort.comp", shaderCode, PipelineBuilder::ComputePipelineCreator(creator), gather_defines);
+    pipeline_futures.primitives = ComputePrimitives::BuildPipelines(pipelineBuilder, device, primitivesShaderCodes, creator, isSubgroup);
+    return pipeline_futures;
+}
+
+MortonSortPipelines MortonSort::GetPipelines(const MortonSortPipelineFutures &pipelineFutures)
+{
+    MortonSortPipelines pipelines;
+    pipelines.split = pipelineFutures.split.get();
+    pipelines.keys = pipelineFutures.keys.get();
+    pipelines.gather = pipelineFutures.gather.get();
+    pipelines.primitives = ComputePrimitives::GetPipelines(pipelineFutures.primitives);
+    return pipelines;
+}
+
+MortonSort::MortonSort(const MortonSortPipelines &pipelines, PointsStorageType storageType) : pipelines(pipelines), storageType(storageType)
+{
+}
+
+std::vector<PointsChunkData> MortonSort::CreateAllPointsData(const std::vector<Point> &points, Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> queue, Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> commandPool)
+{
+    TRACE_ZONE("MortonSort::CreateAllPointsData");
+    const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device = this->pipelines.split->GetDevice();
+    uint32_t point_count = static_cast<uint32_t>(points.size());
+    uint32_t chunk_content_size = TEX_SIZE * TEX_SIZE;
+    uint32_t chunk_count = (point_count + chunk_content_size - 1) / chunk_content_size;
+
+    std::vector<PointsChunkData> result(chunk_count);
+    if (chunk_count == 0)
+    {
+        return result;
+    }
+
+    // file order, read twice by the GPU: once by the split, once by the gather
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> raw_points_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, static_cast<Turbo::Core::TDeviceSize>(point_count) * sizeof(Point));
+    memcpy(raw_points_buffer->Map(), points.data(), static_cast<size_t>(point_count) * sizeof(Point));
+    raw_points_buffer->Unmap();
+
+    Turbo::Core::TDeviceSize item_size = static_cast<Turbo::Core::TDeviceSize>(point_count) * sizeof(uint32_t);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> positions_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, 0, static_cast<Turbo::Core::TDeviceSize>(point_count) * sizeof(POSITION));
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> min_max_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, 0, 2 * sizeof(POSITION));
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> keys_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, 0, item_size);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> values_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, 0, item_size);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> scratch_keys_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, 0, item_size);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> scratch_values_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, 0, item_size);
+    Turbo::Core::TDeviceSize chunk_bounds_size = static_cast<Turbo::Core::TDeviceSize>(chunk_count) * 6 * sizeof(uint32_t);
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> chunk_bounds_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_DST, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_RANDOM, chunk_bounds_size);
+
+    for (uint32_t chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    {
+        PointsChunkData &chunk = result[chunk_index];
+        chunk.count = std::min(chunk_content_size, point_count - chunk_index * chunk_content_size);
+        if (this->storageType == PointsStorageType::BUFFER)
+        {
+            chunk.pointsBuffer.positionBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, 0, chunk.count * sizeof(POSITION));
+            chunk.pointsBuffer.colorBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, 0, chunk.count * sizeof(COLOR));
+        }
+        else
+        {
+            Turbo::Core::TRefPtr<Turbo::Core::TImage> position_image = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R32G32B32A32_SFLOAT, TEX_SIZE, TEX_SIZE, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+            Turbo::Core::TRefPtr<Turbo::Core::TImage> color_image = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R32G32B32A32_SFLOAT, TEX_SIZE, TEX_SIZE, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+            chunk.pointsPositionImage.image = position_image;
+            chunk.pointsPositionImage.imageView = new Turbo::Core::TImageView(position_image, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, position_image->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+            chunk.pointsColorImage.image = color_image;
+            chunk.pointsColorImage.imageView = new Turbo::Core::TImageView(color_image, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, color_image->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+        }
+    }
+
+    // the primitives allocate a few sets per level and radix pass, the gather one per chunk
+    uint32_t max_set_count = chunk_count + 256;
+    std::vector<Turbo::Core::TDescriptorSize> descriptor_sizes = {
+        {Turbo::Core::TDescriptorType::STORAGE_BUFFER, max_set_count * 6},
+        {Turbo::Core::TDescriptorType::STORAGE_IMAGE, chunk_count * 2}};
+    Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> descriptor_pool = new Turbo::Core::TDescriptorPool(device, max_set_count, descriptor_sizes);
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> descriptor_sets;
+    ComputePrimitives primitives(descriptor_pool, this->pipelines.primitives);
+
+    Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> command_buffer = commandPool->Allocate();
+    command_buffer->Begin();
+
+    // the 3 mins of every chunk start at the largest ordered uint, the 3 maxs at the smallest
+    command_buffer->CmdFillBuffer(chunk_bounds_buffer, 0, chunk_bounds_size / 2, 0xFFFFFFFFu);
+    command_buffer->CmdFillBuffer(chunk_bounds_buffer, chunk_bounds_size / 2, chunk_bounds_size / 2, 0u);
+    Turbo::Core::TMemoryBarrier fill_barrier(Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::SHADER_WRITE_BIT);
+    command_buffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, fill_barrier);
+    if (this->storageType == PointsStorageType::IMAGE)
+    {
+        for (const PointsChunkData &chunk_item : result)
+        {
+            command_buffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::HOST_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TAccessBits::HOST_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::GENERAL, chunk_item.pointsPositionImage.image, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+            command_buffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::HOST_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TAccessBits::HOST_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::GENERAL, chunk_item.pointsColorImage.image, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+        }
+    }
+
+    MortonConstants morton_constants = {point_count, 0, 0, chunk_count};
+    {
+        TRACE_ZONE("MortonSort::Record");
+        Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> split_descriptor_set = descriptor_pool->Allocate(this->pipelines.split->GetPipelineLayout());
+        split_descriptor_set->BindData(0, 0, raw_points_buffer);
+        split_descriptor_set->BindData(0, 1, positions_buffer);
+        descriptor_sets.push_back(split_descriptor_set);
+        command_buffer->CmdBindPipeline(this->pipelines.split);
+        command_buffer->CmdBindPipelineDescriptorSet(split_descriptor_set);
+        command_buffer->CmdPushConstants(0, sizeof(morton_constants), &morton_constants);
+        ComputePrimitives::CmdDispatchGroups(command_buffer, GetGroupCount(point_count));
+        CmdComputeBarrier(command_buffer);
+
+        primitives.CmdReduceMinMax(command_buffer, positions_buffer, point_count, min_max_buffer);
+
+        Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> keys_descriptor_set = descriptor_pool->Allocate(this->pipelines.keys->GetPipelineLayout());
+        keys_descriptor_set->BindData(0, 1, positions_buffer);
+        keys_descriptor_set->BindData(0, 2, min_max_buffer);
+        keys_descriptor_set->BindData(0, 3, keys_buffer);
+        keys_descriptor_set->BindData(0, 4, values_buffer);
+        descriptor_sets.push_back(keys_descriptor_set);
+        command_buffer->CmdBindPipeline(this->pipelines.keys);
+        command_buffer->CmdBindPipelineDescriptorSet(keys_descriptor_set);
+        command_buffer->CmdPushConstants(0, sizeof(morton_constants), &morton_constants);
+        ComputePrimitives::CmdDispatchGroups(command_buffer, GetGroupCount(point_count));
+        CmdComputeBarrier(command_buffer);
+
+        primitives.CmdRadixSort(command_buffer, RadixKeyType::UINT32, keys_buffer, values_buffer, point_count, scratch_keys_buffer, scratch_values_buffer);
+
+        command_buffer->CmdBindPipeline(this->pipelines.gather);
+        for (uint32_t chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+        {
+            const PointsChunkData &chunk = result[chunk_index];
+            Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> gather_descriptor_set = descriptor_pool->Allocate(this->pipelines.gather->GetPipelineLayout());
+            gather_descriptor_set->BindData(0, 0, raw_points_buffer);
+            gather_descriptor_set->BindData(0, 4, values_buffer);
+            if (this->storageType == PointsStorageType::BUFFER)
+            {
+                gather_descriptor_set->BindData(0, 5, chunk.pointsBuffer.positionBuffer);
+                gather_descriptor_set->BindData(0, 6, chunk.pointsBuffer.colorBuffer);
+            }
+            else
+            {
+                std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> position_image_views = {chunk.pointsPositionImage.imageView};
+                std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> color_image_views = {chunk.pointsColorImage.imageView};
+                gather_descriptor_set->BindData(0, 5, 0, position_image_views);
+                gather_descriptor_set->BindData(0, 6, 0, color_image_views);
+            }
+            gather_descriptor_set->BindData(0, 7, chunk_bounds_buffer);
+            descriptor_sets.push_back(gather_descriptor_set);
+
+            morton_constants = {chunk.count, chunk_index * chunk_content_size, chunk_index, chunk_count};
+            command_buffer->CmdBindPipelineDescriptorSet(gather_descriptor_set);
+            command_buffer->CmdPushConstants(0, sizeof(morton_constants), &morton_constants);
+            command_buffer->CmdDispatch(GetGroupCount(chunk.count), 1, 1);
+        }
+
+        // the points pipeline, PointCull.comp and the bounds readback below
+        Turbo::Core::TMemoryBarrier gather_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::HOST_READ_BIT);
+        command_buffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::VERTEX_SHADER_BIT | Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT | Turbo::Core::TPipelineStageBits::HOST_BIT, gather_barrier);
+    }
+    command_buffer->End();
+
+    {
+        TRACE_ZONE("MortonSort::Wait");
+        Turbo::Core::TRefPtr<Turbo::Core::TFence> fence = new Turbo::Core::TFence(device);
+        queue->Submit(command_buffer, fence);
+        fence->WaitUntil();
+    }
+    commandPool->Free(command_buffer);
+
+    primitives.Reset();
+    for (Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> &descriptor_set_item : descriptor_sets)
+    {
+        descriptor_pool->Free(descriptor_set_item);
+    }
+
+    const uint32_t *chunk_bounds = static_cast<const uint32_t *>(chunk_bounds_buffer->Map());
+    for (uint32_t chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    {
+        const uint32_t *mins = chunk_bounds + chunk_index * 3;
+        const uint32_t *maxs = chunk_bounds + chunk_count * 3 + chunk_index * 3;
+        PointsBounds &bounds = result[chunk_index].bounds;
+        bounds.min = {OrderedToFloat(mins[0]), OrderedToFloat(mins[1]), OrderedToFloat(mins[2]), 0};
+        bounds.max = {OrderedToFloat(maxs[0]), OrderedToFloat(maxs[1]), OrderedToFloat(maxs[2]), 0};
+        bounds.centre = {(bounds.min.x + bounds.max.x) * 0.5f, (bounds.min.y + bounds.max.y) * 0.5f, (bounds.min.z + bounds.max.z) * 0.5f, 0};
+    }
+    chunk_bounds_buffer->Unmap();
+
+    return result;
+}
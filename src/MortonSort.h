@@ -0,0 +1,78 @@
+#pragma once
+#ifndef POINTCLOUD_MORTONSORT_H
+#define POINTCLOUD_MORTONSORT_H
+#include "ComputePrimitives.h"
+#include "PipelineBuilder.h"
+#include "PointCloudData.h"
+
+#include "../core/include/TCommandBufferPool.h"
+#include "../core/include/TComputePipeline.h"
+#include "../core/include/TDevice.h"
+#include "../core/include/TDeviceQueue.h"
+
+#include <cstdint>
+#include <future>
+#include <string>
+#include <vector>
+
+class WorkerPool;
+
+typedef enum class MortonSortMode
+{
+    NONE, // file order
+    CPU,  // SortPointsMorton() on the worker pool, then the usual upload
+    GPU,  // MortonSort::CreateAllPointsData(), the upload is part of it
+} MortonSortMode;
+
+typedef struct MortonSortPipelines
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> split;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> keys;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> gather; // with POINTS_IMAGE for PointsStorageType::IMAGE
+    ComputePrimitivesPipelines primitives;
+} MortonSortPipelines;
+
+typedef struct MortonSortPipelineFutures
+{
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> split;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> keys;
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> gather;
+    ComputePrimitivesPipelineFutures primitives;
+} MortonSortPipelineFutures;
+
+// 30 bit Morton key of position in bounds, 10 bits per axis, the key of MortonSort.comp
+uint32_t GetMortonKey(const POSITION &position, const PointsBounds &bounds);
+
+// Reorder points along the Morton curve of their bounds: bounds and keys on the worker pool, then a stable sort by key.
+// The chunks cut from the result are spatially compact, so their bounds are tight. The CPU reference of MortonSort.
+void SortPointsMorton(std::vector<Point> &points, WorkerPool &workerPool);
+
+// Morton ordering on the GPU: the points are uploaded in file order into one buffer, MortonSort.comp splits out the positions,
+// ComputePrimitives reduces their bounds, MortonSort.comp computes the keys, ComputePrimitives radix sorts them with the point
+// indices, and MortonSort.comp gathers every chunk in sorted order into its storage buffers (images for PointsStorageType::IMAGE).
+// The chunk bounds come out of the gather, there is no CPU pass over the points besides the copy into the upload buffer.
+// NOTE: the keys match GetMortonKey() up to the rounding of the GPU division, points on a cell border may land in the next cell
+class MortonSort
+{
+  private:
+    MortonSortPipelines pipelines;
+    PointsStorageType storageType;
+
+  public:
+    static MortonSortPipelineFutures BuildPipelines(PipelineBuilder &pipelineBuilder, const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &shaderCode, const ComputePrimitivesShaderCodes &primitivesShaderCodes, const PipelineBuilder::ComputePipelineCreator &creator, PointsStorageType storageType, bool isSubgroup);
+    // Wait the pipelines, rethrows the Turbo::Core::TException of a failed one
+    static MortonSortPipelines GetPipelines(const MortonSortPipelineFutures &pipelineFutures);
+
+    MortonSort(const MortonSortPipelines &pipelines, PointsStorageType storageType);
+
+    MortonSort(const MortonSort &) = delete;
+    MortonSort &operator=(const MortonSort &) = delete;
+
+  public:
+    // The same chunks as CreateAllPointsBufferData()/CreateAllPointsImageData() of the points in Morton order,
+    // one submission waited on its fence. Needs about 32 bytes of device memory per point besides the chunks while it runs,
+    // and the 32 of the upload buffer.
+    std::vector<PointsChunkData> CreateAllPointsData(const std::vector<Point> &points, Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> queue, Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> commandPool);
+};
+
+#endif // !POINTCLOUD_MORTONSORT_H
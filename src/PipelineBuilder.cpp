@@ -0,0 +1,219 @@
+#include "PipelineBuilder.h"
+#include "ShaderCache.h"
+#include "Trace.h"
+
+#include <algorithm>
+
+namespace
+{
+const std::chrono::milliseconds MAIN_THREAD_POLL_INTERVAL(1); // WaitFor() runs the main thread tasks at least that often
+
+// filled by the worker task, an empty spirv could not be compiled there and is compiled through Turbo by the main thread task
+typedef struct ShaderLookup
+{
+    std::string name;
+    std::string code;
+    Turbo::Core::TShaderType type;
+    std::vector<uint32_t> spirv;
+} ShaderLookup;
+
+// EndJob() even if the compile or the pipeline creation throws, otherwise Wait() never returns
+class PipelineJobGuard
+{
+  private:
+    std::function<void()> endJob;
+
+  public:
+    explicit PipelineJobGuard(std::function<void()> &&endJob) : endJob(std::move(endJob))
+    {
+    }
+
+    ~PipelineJobGuard()
+    {
+        this->endJob();
+    }
+};
+
+// Pure std, the worker task must not touch any Turbo object. A cache miss is compiled here
+void GetSpirVs(ShaderCache &shaderCache, std::vector<ShaderLookup> &lookups, const std::vector<std::string> &defines)
+{
+    for (ShaderLookup &lookup_item : lookups)
+    {
+        if (!shaderCache.FindSpirV(lookup_item.name, lookup_item.type, lookup_item.code, defines, {}, "main", lookup_item.spirv))
+        {
+            shaderCache.CompileSpirV(lookup_item.type, lookup_item.code, defines, {}, "main", lookup_item.spirv);
+        }
+    }
+}
+
+template <typename Shader, typename CompileFunction>
+Turbo::Core::TRefPtr<Shader> CreateShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, ShaderLookup &lookup, CompileFunction &&compile)
+{
+    if (lookup.spirv.empty())
+    {
+        return compile();
+    }
+    return new Shader(device, lookup.spirv.size() * sizeof(uint32_t), lookup.spirv.data());
+}
+} // namespace
+
+PipelineBuilder::PipelineBuilder(WorkerPool &workerPool, ShaderCache &shaderCache) : workerPool(workerPool), shaderCache(shaderCache)
+{
+}
+
+PipelineBuilder::~PipelineBuilder()
+{
+    this->Wait();
+}
+
+void PipelineBuilder::BeginJob(const WorkerPool::TaskHandle &jobTask)
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->pendingCount++;
+    this->jobCount++;
+    this->jobTasks.push_back(jobTask);
+}
+
+void PipelineBuilder::EndJob()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->pendingCount--;
+    }
+    this->condition.notify_all();
+}
+
+std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>> PipelineBuilder::BuildGraphicsPipeline(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &vertexShaderName, const std::string &vertexShaderCode, const std::string &fragmentShaderName, const std::string &fragmentShaderCode, GraphicsPipelineCreator &&creator, const std::vector<std::string> &defines)
+{
+    std::shared_ptr<std::vector<ShaderLookup>> lookups = std::make_shared<std::vector<ShaderLookup>>(2);
+    (*lookups)[0].name = vertexShaderName;
+    (*lookups)[0].code = vertexShaderCode;
+    (*lookups)[0].type = Turbo::Core::TShaderType::VERTEX;
+    (*lookups)[1].name = fragmentShaderName;
+    (*lookups)[1].code = fragmentShaderCode;
+    (*lookups)[1].type = Turbo::Core::TShaderType::FRAGMENT;
+
+    WorkerPool::TaskHandle spirv_task = this->workerPool.Schedule([this, lookups, defines]() {
+        TRACE_ZONE("BuildPipelineSpirV");
+        GetSpirVs(this->shaderCache, *lookups, defines);
+        this->condition.notify_all(); // WaitFor() runs the main thread task
+    });
+
+    // the device and the creator (and the TRefPtr<T>s it holds) are copied here and released after the task ran, both on the main thread
+    std::shared_ptr<std::promise<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>>> pipeline_promise = std::make_shared<std::promise<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>>>();
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>> pipeline_future = pipeline_promise->get_future().share();
+    WorkerPool::TaskHandle create_task = this->workerPool.Schedule(
+        [this, device, lookups, defines, creator = std::move(creator), pipeline_promise]() {
+            PipelineJobGuard job_guard([this]() { this->EndJob(); });
+            TRACE_ZONE("BuildGraphicsPipeline");
+
+            try
+            {
+                ShaderLookup &vertex_lookup = (*lookups)[0];
+                ShaderLookup &fragment_lookup = (*lookups)[1];
+                Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> vertex_shader = CreateShader<Turbo::Core::TVertexShader>(device, vertex_lookup, [&]() { return this->shaderCache.CreateVertexShader(device, vertex_lookup.name, vertex_lookup.code, defines); });
+                Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> fragment_shader = CreateShader<Turbo::Core::TFragmentShader>(device, fragment_lookup, [&]() { return this->shaderCache.CreateFragmentShader(device, fragment_lookup.name, fragment_lookup.code, defines); });
+                pipeline_promise->set_value(creator(vertex_shader, fragment_shader));
+            }
+            catch (...)
+            {
+                pipeline_promise->set_exception(std::current_exception());
+            }
+        },
+        {spirv_task}, TaskAffinity::MAIN_THREAD);
+
+    this->BeginJob(create_task);
+    return pipeline_future;
+}
+
+std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> PipelineBuilder::BuildComputePipeline(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &computeShaderName, const std::string &computeShaderCode, ComputePipelineCreator &&creator, const std::vector<std::string> &defines)
+{
+    std::shared_ptr<std::vector<ShaderLookup>> lookups = std::make_shared<std::vector<ShaderLookup>>(1);
+    (*lookups)[0].name = computeShaderName;
+    (*lookups)[0].code = computeShaderCode;
+    (*lookups)[0].type = Turbo::Core::TShaderType::COMPUTE;
+
+    WorkerPool::TaskHandle spirv_task = this->workerPool.Schedule([this, lookups, defines]() {
+        TRACE_ZONE("BuildPipelineSpirV");
+        GetSpirVs(this->shaderCache, *lookups, defines);
+        this->condition.notify_all();
+    });
+
+    std::shared_ptr<std::promise<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>>> pipeline_promise = std::make_shared<std::promise<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>>>();
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> pipeline_future = pipeline_promise->get_future().share();
+    WorkerPool::TaskHandle create_task = this->workerPool.Schedule(
+        [this, device, lookups, defines, creator = std::move(creator), pipeline_promise]() {
+            PipelineJobGuard job_guard([this]() { this->EndJob(); });
+            TRACE_ZONE("BuildComputePipeline");
+
+            try
+            {
+                ShaderLookup &compute_lookup = (*lookups)[0];
+                Turbo::Core::TRefPtr<Turbo::Core::TComputeShader> compute_shader = CreateShader<Turbo::Core::TComputeShader>(device, compute_lookup, [&]() { return this->shaderCache.CreateComputeShader(device, compute_lookup.name, compute_lookup.code, defines); });
+                pipeline_promise->set_value(creator(compute_shader));
+            }
+            catch (...)
+            {
+                pipeline_promise->set_exception(std::current_exception());
+            }
+        },
+        {spirv_task}, TaskAffinity::MAIN_THREAD);
+
+    this->BeginJob(create_task);
+    return pipeline_future;
+}
+
+bool PipelineBuilder::IsReady()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->pendingCount == 0;
+}
+
+void PipelineBuilder::Wait()
+{
+    // WorkerPool::Wait() runs the main thread tasks while it waits
+    std::vector<WorkerPool::TaskHandle> job_tasks;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        job_tasks.swap(this->jobTasks);
+    }
+    for (const WorkerPool::TaskHandle &job_task_item : job_tasks)
+    {
+        this->workerPool.Wait(job_task_item);
+    }
+}
+
+bool PipelineBuilder::WaitFor(std::chrono::milliseconds timeout)
+{
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + timeout;
+    while (true)
+    {
+        this->workerPool.RunMainThreadTasks();
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        if (this->pendingCount == 0)
+        {
+            this->jobTasks.clear();
+            return true;
+        }
+
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            return false;
+        }
+        // a finished worker task notifies, the poll interval only covers a notify before this wait
+        this->condition.wait_until(lock, std::min(deadline, now + MAIN_THREAD_POLL_INTERVAL));
+    }
+}
+
+uint32_t PipelineBuilder::GetJobCount() const
+{
+    return this->jobCount;
+}
+
+uint32_t PipelineBuilder::GetPendingCount()
+{
+    std::lock_guard<std::mutex> lock(this->mutex);
+    return this->pendingCount;
+}
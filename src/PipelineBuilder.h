@@ -0,0 +1,69 @@
+#pragma once
+#ifndef POINTCLOUD_PIPELINEBUILDER_H
+#define POINTCLOUD_PIPELINEBUILDER_H
+#include "WorkerPool.h"
+
+#include "../core/include/TComputePipeline.h"
+#include "../core/include/TDevice.h"
+#include "../core/include/TGraphicsPipeline.h"
+#include "../core/include/TShader.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class ShaderCache;
+
+// Get the SPIR-V of each job on the worker pool (a ShaderCache hit, or a compile by ShaderCache::CompileSpirV() on a miss),
+// then wrap it into the shaders and create the pipeline on the main thread.
+// The creator callback receives the shaders and builds the pipeline, pass the shared TPipelineCache in there.
+// NOTE: The Turbo objects are not thread safe and the shared TPipelineCache must be externally synchronized, so the worker tasks only produce SPIR-V
+// (no Turbo object, not even the device) and the shaders, the pipeline and the futures are made by TaskAffinity::MAIN_THREAD tasks.
+// vkCreate*Pipelines therefore still runs on the main thread, only a shader glslangValidator could not compile is compiled there.
+// Those tasks run inside Wait()/WaitFor() or WorkerPool::RunMainThreadTasks(), call them from the thread which created the WorkerPool.
+class PipelineBuilder
+{
+  public:
+    typedef std::function<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>(const Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> &, const Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> &)> GraphicsPipelineCreator;
+    typedef std::function<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>(const Turbo::Core::TRefPtr<Turbo::Core::TComputeShader> &)> ComputePipelineCreator;
+
+  private:
+    WorkerPool &workerPool;
+    ShaderCache &shaderCache;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    uint32_t pendingCount = 0;
+    uint32_t jobCount = 0;
+    std::vector<WorkerPool::TaskHandle> jobTasks; // the main thread task of each pending job
+
+  private:
+    void BeginJob(const WorkerPool::TaskHandle &jobTask);
+    void EndJob();
+
+  public:
+    PipelineBuilder(WorkerPool &workerPool, ShaderCache &shaderCache);
+    ~PipelineBuilder(); // wait all the jobs
+
+    PipelineBuilder(const PipelineBuilder &) = delete;
+    PipelineBuilder &operator=(const PipelineBuilder &) = delete;
+
+  public:
+    // The returned future rethrows the Turbo::Core::TException of a failed compile or pipeline creation on get()
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline>> BuildGraphicsPipeline(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &vertexShaderName, const std::string &vertexShaderCode, const std::string &fragmentShaderName, const std::string &fragmentShaderCode, GraphicsPipelineCreator &&creator, const std::vector<std::string> &defines = {});
+    std::shared_future<Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline>> BuildComputePipeline(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &computeShaderName, const std::string &computeShaderCode, ComputePipelineCreator &&creator, const std::vector<std::string> &defines = {});
+
+    bool IsReady();
+    void Wait();
+    bool WaitFor(std::chrono::milliseconds timeout); // return true if every job finished, the main thread tasks ready meanwhile run
+
+    uint32_t GetJobCount() const; // all the jobs ever submitted
+    uint32_t GetPendingCount();   // the jobs not finished yet
+};
+
+#endif // !POINTCLOUD_PIPELINEBUILDER_H
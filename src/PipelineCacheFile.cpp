@@ -0,0 +1,89 @@
+#include "PipelineCacheFile.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+
+bool IsPipelineCacheCompatible(const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physicalDevice, const void *data, size_t size)
+{
+    VkPipelineCacheHeaderVersionOne header = {};
+    if (data == nullptr || size < sizeof(header))
+    {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+
+    if (header.headerSize < sizeof(header) || header.headerSize > size || header.headerVersion != VK_PIPELINE_CACHE_HEADER_VERSION_ONE)
+    {
+        return false;
+    }
+
+    if (header.vendorID != physicalDevice->GetVendor().GetVendorID() || header.deviceID != physicalDevice->GetPhysicalDeviceID())
+    {
+        return false;
+    }
+
+    Turbo::Core::TPipelineCacheUUID uuid = physicalDevice->GetDevicePiplineCacheUUID();
+    return memcmp(header.pipelineCacheUUID, uuid.uuid, TURBO_UUID_SIZE) == 0;
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> LoadPipelineCache(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &path, bool *isWarm)
+{
+    if (isWarm != nullptr)
+    {
+        *isWarm = false;
+    }
+
+    std::ifstream file_stream(path, std::ios::binary);
+    if (file_stream.is_open())
+    {
+        std::vector<char> data((std::istreambuf_iterator<char>(file_stream)), std::istreambuf_iterator<char>());
+        if (IsPipelineCacheCompatible(device->GetPhysicalDevice(), data.data(), data.size()))
+        {
+            if (isWarm != nullptr)
+            {
+                *isWarm = true;
+            }
+            return new Turbo::Core::TPipelineCache(device, data.size(), data.data());
+        }
+
+        std::cerr << "Pipeline cache " << path << " was written by another device or driver, ignored." << std::endl;
+    }
+
+    return new Turbo::Core::TPipelineCache(device);
+}
+
+bool SavePipelineCache(const Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> &pipelineCache, const std::string &path)
+{
+    size_t size = pipelineCache->GetSize();
+    if (size == 0)
+    {
+        return false;
+    }
+
+    std::vector<char> data(size);
+    if (pipelineCache->GetData(size, data.data()) != Turbo::Core::TResult::SUCCESS)
+    {
+        return false;
+    }
+
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream file_stream(temp_path, std::ios::binary | std::ios::trunc);
+        if (!file_stream.is_open())
+        {
+            return false;
+        }
+        file_stream.write(data.data(), data.size());
+        if (!file_stream.good())
+        {
+            return false;
+        }
+    }
+
+    std::remove(path.c_str());
+    return std::rename(temp_path.c_str(), path.c_str()) == 0;
+}
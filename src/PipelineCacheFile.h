@@ -0,0 +1,20 @@
+#pragma once
+#ifndef POINTCLOUD_PIPELINECACHEFILE_H
+#define POINTCLOUD_PIPELINECACHEFILE_H
+#include "../core/include/TDevice.h"
+#include "../core/include/TPhysicalDevice.h"
+#include "../core/include/TPipelineCache.h"
+
+#include <string>
+
+// Check the VkPipelineCacheHeaderVersionOne at the front of a pipeline cache blob against the physical device (vendor ID, device ID and pipeline cache UUID).
+// NOTE: parse the raw blob instead of TPipelineCache::GetHeaderSize()/GetVendor()/..., see the FIXME in TPipelineCache.h
+bool IsPipelineCacheCompatible(const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physicalDevice, const void *data, size_t size);
+
+// Create a TPipelineCache from path if the file exists and is compatible, otherwise an empty one. isWarm reports which one it was.
+Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> LoadPipelineCache(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &path, bool *isWarm = nullptr);
+
+// Write the whole cache data into path, through a temporary file so a crash never leaves a truncated cache behind
+bool SavePipelineCache(const Turbo::Core::TRefPtr<Turbo::Core::TPipelineCache> &pipelineCache, const std::string &path);
+
+#endif // !POINTCLOUD_PIPELINECACHEFILE_H
@@ -0,0 +1,94 @@
+#include "PlyLoader.h"
+#include "Trace.h"
+
+#include <ply.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <iostream>
+
+PlyData LoadPly(const std::string &url)
+{
+    TRACE_ZONE("LoadPly");
+    PlyData plyData;
+    plyData.min = { FLT_MAX, FLT_MAX, FLT_MAX, 0 };
+    plyData.max = { -FLT_MAX, -FLT_MAX, -FLT_MAX, 0 };
+
+    int elementsCount = 0;
+    char **elements;
+    int fileType;
+    float version;
+
+    PlyFile *plyFile = ply_open_for_reading(const_cast<char *>(url.c_str()), &elementsCount, &elements, &fileType, &version);
+    if (plyFile)
+    {
+        for (int elemIdx = 0; elemIdx < elementsCount; ++elemIdx)
+        {
+            if (equal_strings("vertex", elements[elemIdx]))
+            {
+                int numElems = 0;
+                int numProps = 0;
+
+                PlyProperty **propList = ply_get_element_description(plyFile, elements[elemIdx], &numElems, &numProps);
+                struct PlyVertex
+                {
+                    float x, y, z;
+                    unsigned char r, g, b, a;
+                };
+
+                PlyProperty vertProps[] = {
+                    {"x", PLY_FLOAT, PLY_FLOAT, offsetof(PlyVertex, x), 0, 0, 0, 0},
+                    {"y", PLY_FLOAT, PLY_FLOAT, offsetof(PlyVertex, y), 0, 0, 0, 0},
+                    {"z", PLY_FLOAT, PLY_FLOAT, offsetof(PlyVertex, z), 0, 0, 0, 0},
+                    {"red", PLY_UCHAR, PLY_UCHAR, offsetof(PlyVertex, r), 0, 0, 0, 0},
+                    {"green", PLY_UCHAR, PLY_UCHAR, offsetof(PlyVertex, g), 0, 0, 0, 0},
+                    {"blue", PLY_UCHAR, PLY_UCHAR, offsetof(PlyVertex, b), 0, 0, 0, 0},
+                    {"alpha", PLY_UCHAR, PLY_UCHAR, offsetof(PlyVertex, a), 0, 0, 0, 0},
+                };
+
+                for (PlyProperty &prop : vertProps)
+                {
+                    ply_get_property(plyFile, elements[elemIdx], &prop);
+                }
+
+                for (int i = 0; i < numElems; ++i)
+                {
+                    PlyVertex vertex;
+                    ply_get_element(plyFile, &vertex);
+
+                    Point point;
+                    point.position = { vertex.x, vertex.y, vertex.z, 0.0f };
+                    point.color = { vertex.r / 255.0f, vertex.g / 255.0f, vertex.b / 255.0f, vertex.a / 255.0f };
+
+                    plyData.points.push_back(point);
+
+                    plyData.min.x = std::min(plyData.min.x, point.position.x);
+                    plyData.min.y = std::min(plyData.min.y, point.position.y);
+                    plyData.min.z = std::min(plyData.min.z, point.position.z);
+
+                    plyData.max.x = std::max(plyData.max.x, point.position.x);
+                    plyData.max.y = std::max(plyData.max.y, point.position.y);
+                    plyData.max.z = std::max(plyData.max.z, point.position.z);
+                }
+            }
+        }
+        ply_close(plyFile);
+    }
+    else
+    {
+        std::cerr << "Failed to open ply file." << std::endl;
+    }
+
+    return plyData;
+}
+
+std::vector<Point> PlyDatasToPoints(const std::vector<PlyData> &plyDatas)
+{
+    TRACE_ZONE("PlyDatasToPoints");
+    std::vector<Point> points;
+    for (const PlyData &plyData : plyDatas)
+    {
+        points.insert(points.end(), plyData.points.begin(), plyData.points.end());
+    }
+    return points;
+}
@@ -0,0 +1,16 @@
+#pragma once
+#ifndef POINTCLOUD_PLYLOADER_H
+#define POINTCLOUD_PLYLOADER_H
+#include "PointCloudData.h"
+
+#include <string>
+#include <vector>
+
+// Read x, y, z, red, green, blue and alpha of the vertex element of an ASCII or binary PLY file through ply/plyfile.cpp.
+// Return an empty PlyData if the file can not be opened.
+PlyData LoadPly(const std::string &url);
+
+// Concatenate the points of every PlyData
+std::vector<Point> PlyDatasToPoints(const std::vector<PlyData> &plyDatas);
+
+#endif // !POINTCLOUD_PLYLOADER_H
@@ -0,0 +1,83 @@
+#pragma once
+#ifndef POINTCLOUD_POINTCLOUDDATA_H
+#define POINTCLOUD_POINTCLOUDDATA_H
+#include "../core/include/TBuffer.h"
+#include "../core/include/TImage.h"
+#include "../core/include/TImageView.h"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+typedef struct POSITION
+{
+    float x, y, z, w;
+} POSITION;
+
+typedef struct COLOR
+{
+    float r, g, b, a;
+} COLOR;
+
+typedef struct Point
+{
+    POSITION position;
+    COLOR color;
+} Point;
+
+// uniform buffer of the points pipeline, set = 0 binding = 0
+struct MATRIXS_BUFFER_DATA
+{
+    glm::mat4 m, v, p;
+    // instance i draws point i * pointStride + pointOffset of the chunk, progressive accumulation draws a slice per frame
+    uint32_t pointStride = 1;
+    uint32_t pointOffset = 0;
+    uint32_t padding[2] = {0, 0};
+};
+
+typedef struct PlyData
+{
+    std::vector<Point> points;
+    POSITION min, max;
+} PlyData;
+
+typedef enum class PointsStorageType
+{
+    IMAGE,  // staging buffer -> CmdCopyBufferToImage -> rgba32f storage image
+    BUFFER, // packed straight into a mapped device local storage buffer
+} PointsStorageType;
+
+typedef struct PointsPositionImage
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> image;
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> imageView;
+} PointsPositionImage;
+
+typedef struct PointsColorImage
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> image;
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> imageView;
+} PointsColorImage;
+
+typedef struct PointsBuffer
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> positionBuffer;
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> colorBuffer;
+} PointsBuffer;
+
+typedef struct PointsBounds
+{
+    POSITION min, max;
+    POSITION centre; // of min and max, the front to back draw order key
+} PointsBounds;
+
+typedef struct PointsChunkData
+{
+    PointsPositionImage pointsPositionImage; // PointsStorageType::IMAGE
+    PointsColorImage pointsColorImage;       // PointsStorageType::IMAGE
+    PointsBuffer pointsBuffer;               // PointsStorageType::BUFFER
+    PointsBounds bounds;
+    uint32_t count = 0;
+} PointsChunkData;
+
+#endif // !POINTCLOUD_POINTCLOUDDATA_H
@@ -0,0 +1,202 @@
+#include "PointCloudUpload.h"
+#include "Trace.h"
+#include "WorkerPool.h"
+
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TFence.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <iostream>
+
+PointsBounds PackPointsChunk(const Point *points, size_t count, POSITION *positionDst, COLOR *colorDst)
+{
+    PointsBounds bounds;
+    bounds.min = {FLT_MAX, FLT_MAX, FLT_MAX, 0};
+    bounds.max = {-FLT_MAX, -FLT_MAX, -FLT_MAX, 0};
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const POSITION &position = points[i].position;
+        positionDst[i] = position;
+        colorDst[i] = points[i].color;
+
+        bounds.min.x = std::min(bounds.min.x, position.x);
+        bounds.min.y = std::min(bounds.min.y, position.y);
+        bounds.min.z = std::min(bounds.min.z, position.z);
+
+        bounds.max.x = std::max(bounds.max.x, position.x);
+        bounds.max.y = std::max(bounds.max.y, position.y);
+        bounds.max.z = std::max(bounds.max.z, position.z);
+    }
+
+    bounds.centre = {(bounds.min.x + bounds.max.x) * 0.5f, (bounds.min.y + bounds.max.y) * 0.5f, (bounds.min.z + bounds.max.z) * 0.5f, 0};
+    return bounds;
+}
+
+bool IsSupportDirectWriteUpload(const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physicalDevice, Turbo::Core::TDeviceSize size)
+{
+    for (const Turbo::Core::TMemoryTypeInfo &memory_type_item : physicalDevice->GetMemoryTypes())
+    {
+        // NOTE: discrete GPUs without ReBAR still expose a 256MB DEVICE_LOCAL | HOST_VISIBLE heap, keep staging if the cloud does not fit
+        if (memory_type_item.IsDeviceLocal() && memory_type_item.IsHostVisible() && memory_type_item.GetMemoryHeap().GetByteSize() >= size)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<PointsChunkData> CreateAllPointsImageData(const std::vector<Point> &points, Turbo::Core::TRefPtr<Turbo::Core::TDevice> device, DevicePools &devicePools)
+{
+    TRACE_ZONE("CreateAllPointsImageData");
+    std::vector<PointsChunkData> result;
+    size_t tex_size = TEX_SIZE;
+    size_t tex_content_size = tex_size * tex_size;
+    size_t loop_count = points.size() / tex_content_size;
+    size_t residue_count = points.size() % tex_content_size;
+
+    auto create_points_image_data = [&](const Point *chunkPoints, size_t count) -> PointsChunkData {
+        PointsChunkData imageData;
+        Turbo::Core::TRefPtr<Turbo::Core::TBuffer> positionBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, count * sizeof(POSITION));
+        Turbo::Core::TRefPtr<Turbo::Core::TBuffer> colorBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, count * sizeof(COLOR));
+
+        POSITION *positionPtr = static_cast<POSITION *>(positionBuffer->Map());
+        COLOR *colorPtr = static_cast<COLOR *>(colorBuffer->Map());
+        imageData.bounds = PackPointsChunk(chunkPoints, count, positionPtr, colorPtr);
+        positionBuffer->Unmap();
+        colorBuffer->Unmap();
+
+        Turbo::Core::TRefPtr<Turbo::Core::TImage> positionImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R32G32B32A32_SFLOAT, tex_size, tex_size, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+        Turbo::Core::TRefPtr<Turbo::Core::TImage> colorImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TFormatType::R32G32B32A32_SFLOAT, tex_size, tex_size, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+
+        DevicePools::CommandBuffer pooledCommandBuffer = devicePools.AcquireCommandBuffer();
+        const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer = pooledCommandBuffer->Get();
+        commandBuffer->Begin();
+
+        commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::HOST_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TAccessBits::HOST_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, positionImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+        commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::HOST_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TAccessBits::HOST_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, colorImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+        size_t rowCount = count / tex_size;
+        size_t remainingPoints = count % tex_size;
+
+        commandBuffer->CmdCopyBufferToImage(positionBuffer, positionImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, 0, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, tex_size, rowCount, 1);
+        commandBuffer->CmdCopyBufferToImage(colorBuffer, colorImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, 0, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, tex_size, rowCount, 1);
+
+        if (remainingPoints > 0)
+        {
+            commandBuffer->CmdCopyBufferToImage(positionBuffer, positionImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, rowCount * tex_size * sizeof(POSITION), 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, rowCount, 0, remainingPoints, 1, 1);
+            commandBuffer->CmdCopyBufferToImage(colorBuffer, colorImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, rowCount * tex_size * sizeof(COLOR), 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, rowCount, 0, remainingPoints, 1, 1);
+        }
+
+        commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::FRAGMENT_SHADER_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, Turbo::Core::TImageLayout::GENERAL, positionImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+        commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::FRAGMENT_SHADER_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, Turbo::Core::TImageLayout::GENERAL, colorImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+        commandBuffer->End();
+
+        DevicePools::Fence fence = devicePools.AcquireFence();
+        devicePools.GetQueue()->Submit(commandBuffer, fence->Get());
+        fence->Get()->WaitUntil();
+
+        Turbo::Core::TRefPtr<Turbo::Core::TImageView> positionImageView = new Turbo::Core::TImageView(positionImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, positionImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+        Turbo::Core::TRefPtr<Turbo::Core::TImageView> colorImageView = new Turbo::Core::TImageView(colorImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, colorImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+        imageData.pointsPositionImage.image = positionImage;
+        imageData.pointsPositionImage.imageView = positionImageView;
+        imageData.pointsColorImage.image = colorImage;
+        imageData.pointsColorImage.imageView = colorImageView;
+        imageData.count = count;
+
+        return imageData;
+    };
+
+    for (size_t loopIndex = 0; loopIndex < loop_count; ++loopIndex)
+    {
+        result.push_back(create_points_image_data(points.data() + loopIndex * tex_content_size, tex_content_size));
+    }
+
+    if (residue_count > 0)
+    {
+        result.push_back(create_points_image_data(points.data() + loop_count * tex_content_size, residue_count));
+    }
+
+    return result;
+}
+
+std::vector<PointsChunkData> CreateAllPointsBufferData(const std::vector<Point> &points, Turbo::Core::TRefPtr<Turbo::Core::TDevice> device, WorkerPool &workerPool)
+{
+    TRACE_ZONE("CreateAllPointsBufferData");
+    size_t chunk_content_size = TEX_SIZE * TEX_SIZE;
+    size_t chunk_count = (points.size() + chunk_content_size - 1) / chunk_content_size;
+
+    std::vector<PointsChunkData> result(chunk_count);
+    std::vector<POSITION *> position_ptrs(chunk_count, nullptr);
+    std::vector<COLOR *> color_ptrs(chunk_count, nullptr);
+    std::vector<PointsBounds> bounds(chunk_count);
+
+    // Buffer creation and Map() stay on this thread, workers only ever see raw pointers
+    for (size_t chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    {
+        size_t count = std::min(chunk_content_size, points.size() - chunk_index * chunk_content_size);
+
+        PointsChunkData &chunk = result[chunk_index];
+        chunk.pointsBuffer.positionBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, Turbo::Core::TMemoryFlagsBits::MAPPED | Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, count * sizeof(POSITION));
+        chunk.pointsBuffer.colorBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, Turbo::Core::TMemoryFlagsBits::MAPPED | Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, count * sizeof(COLOR));
+        chunk.count = count;
+
+        position_ptrs[chunk_index] = static_cast<POSITION *>(chunk.pointsBuffer.positionBuffer->Map());
+        color_ptrs[chunk_index] = static_cast<COLOR *>(chunk.pointsBuffer.colorBuffer->Map());
+    }
+
+    if (chunk_count > 0 && !result[0].pointsBuffer.positionBuffer->GetMemoryTypeInfo().IsDeviceLocal())
+    {
+        // still correct, the vertex shader just reads through the host memory
+        std::cerr << "Direct write upload: allocator did not place the points buffers in device local memory." << std::endl;
+    }
+
+    workerPool.ParallelFor(chunk_count, [&](size_t begin, size_t end) {
+        TRACE_ZONE("PackPointsChunks");
+        for (size_t chunk_index = begin; chunk_index < end; chunk_index++)
+        {
+            bounds[chunk_index] = PackPointsChunk(points.data() + chunk_index * chunk_content_size, result[chunk_index].count, position_ptrs[chunk_index], color_ptrs[chunk_index]);
+        }
+    });
+
+    for (size_t chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    {
+        PointsChunkData &chunk = result[chunk_index];
+        chunk.bounds = bounds[chunk_index];
+
+        // Flush is a no-op on HOST_COHERENT memory
+        chunk.pointsBuffer.positionBuffer->Flush();
+        chunk.pointsBuffer.colorBuffer->Flush();
+        chunk.pointsBuffer.positionBuffer->Unmap();
+        chunk.pointsBuffer.colorBuffer->Unmap();
+    }
+
+    return result;
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> CreatePointsDescriptorSet(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const Turbo::Core::TRefPtr<Turbo::Core::TPipelineLayout> &pipelineLayout, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &matrixsBuffer, const PointsChunkData &pointsChunkData, PointsStorageType storageType)
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> pipeline_descriptor_set = descriptorPool->Allocate(pipelineLayout);
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TBuffer>> matrixs_buffers = {matrixsBuffer};
+
+    pipeline_descriptor_set->BindData(0, 0, 0, matrixs_buffers);
+    if (storageType == PointsStorageType::BUFFER)
+    {
+        pipeline_descriptor_set->BindData(0, 1, pointsChunkData.pointsBuffer.positionBuffer);
+        pipeline_descriptor_set->BindData(0, 2, pointsChunkData.pointsBuffer.colorBuffer);
+    }
+    else
+    {
+        std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> points_pos_image_views = {pointsChunkData.pointsPositionImage.imageView};
+        std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> points_color_image_views = {pointsChunkData.pointsColorImage.imageView};
+        pipeline_descriptor_set->BindData(0, 1, 0, points_pos_image_views);
+        pipeline_descriptor_set->BindData(0, 2, 0, points_color_image_views);
+    }
+
+    return pipeline_descriptor_set;
+}
@@ -0,0 +1,35 @@
+#pragma once
+#ifndef POINTCLOUD_POINTCLOUDUPLOAD_H
+#define POINTCLOUD_POINTCLOUDUPLOAD_H
+#include "DevicePools.h"
+#include "PointCloudData.h"
+
+#include "../core/include/TCommandBufferPool.h"
+#include "../core/include/TDescriptorPool.h"
+#include "../core/include/TDevice.h"
+#include "../core/include/TDeviceQueue.h"
+#include "../core/include/TPhysicalDevice.h"
+#include "../core/include/TPipelineDescriptorSet.h"
+#include "../core/include/TPipelineLayout.h"
+
+#define TEX_SIZE 512
+
+class WorkerPool;
+
+// Write position and color of count points into the destination arrays and return their bounds
+PointsBounds PackPointsChunk(const Point *points, size_t count, POSITION *positionDst, COLOR *colorDst);
+
+// true if the physical device has a memory type which is device local and host visible with a heap large enough for size bytes (UMA, ReBAR, software devices)
+bool IsSupportDirectWriteUpload(const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physicalDevice, Turbo::Core::TDeviceSize size);
+
+// PointsStorageType::IMAGE: staging buffer, copy command and a fence wait per chunk, on the queue of devicePools.
+// The command buffer and the fence of a chunk go back to devicePools, the next chunk reuses them
+std::vector<PointsChunkData> CreateAllPointsImageData(const std::vector<Point> &points, Turbo::Core::TRefPtr<Turbo::Core::TDevice> device, DevicePools &devicePools);
+
+// PointsStorageType::BUFFER: workers pack every chunk directly into its mapped storage buffer, no staging copy and no queue submission
+std::vector<PointsChunkData> CreateAllPointsBufferData(const std::vector<Point> &points, Turbo::Core::TRefPtr<Turbo::Core::TDevice> device, WorkerPool &workerPool);
+
+// set = 0 of the points pipeline: binding 0 the MATRIXS_BUFFER_DATA uniform buffer, binding 1/2 position and color of the chunk
+Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> CreatePointsDescriptorSet(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const Turbo::Core::TRefPtr<Turbo::Core::TPipelineLayout> &pipelineLayout, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &matrixsBuffer, const PointsChunkData &pointsChunkData, PointsStorageType storageType);
+
+#endif // !POINTCLOUD_POINTCLOUDUPLOAD_H
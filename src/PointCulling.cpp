@@ -0,0 +1,174 @@
+#include "PointCulling.h"
+#include "ComputePrimitives.h"
+
+#include "../core/include/TBarrier.h"
+#include "../core/include/TVulkanLoader.h"
+
+#include <algorithm>
+
+constexpr uint32_t PointCulling::MAX_CLIP_PLANE_COUNT;
+
+namespace
+{
+// push_constant POINT_CULL_CONSTANTS of PointCull.comp
+typedef struct PointCullConstants
+{
+    glm::vec4 clipPlanes[PointCulling::MAX_CLIP_PLANE_COUNT];
+    uint32_t clipPlaneCount;
+    uint32_t pointCount;
+    uint32_t firstIndex;
+    uint32_t chunkIndex;
+} PointCullConstants;
+
+const uint32_t POINT_CULL_GROUP_SIZE = 256; // local_size_x of PointCull.comp
+} // namespace
+
+bool PointCulling::IsSupported(const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physicalDevice)
+{
+    return ComputePrimitives::IsSubgroupSupported(physicalDevice);
+}
+
+PointCulling::PointCulling(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &cullPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &matrixsBuffer, const std::vector<PointsChunkData> &pointsChunkDatas, PointsStorageType storageType)
+    : descriptorPool(descriptorPool), cullPipeline(cullPipeline)
+{
+    const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device = cullPipeline->GetDevice();
+
+    for (const PointsChunkData &points_chunk_data_item : pointsChunkDatas)
+    {
+        this->pointCounts.push_back(points_chunk_data_item.count);
+        this->firstIndices.push_back(this->pointCount);
+        this->pointCount += points_chunk_data_item.count;
+    }
+    size_t chunk_count = std::max<size_t>(1, pointsChunkDatas.size()); // no zero sized buffers
+    this->drawCommandsSize = chunk_count * sizeof(VkDrawIndexedIndirectCommand);
+
+    this->pointIndicesBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_INDEX_BUFFER, 0, std::max<size_t>(1, this->pointCount) * sizeof(uint32_t));
+    this->drawCommandsBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_INDIRECT_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_DST, 0, this->drawCommandsSize);
+    this->drawCommandsReadbackBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_DST, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_RANDOM, this->drawCommandsSize);
+
+    this->drawCommandsResetBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, this->drawCommandsSize);
+    VkDrawIndexedIndirectCommand *draw_commands_ptr = static_cast<VkDrawIndexedIndirectCommand *>(this->drawCommandsResetBuffer->Map());
+    for (size_t chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    {
+        draw_commands_ptr[chunk_index] = {0, 1, chunk_index < this->firstIndices.size() ? this->firstIndices[chunk_index] : 0, 0, 0};
+    }
+    this->drawCommandsResetBuffer->Unmap();
+
+    for (const PointsChunkData &points_chunk_data_item : pointsChunkDatas)
+    {
+        Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> descriptor_set = this->descriptorPool->Allocate(this->cullPipeline->GetPipelineLayout());
+        std::vector<Turbo::Core::TRefPtr<Turbo::Core::TBuffer>> matrixs_buffers = {matrixsBuffer};
+        descriptor_set->BindData(0, 0, 0, matrixs_buffers);
+        if (storageType == PointsStorageType::BUFFER)
+        {
+            descriptor_set->BindData(0, 1, points_chunk_data_item.pointsBuffer.positionBuffer);
+        }
+        else
+        {
+            std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> points_pos_image_views = {points_chunk_data_item.pointsPositionImage.imageView};
+            descriptor_set->BindData(0, 1, 0, points_pos_image_views);
+        }
+        descriptor_set->BindData(0, 2, this->pointIndicesBuffer);
+        descriptor_set->BindData(0, 3, this->drawCommandsBuffer);
+        this->descriptorSets.push_back(descriptor_set);
+    }
+}
+
+PointCulling::~PointCulling()
+{
+    for (Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet> &descriptor_set_item : this->descriptorSets)
+    {
+        this->descriptorPool->Free(descriptor_set_item);
+    }
+    this->descriptorSets.clear();
+}
+
+void PointCulling::SetClipPlanes(const std::vector<glm::vec4> &clipPlanes)
+{
+    this->clipPlanes.assign(clipPlanes.begin(), clipPlanes.begin() + std::min<size_t>(clipPlanes.size(), MAX_CLIP_PLANE_COUNT));
+}
+
+const std::vector<glm::vec4> &PointCulling::GetClipPlanes() const
+{
+    return this->clipPlanes;
+}
+
+void PointCulling::CmdCull(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    // last frame read the draws and the indices, the fence waited for it
+    commandBuffer->CmdCopyBuffer(this->drawCommandsResetBuffer, this->drawCommandsBuffer, 0, 0, this->drawCommandsSize);
+    Turbo::Core::TMemoryBarrier reset_barrier(Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT | Turbo::Core::TAccessBits::SHADER_WRITE_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, reset_barrier);
+
+    PointCullConstants point_cull_constants = {};
+    for (size_t plane_index = 0; plane_index < this->clipPlanes.size(); plane_index++)
+    {
+        point_cull_constants.clipPlanes[plane_index] = this->clipPlanes[plane_index];
+    }
+    point_cull_constants.clipPlaneCount = static_cast<uint32_t>(this->clipPlanes.size());
+
+    commandBuffer->CmdBindPipeline(this->cullPipeline);
+    for (uint32_t chunk_index = 0; chunk_index < this->descriptorSets.size(); chunk_index++)
+    {
+        if (this->pointCounts[chunk_index] == 0)
+        {
+            continue;
+        }
+
+        point_cull_constants.pointCount = this->pointCounts[chunk_index];
+        point_cull_constants.firstIndex = this->firstIndices[chunk_index];
+        point_cull_constants.chunkIndex = chunk_index;
+        commandBuffer->CmdBindPipelineDescriptorSet(this->descriptorSets[chunk_index]);
+        commandBuffer->CmdPushConstants(0, sizeof(point_cull_constants), &point_cull_constants);
+        commandBuffer->CmdDispatch((this->pointCounts[chunk_index] + POINT_CULL_GROUP_SIZE - 1) / POINT_CULL_GROUP_SIZE, 1, 1);
+    }
+
+    Turbo::Core::TMemoryBarrier cull_barrier(Turbo::Core::TAccessBits::SHADER_WRITE_BIT, Turbo::Core::TAccessBits::INDIRECT_COMMAND_READ_BIT | Turbo::Core::TAccessBits::INDEX_READ_BIT | Turbo::Core::TAccessBits::TRANSFER_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COMPUTE_SHADER_BIT, Turbo::Core::TPipelineStageBits::DRAW_INDIRECT_BIT | Turbo::Core::TPipelineStageBits::VERTEX_INPUT_BIT | Turbo::Core::TPipelineStageBits::TRANSFER_BIT, cull_barrier);
+
+    commandBuffer->CmdCopyBuffer(this->drawCommandsBuffer, this->drawCommandsReadbackBuffer, 0, 0, this->drawCommandsSize);
+    Turbo::Core::TMemoryBarrier readback_barrier(Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::HOST_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::HOST_BIT, readback_barrier);
+}
+
+void PointCulling::CmdDraw(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> &descriptorSets, const std::vector<uint32_t> &chunkOrder)
+{
+    const Turbo::Core::TDeviceDriver *device_driver = this->cullPipeline->GetDevice()->GetDeviceDriver();
+    VkCommandBuffer vk_command_buffer = commandBuffer->GetVkCommandBuffer();
+    VkBuffer vk_draw_commands_buffer = this->drawCommandsBuffer->GetVkBuffer();
+
+    commandBuffer->CmdBindIndexBuffer(this->pointIndicesBuffer, 0, Turbo::Core::TIndexType::UINT32);
+    // Turbo::Core::TCommandBuffer::CmdDrawIndexedIndirect() takes no arguments yet
+    for (uint32_t chunk_index : chunkOrder)
+    {
+        if (this->pointCounts[chunk_index] == 0)
+        {
+            continue;
+        }
+
+        commandBuffer->CmdBindPipelineDescriptorSet(descriptorSets[chunk_index]);
+        device_driver->vkCmdDrawIndexedIndirect(vk_command_buffer, vk_draw_commands_buffer, chunk_index * sizeof(VkDrawIndexedIndirectCommand), 1, sizeof(VkDrawIndexedIndirectCommand));
+    }
+}
+
+void PointCulling::Update()
+{
+    // HOST_ACCESS_RANDOM memory is host cached and coherent on desktop and software devices
+    const VkDrawIndexedIndirectCommand *draw_commands_ptr = static_cast<const VkDrawIndexedIndirectCommand *>(this->drawCommandsReadbackBuffer->Map());
+    this->visiblePointCount = 0;
+    for (size_t chunk_index = 0; chunk_index < this->pointCounts.size(); chunk_index++)
+    {
+        this->visiblePointCount += draw_commands_ptr[chunk_index].indexCount;
+    }
+    this->drawCommandsReadbackBuffer->Unmap();
+}
+
+uint32_t PointCulling::GetPointCount() const
+{
+    return this->pointCount;
+}
+
+uint32_t PointCulling::GetVisiblePointCount() const
+{
+    return this->visiblePointCount;
+}
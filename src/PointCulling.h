@@ -0,0 +1,75 @@
+#pragma once
+#ifndef POINTCLOUD_POINTCULLING_H
+#define POINTCLOUD_POINTCULLING_H
+#include "PointCloudData.h"
+
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TComputePipeline.h"
+#include "../core/include/TDescriptorPool.h"
+#include "../core/include/TPhysicalDevice.h"
+#include "../core/include/TPipelineDescriptorSet.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Per point culling: CmdCull() runs PointCull.comp over every point of every chunk, the points inside the frustum and the
+// user clip planes are compacted into one index buffer, chunk after chunk, and counted into the indexed indirect draw of
+// their chunk. CmdDraw() draws those with the points pipeline built with POINTS_INDEXED, which reads the point index from
+// gl_VertexIndex. A close view of a large chunk then runs the vertex stage for its visible points only.
+// Update() reads the counts back once the frame fence signaled.
+// NOTE: single frame in flight, the index and draw buffers are rewritten by the GPU every frame
+class PointCulling
+{
+  public:
+    static constexpr uint32_t MAX_CLIP_PLANE_COUNT = 4; // clip_planes of PointCull.comp
+
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> descriptorPool;
+    Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> cullPipeline; // PointCull.comp, with POINTS_IMAGE for PointsStorageType::IMAGE
+
+    std::vector<uint32_t> pointCounts;  // by chunk
+    std::vector<uint32_t> firstIndices; // by chunk, in pointIndicesBuffer
+    uint32_t pointCount = 0;
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> pointIndicesBuffer;         // uint32_t per point, the index buffer of CmdDraw()
+    Turbo::Core::TDeviceSize drawCommandsSize = 0;
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> drawCommandsBuffer;         // VkDrawIndexedIndirectCommand per chunk
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> drawCommandsResetBuffer;    // the same with every indexCount 0, copied over it before the cull
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> drawCommandsReadbackBuffer; // copied from it after the cull for Update()
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> descriptorSets; // by chunk
+
+    std::vector<glm::vec4> clipPlanes;
+    uint32_t visiblePointCount = 0;
+
+  public:
+    // Subgroup arithmetic in compute shaders, Vulkan 1.1
+    static bool IsSupported(const Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> &physicalDevice);
+
+    // matrixsBuffer is the MATRIXS_BUFFER_DATA uniform buffer of the points pipeline
+    PointCulling(const Turbo::Core::TRefPtr<Turbo::Core::TDescriptorPool> &descriptorPool, const Turbo::Core::TRefPtr<Turbo::Core::TComputePipeline> &cullPipeline, const Turbo::Core::TRefPtr<Turbo::Core::TBuffer> &matrixsBuffer, const std::vector<PointsChunkData> &pointsChunkDatas, PointsStorageType storageType);
+    ~PointCulling();
+
+    PointCulling(const PointCulling &) = delete;
+    PointCulling &operator=(const PointCulling &) = delete;
+
+  public:
+    // Model space planes (normal, distance), a point is kept where dot(normal, position) + distance >= 0. Only the first MAX_CLIP_PLANE_COUNT are used.
+    void SetClipPlanes(const std::vector<glm::vec4> &clipPlanes);
+    const std::vector<glm::vec4> &GetClipPlanes() const;
+
+    // Outside a render pass, after the uniform buffer was written
+    void CmdCull(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer);
+
+    // Inside the render pass with the POINTS_INDEXED points pipeline bound, descriptorSets are the points descriptor sets of the chunks
+    void CmdDraw(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const std::vector<Turbo::Core::TRefPtr<Turbo::Core::TPipelineDescriptorSet>> &descriptorSets, const std::vector<uint32_t> &chunkOrder);
+
+    // After the fence of the frame which called CmdCull()
+    void Update();
+
+    uint32_t GetPointCount() const;
+    // of the last Update()
+    uint32_t GetVisiblePointCount() const;
+};
+
+#endif // !POINTCLOUD_POINTCULLING_H
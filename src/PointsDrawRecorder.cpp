@@ -0,0 +1,125 @@
+#include "PointsDrawRecorder.h"
+#include "Trace.h"
+#include "WorkerPool.h"
+
+#include "../core/include/TDevice.h"
+#include "../core/include/TPipelineLayout.h"
+#include "../core/include/TVulkanLoader.h"
+
+#include <algorithm>
+#include <chrono>
+#include <future>
+
+PointsDrawRecorder::PointsDrawRecorder(const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &queue, WorkerPool &workerPool) : workerPool(workerPool)
+{
+    for (uint32_t range_index = 0; range_index < PointsDrawRecorder::MAX_RANGE_COUNT; range_index++)
+    {
+        Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> command_buffer_pool = new Turbo::Core::TCommandBufferPool(queue);
+        this->secondaryCommandBuffers.push_back(command_buffer_pool->AllocateSecondary());
+        this->commandBufferPools.push_back(command_buffer_pool);
+    }
+}
+
+PointsDrawRecorder::~PointsDrawRecorder()
+{
+    this->recordedCommandBuffers.clear();
+    for (uint32_t range_index = 0; range_index < PointsDrawRecorder::MAX_RANGE_COUNT; range_index++)
+    {
+        this->commandBufferPools[range_index]->Free(this->secondaryCommandBuffers[range_index]);
+    }
+}
+
+void PointsDrawRecorder::SetRangeCount(uint32_t rangeCount)
+{
+    this->rangeCount = std::max(1u, std::min(rangeCount, PointsDrawRecorder::MAX_RANGE_COUNT));
+}
+
+uint32_t PointsDrawRecorder::GetRangeCount() const
+{
+    return this->rangeCount;
+}
+
+void PointsDrawRecorder::Record(const Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> &renderPass, const Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> &framebuffer, uint32_t subpass, const Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> &pipeline, const Turbo::Core::TViewport &viewport, const Turbo::Core::TScissor &scissor, const std::vector<PointsDrawItem> &drawItems)
+{
+    TRACE_ZONE("RecordPoints");
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+    this->isCached = false;
+
+    size_t range_count = std::max<size_t>(1, std::min<size_t>(this->rangeCount, drawItems.size()));
+    size_t range_size = (drawItems.size() + range_count - 1) / range_count;
+
+    // Begin/Bind keep TRefPtr copies inside the command buffer, which is not thread safe itself, so they stay on this thread.
+    // Workers only receive raw Vulkan handles and go through the device driver.
+    std::vector<VkCommandBuffer> vk_command_buffers;
+    this->recordedCommandBuffers.clear();
+    for (size_t range_index = 0; range_index < range_count; range_index++)
+    {
+        Turbo::Core::TRefPtr<Turbo::Core::TSecondaryCommandBuffer> &secondary_command_buffer = this->secondaryCommandBuffers[range_index];
+        secondary_command_buffer->Reset();
+        secondary_command_buffer->Begin(renderPass, framebuffer, subpass);
+        secondary_command_buffer->CmdBindPipeline(pipeline);
+        secondary_command_buffer->CmdSetViewport({viewport});
+        secondary_command_buffer->CmdSetScissor({scissor});
+
+        vk_command_buffers.push_back(secondary_command_buffer->GetVkCommandBuffer());
+        this->recordedCommandBuffers.push_back(secondary_command_buffer);
+    }
+
+    const Turbo::Core::TDeviceDriver *device_driver = pipeline->GetDevice()->GetDeviceDriver();
+    VkPipelineLayout vk_pipeline_layout = pipeline->GetPipelineLayout()->GetVkPipelineLayout();
+
+    auto record_range = [&](size_t rangeIndex) {
+        TRACE_ZONE("RecordPointsRange");
+        VkCommandBuffer vk_command_buffer = vk_command_buffers[rangeIndex];
+        size_t end = std::min(drawItems.size(), (rangeIndex + 1) * range_size);
+        for (size_t item_index = rangeIndex * range_size; item_index < end; item_index++)
+        {
+            const PointsDrawItem &draw_item = drawItems[item_index];
+            device_driver->vkCmdBindDescriptorSets(vk_command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vk_pipeline_layout, 0, 1, &draw_item.descriptorSet, 0, nullptr);
+            device_driver->vkCmdDraw(vk_command_buffer, 1, draw_item.count, 0, 0);
+        }
+    };
+
+    std::vector<std::future<void>> futures;
+    for (size_t range_index = 1; range_index < range_count; range_index++)
+    {
+        futures.push_back(this->workerPool.Submit([&record_range, range_index]() { record_range(range_index); }));
+    }
+    record_range(0);
+    for (std::future<void> &future_item : futures)
+    {
+        future_item.get();
+    }
+
+    for (Turbo::Core::TRefPtr<Turbo::Core::TSecondaryCommandBuffer> &secondary_command_buffer : this->recordedCommandBuffers)
+    {
+        secondary_command_buffer->End();
+    }
+
+    this->recordTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+bool PointsDrawRecorder::Update(const Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> &renderPass, const Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> &framebuffer, uint32_t subpass, const Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> &pipeline, const Turbo::Core::TViewport &viewport, const Turbo::Core::TScissor &scissor, const std::vector<PointsDrawItem> &drawItems, uint64_t generation)
+{
+    if (this->isCached && this->cachedGeneration == generation && this->cachedRangeCount == this->rangeCount)
+    {
+        this->recordTime = 0;
+        return false;
+    }
+
+    this->Record(renderPass, framebuffer, subpass, pipeline, viewport, scissor, drawItems);
+    this->isCached = true;
+    this->cachedGeneration = generation;
+    this->cachedRangeCount = this->rangeCount;
+    return true;
+}
+
+const std::vector<Turbo::Core::TRefPtr<Turbo::Core::TSecondaryCommandBuffer>> &PointsDrawRecorder::GetCommandBuffers() const
+{
+    return this->recordedCommandBuffers;
+}
+
+double PointsDrawRecorder::GetRecordTime() const
+{
+    return this->recordTime;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef POINTCLOUD_POINTSDRAWRECORDER_H
+#define POINTCLOUD_POINTSDRAWRECORDER_H
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TCommandBufferPool.h"
+#include "../core/include/TDeviceQueue.h"
+#include "../core/include/TFramebuffer.h"
+#include "../core/include/TGraphicsPipeline.h"
+#include "../core/include/TRenderPass.h"
+#include "../core/include/TScissor.h"
+#include "../core/include/TViewport.h"
+
+#include <vector>
+
+class WorkerPool;
+
+typedef struct PointsDrawItem
+{
+    VkDescriptorSet descriptorSet = VK_NULL_HANDLE; // set = 0 of the points pipeline
+    uint32_t count = 0;
+} PointsDrawItem;
+
+// Split the points draws into ranges and record each range into its own secondary command buffer on the worker pool.
+// Every range owns a TCommandBufferPool, so no two threads ever record into the same pool.
+class PointsDrawRecorder
+{
+  public:
+    static constexpr uint32_t MAX_RANGE_COUNT = 8;
+
+  private:
+    WorkerPool &workerPool;
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool>> commandBufferPools;
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TSecondaryCommandBuffer>> secondaryCommandBuffers;
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TSecondaryCommandBuffer>> recordedCommandBuffers;
+
+    uint32_t rangeCount = 1;
+    double recordTime = 0; // second
+
+    bool isCached = false;
+    uint64_t cachedGeneration = 0;
+    uint32_t cachedRangeCount = 0;
+
+  public:
+    PointsDrawRecorder(const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &queue, WorkerPool &workerPool);
+    ~PointsDrawRecorder();
+
+  public:
+    void SetRangeCount(uint32_t rangeCount);
+    uint32_t GetRangeCount() const;
+
+    // NOTE: the secondary command buffers must not be pending execution, the caller waits the previous frame fence first
+    void Record(const Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> &renderPass, const Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> &framebuffer, uint32_t subpass, const Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> &pipeline, const Turbo::Core::TViewport &viewport, const Turbo::Core::TScissor &scissor, const std::vector<PointsDrawItem> &drawItems);
+
+    // Keep the secondary command buffers of the last Update() while generation and range count are unchanged, otherwise Record() again.
+    // The caller bumps generation whenever the visible/resident chunks or the framebuffer (swapchain recreation) change.
+    // Return true if the commands were recorded again.
+    bool Update(const Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> &renderPass, const Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> &framebuffer, uint32_t subpass, const Turbo::Core::TRefPtr<Turbo::Core::TGraphicsPipeline> &pipeline, const Turbo::Core::TViewport &viewport, const Turbo::Core::TScissor &scissor, const std::vector<PointsDrawItem> &drawItems, uint64_t generation);
+
+    // the secondary command buffers filled by the last Record(), execute them with TCommandBuffer::CmdExecuteCommand
+    const std::vector<Turbo::Core::TRefPtr<Turbo::Core::TSecondaryCommandBuffer>> &GetCommandBuffers() const;
+
+    double GetRecordTime() const;
+};
+
+#endif // !POINTCLOUD_POINTSDRAWRECORDER_H
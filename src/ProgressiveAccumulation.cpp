@@ -0,0 +1,117 @@
+#include "ProgressiveAccumulation.h"
+
+#include "../core/include/TAttachment.h"
+#include "../core/include/TBarrier.h"
+
+#include <algorithm>
+
+ProgressiveAccumulation::ProgressiveAccumulation(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, Turbo::Core::TFormatInfo colorFormat, Turbo::Core::TFormatInfo depthFormat, std::vector<Turbo::Core::TSubpass> &subpasses) : colorFormat(colorFormat)
+{
+    // both passes leave the target ready for CmdCopyToImage(), the next slice loads it from there
+    Turbo::Core::TAttachment clear_color_attachment(colorFormat, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_SRC_OPTIMAL);
+    Turbo::Core::TAttachment clear_depth_attachment(depthFormat, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TLoadOp::CLEAR, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+    Turbo::Core::TAttachment load_color_attachment(colorFormat, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TLoadOp::LOAD, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::TRANSFER_SRC_OPTIMAL, Turbo::Core::TImageLayout::TRANSFER_SRC_OPTIMAL);
+    Turbo::Core::TAttachment load_depth_attachment(depthFormat, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TLoadOp::LOAD, Turbo::Core::TStoreOp::STORE, Turbo::Core::TLoadOp::DONT_CARE, Turbo::Core::TStoreOp::DONT_CARE, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL, Turbo::Core::TImageLayout::DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
+
+    std::vector<Turbo::Core::TAttachment> clear_attachments = {clear_color_attachment, clear_depth_attachment};
+    std::vector<Turbo::Core::TAttachment> load_attachments = {load_color_attachment, load_depth_attachment};
+    this->clearRenderPass = new Turbo::Core::TRenderPass(device, clear_attachments, subpasses);
+    this->loadRenderPass = new Turbo::Core::TRenderPass(device, load_attachments, subpasses);
+}
+
+ProgressiveAccumulation::~ProgressiveAccumulation()
+{
+}
+
+void ProgressiveAccumulation::SetTargets(const Turbo::Core::TRefPtr<Turbo::Core::TImageView> &depthImageView, uint32_t width, uint32_t height)
+{
+    const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device = this->loadRenderPass->GetDevice();
+    this->width = std::max(1u, width);
+    this->height = std::max(1u, height);
+
+    this->colorImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, this->colorFormat.GetFormatType(), this->width, this->height, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_COLOR_ATTACHMENT | Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+    this->colorImageView = new Turbo::Core::TImageView(this->colorImage, Turbo::Core::TImageViewType::IMAGE_VIEW_2D, this->colorImage->GetFormat(), Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TImageView>> image_views = {this->colorImageView, depthImageView};
+    this->framebuffer = new Turbo::Core::TFramebuffer(this->loadRenderPass, image_views);
+
+    this->Reset();
+}
+
+void ProgressiveAccumulation::Reset()
+{
+    this->sliceIndex = 0;
+}
+
+void ProgressiveAccumulation::SetSliceCount(uint32_t sliceCount)
+{
+    this->sliceCount = std::max(1u, sliceCount);
+    this->Reset();
+}
+
+bool ProgressiveAccumulation::Update(const glm::mat4 &viewProjection)
+{
+    if (!this->isViewProjectionValid || viewProjection != this->viewProjection)
+    {
+        this->viewProjection = viewProjection;
+        this->isViewProjectionValid = true;
+        this->Reset();
+    }
+
+    return !this->IsConverged();
+}
+
+void ProgressiveAccumulation::CmdBeginSlice(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    commandBuffer->CmdBeginRenderPass(this->sliceIndex == 0 ? this->clearRenderPass : this->loadRenderPass, this->framebuffer);
+}
+
+void ProgressiveAccumulation::CmdEndSlice(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer)
+{
+    // subpass 1 is the ImGui subpass of the points render pass, nothing is drawn there
+    commandBuffer->CmdNextSubpass();
+    commandBuffer->CmdEndRenderPass();
+    this->sliceIndex++;
+}
+
+void ProgressiveAccumulation::CmdCopyToImage(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TImage> &image)
+{
+    Turbo::Core::TMemoryBarrier slice_barrier(Turbo::Core::TAccessBits::COLOR_ATTACHMENT_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_READ_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, slice_barrier);
+
+    // the swapchain image acquire semaphore is waited at COLOR_ATTACHMENT_OUTPUT, the copy has to wait for it too
+    commandBuffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, 0, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, image, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+    uint32_t copy_width = std::min(this->width, image->GetWidth());
+    uint32_t copy_height = std::min(this->height, image->GetHeight());
+    commandBuffer->CmdCopyImage(this->colorImage, Turbo::Core::TImageLayout::TRANSFER_SRC_OPTIMAL, image, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, copy_width, copy_height, 1);
+
+    Turbo::Core::TMemoryBarrier copy_barrier(Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::COLOR_ATTACHMENT_READ_BIT | Turbo::Core::TAccessBits::COLOR_ATTACHMENT_WRITE_BIT);
+    commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::COLOR_ATTACHMENT_OUTPUT_BIT, copy_barrier);
+}
+
+uint32_t ProgressiveAccumulation::GetSliceCount() const
+{
+    return this->sliceCount;
+}
+
+uint32_t ProgressiveAccumulation::GetSliceOffset() const
+{
+    return this->sliceIndex % this->sliceCount;
+}
+
+uint32_t ProgressiveAccumulation::GetAccumulatedSliceCount() const
+{
+    return std::min(this->sliceIndex, this->sliceCount);
+}
+
+bool ProgressiveAccumulation::IsConverged() const
+{
+    return this->sliceIndex >= this->sliceCount;
+}
+
+uint32_t ProgressiveAccumulation::GetSlicePointCount(uint32_t pointCount) const
+{
+    uint32_t slice_offset = this->GetSliceOffset();
+    return pointCount > slice_offset ? (pointCount - slice_offset + this->sliceCount - 1) / this->sliceCount : 0;
+}
@@ -0,0 +1,74 @@
+#pragma once
+#ifndef POINTCLOUD_PROGRESSIVEACCUMULATION_H
+#define POINTCLOUD_PROGRESSIVEACCUMULATION_H
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TFramebuffer.h"
+#include "../core/include/TImage.h"
+#include "../core/include/TImageView.h"
+#include "../core/include/TRenderPass.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// Progressive accumulation of the points while the camera is still:
+//   every frame draws the next slice, the points whose index modulo GetSliceCount() is GetSliceOffset(), into a persistent color target
+//   and the shared depth attachment. After GetSliceCount() frames the target holds every point and nothing is drawn until the next reset.
+//   CmdCopyToImage() copies the target into the swapchain image, the caller draws ImGui over it.
+// Any change of the view projection resets it, the caller resets it on every other change of the points image (pipeline, resize, ...).
+// NOTE: the depth attachment is only kept between frames as long as nothing else clears it, toggling the mode needs a Reset()
+class ProgressiveAccumulation
+{
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> clearRenderPass; // slice 0, clears color and depth
+    Turbo::Core::TRefPtr<Turbo::Core::TRenderPass> loadRenderPass;  // the other slices, load what the previous slices drew
+    Turbo::Core::TFormatInfo colorFormat;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> colorImage; // TRANSFER_SRC_OPTIMAL between the slices
+    Turbo::Core::TRefPtr<Turbo::Core::TImageView> colorImageView;
+    Turbo::Core::TRefPtr<Turbo::Core::TFramebuffer> framebuffer;
+
+    uint32_t sliceCount = 8;
+    uint32_t sliceIndex = 0; // slices drawn since the last reset
+    bool isViewProjectionValid = false;
+    glm::mat4 viewProjection = glm::mat4(1.0f);
+
+  public:
+    // subpasses of the points render pass, so the points pipelines stay compatible with the accumulation render passes
+    ProgressiveAccumulation(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, Turbo::Core::TFormatInfo colorFormat, Turbo::Core::TFormatInfo depthFormat, std::vector<Turbo::Core::TSubpass> &subpasses);
+    ~ProgressiveAccumulation();
+
+    ProgressiveAccumulation(const ProgressiveAccumulation &) = delete;
+    ProgressiveAccumulation &operator=(const ProgressiveAccumulation &) = delete;
+
+  public:
+    // After every (re)creation of the depth attachment, the target follows its size
+    void SetTargets(const Turbo::Core::TRefPtr<Turbo::Core::TImageView> &depthImageView, uint32_t width, uint32_t height);
+
+    void Reset();
+    void SetSliceCount(uint32_t sliceCount);
+
+    // Once per frame before recording, resets if the view projection changed. Return true if a slice is still to be drawn.
+    bool Update(const glm::mat4 &viewProjection);
+
+    // Outside a render pass. Begins subpass 0 of the accumulation render pass on the target, the caller binds the points pipeline
+    // and draws the slice, CmdEndSlice() finishes the render pass. The depth attachment is in DEPTH_STENCIL_ATTACHMENT_OPTIMAL after it.
+    void CmdBeginSlice(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer);
+    void CmdEndSlice(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer);
+
+    // Outside a render pass. Leaves image in TRANSFER_DST_OPTIMAL, its content before is discarded.
+    void CmdCopyToImage(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &commandBuffer, const Turbo::Core::TRefPtr<Turbo::Core::TImage> &image);
+
+    uint32_t GetSliceCount() const;
+    uint32_t GetSliceOffset() const; // offset of the slice drawn by the next CmdBeginSlice()
+    uint32_t GetAccumulatedSliceCount() const;
+    bool IsConverged() const;
+
+    // instance count of the slice of a chunk of pointCount points
+    uint32_t GetSlicePointCount(uint32_t pointCount) const;
+};
+
+#endif // !POINTCLOUD_PROGRESSIVEACCUMULATION_H
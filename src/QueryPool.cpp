@@ -0,0 +1,81 @@
+#include "QueryPool.h"
+
+#include "../core/include/TException.h"
+#include "../core/include/TVulkanAllocator.h"
+#include "../core/include/TVulkanLoader.h"
+
+QueryPool::QueryPool(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, VkQueryType type, uint32_t count, VkQueryPipelineStatisticFlags pipelineStatistics)
+{
+    this->device = device;
+    this->type = type;
+    this->count = count;
+
+    VkQueryPoolCreateInfo vk_query_pool_create_info = {};
+    vk_query_pool_create_info.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    vk_query_pool_create_info.pNext = nullptr;
+    vk_query_pool_create_info.flags = 0;
+    vk_query_pool_create_info.queryType = type;
+    vk_query_pool_create_info.queryCount = count;
+    vk_query_pool_create_info.pipelineStatistics = type == VK_QUERY_TYPE_PIPELINE_STATISTICS ? pipelineStatistics : 0;
+
+    VkAllocationCallbacks *allocator = Turbo::Core::TVulkanAllocator::Instance()->GetVkAllocationCallbacks();
+    VkResult result = this->device->GetDeviceDriver()->vkCreateQueryPool(this->device->GetVkDevice(), &vk_query_pool_create_info, allocator, &this->vkQueryPool);
+    if (result != VK_SUCCESS)
+    {
+        throw Turbo::Core::TException(Turbo::Core::TResult::INITIALIZATION_FAILED, "QueryPool::QueryPool", "vkCreateQueryPool failed");
+    }
+}
+
+QueryPool::~QueryPool()
+{
+    VkAllocationCallbacks *allocator = Turbo::Core::TVulkanAllocator::Instance()->GetVkAllocationCallbacks();
+    this->device->GetDeviceDriver()->vkDestroyQueryPool(this->device->GetVkDevice(), this->vkQueryPool, allocator);
+    this->vkQueryPool = VK_NULL_HANDLE;
+}
+
+VkQueryPool QueryPool::GetVkQueryPool() const
+{
+    return this->vkQueryPool;
+}
+
+VkQueryType QueryPool::GetType() const
+{
+    return this->type;
+}
+
+uint32_t QueryPool::GetCount() const
+{
+    return this->count;
+}
+
+void QueryPool::CmdReset(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, uint32_t firstQuery, uint32_t queryCount)
+{
+    this->device->GetDeviceDriver()->vkCmdResetQueryPool(commandBuffer->GetVkCommandBuffer(), this->vkQueryPool, firstQuery, queryCount);
+}
+
+void QueryPool::CmdWriteTimestamp(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, VkPipelineStageFlagBits stage, uint32_t query)
+{
+    this->device->GetDeviceDriver()->vkCmdWriteTimestamp(commandBuffer->GetVkCommandBuffer(), stage, this->vkQueryPool, query);
+}
+
+void QueryPool::CmdBeginQuery(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, uint32_t query)
+{
+    this->device->GetDeviceDriver()->vkCmdBeginQuery(commandBuffer->GetVkCommandBuffer(), this->vkQueryPool, query, 0);
+}
+
+void QueryPool::CmdEndQuery(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, uint32_t query)
+{
+    this->device->GetDeviceDriver()->vkCmdEndQuery(commandBuffer->GetVkCommandBuffer(), this->vkQueryPool, query);
+}
+
+VkResult QueryPool::GetResults(uint32_t firstQuery, uint32_t queryCount, std::vector<uint64_t> &results, uint32_t valueCountPerQuery)
+{
+    results.resize(static_cast<size_t>(queryCount) * valueCountPerQuery);
+    if (results.empty())
+    {
+        return VK_SUCCESS;
+    }
+
+    VkDeviceSize stride = valueCountPerQuery * sizeof(uint64_t);
+    return this->device->GetDeviceDriver()->vkGetQueryPoolResults(this->device->GetVkDevice(), this->vkQueryPool, firstQuery, queryCount, results.size() * sizeof(uint64_t), results.data(), stride, VK_QUERY_RESULT_64_BIT);
+}
@@ -0,0 +1,43 @@
+#pragma once
+#ifndef POINTCLOUD_QUERYPOOL_H
+#define POINTCLOUD_QUERYPOOL_H
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TDevice.h"
+
+#include <cstdint>
+#include <vector>
+
+// Thin owner of a VkQueryPool, the Cmd* functions go through the device driver on the given command buffer
+class QueryPool
+{
+  private:
+    Turbo::Core::TRefPtr<Turbo::Core::TDevice> device;
+    VkQueryPool vkQueryPool = VK_NULL_HANDLE;
+    VkQueryType type;
+    uint32_t count = 0;
+
+  public:
+    // pipelineStatistics is only used with VK_QUERY_TYPE_PIPELINE_STATISTICS
+    QueryPool(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, VkQueryType type, uint32_t count, VkQueryPipelineStatisticFlags pipelineStatistics = 0);
+    ~QueryPool();
+
+    QueryPool(const QueryPool &) = delete;
+    QueryPool &operator=(const QueryPool &) = delete;
+
+  public:
+    VkQueryPool GetVkQueryPool() const;
+    VkQueryType GetType() const;
+    uint32_t GetCount() const;
+
+    // NOTE: must be recorded outside of a render pass
+    void CmdReset(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, uint32_t firstQuery, uint32_t queryCount);
+    void CmdWriteTimestamp(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, VkPipelineStageFlagBits stage, uint32_t query);
+    void CmdBeginQuery(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, uint32_t query);
+    void CmdEndQuery(const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferBase> &commandBuffer, uint32_t query);
+
+    // Never waits, return VK_NOT_READY if some query is not available yet.
+    // valueCountPerQuery is the number of enabled statistics for VK_QUERY_TYPE_PIPELINE_STATISTICS, otherwise 1
+    VkResult GetResults(uint32_t firstQuery, uint32_t queryCount, std::vector<uint64_t> &results, uint32_t valueCountPerQuery = 1);
+};
+
+#endif // !POINTCLOUD_QUERYPOOL_H
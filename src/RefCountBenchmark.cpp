@@ -0,0 +1,228 @@
+#include "RefCountBenchmark.h"
+#include "../core/include/TRefPtr.h"
+#include "../core/include/TReferenced.h"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+const size_t COPY_BATCH_SIZE = 64; // references held at once, taken then dropped together like a recorded command buffer does
+
+// counted by the atomic Turbo::Core::TReferenced of src/TReferenced.cpp
+class BenchmarkObject : public Turbo::Core::TReferenced
+{
+};
+
+// the plain count Turbo::Core::TReferenced had before src/TReferenced.cpp
+class PlainBenchmarkObject
+{
+  private:
+    mutable uint32_t referenceCount = 0;
+
+  public:
+    uint32_t Reference() const
+    {
+        this->referenceCount = this->referenceCount + 1;
+        return this->referenceCount;
+    }
+
+    uint32_t UnReference() const
+    {
+        this->referenceCount = this->referenceCount - 1;
+        return this->referenceCount;
+    }
+
+    uint32_t GetReferenceCount() const
+    {
+        return this->referenceCount;
+    }
+};
+
+typedef struct BenchmarkRow
+{
+    std::string name;
+    uint32_t threadCount = 1;
+    uint64_t copyCount = 0; // per thread
+    double time = 0;        // ms, the fastest repeat
+    bool isCorrect = true;
+} BenchmarkRow;
+
+double GetElapsedMilliseconds(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+template <typename Function>
+double GetFastestTime(uint32_t repeatCount, Function &&function)
+{
+    double fastest_time = 0;
+    for (uint32_t repeat_index = 0; repeat_index < std::max(1u, repeatCount); repeat_index++)
+    {
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        function();
+        double time = GetElapsedMilliseconds(start_time);
+        fastest_time = repeat_index == 0 ? time : std::min(fastest_time, time);
+    }
+    return fastest_time;
+}
+
+// Reference()/UnReference() through a table of pointers, so the compiler can not merge the counts of a batch into one add
+template <typename Object>
+void ReferenceBatches(const Object *object, uint64_t copyCount)
+{
+    std::vector<const Object *> objects(COPY_BATCH_SIZE, object);
+    for (uint64_t copy_index = 0; copy_index < copyCount; copy_index += COPY_BATCH_SIZE)
+    {
+        for (const Object *object_item : objects)
+        {
+            object_item->Reference();
+        }
+        for (const Object *object_item : objects)
+        {
+            object_item->UnReference();
+        }
+    }
+}
+
+void CopyRefPtrBatches(const Turbo::Core::TRefPtr<BenchmarkObject> &object, uint64_t copyCount)
+{
+    std::vector<Turbo::Core::TRefPtr<BenchmarkObject>> copies(COPY_BATCH_SIZE);
+    for (uint64_t copy_index = 0; copy_index < copyCount; copy_index += COPY_BATCH_SIZE)
+    {
+        for (Turbo::Core::TRefPtr<BenchmarkObject> &copy_item : copies)
+        {
+            copy_item = object;
+        }
+        for (Turbo::Core::TRefPtr<BenchmarkObject> &copy_item : copies)
+        {
+            copy_item = nullptr;
+        }
+    }
+}
+
+void AddSingleThreadRows(const RefCountBenchmarkOptions &options, std::vector<BenchmarkRow> &rows)
+{
+    uint64_t copy_count = std::max<uint64_t>(COPY_BATCH_SIZE, options.copyCount);
+    BenchmarkRow row;
+    row.copyCount = copy_count;
+
+    PlainBenchmarkObject plain_object;
+    plain_object.Reference();
+    row.name = "plain_count";
+    row.time = GetFastestTime(options.repeatCount, [&]() { ReferenceBatches(&plain_object, copy_count); });
+    row.isCorrect = plain_object.GetReferenceCount() == 1;
+    rows.push_back(row);
+
+    // Reference()/UnReference() of TReferenced itself, then through TRefPtr<T> copies
+    Turbo::Core::TRefPtr<BenchmarkObject> object = new BenchmarkObject();
+    row.name = "atomic_count";
+    row.time = GetFastestTime(options.repeatCount, [&]() { ReferenceBatches(object.Get(), copy_count); });
+    row.isCorrect = object->GetReferenceCount() == 1;
+    rows.push_back(row);
+
+    row.name = "refptr_copy";
+    row.time = GetFastestTime(options.repeatCount, [&]() { CopyRefPtrBatches(object, copy_count); });
+    row.isCorrect = object->GetReferenceCount() == 1;
+    rows.push_back(row);
+
+    // a move hands the reference over, the count is not touched. The reference walks around the batch
+    row.name = "refptr_move";
+    row.time = GetFastestTime(options.repeatCount, [&]() {
+        std::vector<Turbo::Core::TRefPtr<BenchmarkObject>> slots(COPY_BATCH_SIZE);
+        slots[0] = object;
+        for (uint64_t copy_index = 0; copy_index < copy_count; copy_index++)
+        {
+            slots[(copy_index + 1) % COPY_BATCH_SIZE] = std::move(slots[copy_index % COPY_BATCH_SIZE]);
+        }
+    });
+    row.isCorrect = object->GetReferenceCount() == 1;
+    rows.push_back(row);
+}
+
+void AddThreadRows(const RefCountBenchmarkOptions &options, std::vector<BenchmarkRow> &rows)
+{
+    uint64_t copy_count = std::max<uint64_t>(COPY_BATCH_SIZE, options.copyCount);
+    uint32_t max_thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<uint32_t> thread_counts;
+    for (uint32_t thread_count = 1; thread_count < max_thread_count; thread_count *= 2)
+    {
+        thread_counts.push_back(thread_count);
+    }
+    thread_counts.push_back(max_thread_count);
+
+    for (bool is_shared : {true, false})
+    {
+        for (uint32_t thread_count : thread_counts)
+        {
+            std::vector<Turbo::Core::TRefPtr<BenchmarkObject>> objects;
+            for (uint32_t object_index = 0; object_index < (is_shared ? 1 : thread_count); object_index++)
+            {
+                objects.push_back(new BenchmarkObject());
+            }
+
+            BenchmarkRow row;
+            row.name = is_shared ? "refptr_copy_shared" : "refptr_copy_private";
+            row.threadCount = thread_count;
+            row.copyCount = copy_count;
+            row.time = GetFastestTime(options.repeatCount, [&]() {
+                std::vector<std::thread> threads;
+                for (uint32_t thread_index = 0; thread_index < thread_count; thread_index++)
+                {
+                    // the TRefPtr<T> is shared by address, each thread copies and drops its own copies of it
+                    const Turbo::Core::TRefPtr<BenchmarkObject> *object = &objects[is_shared ? 0 : thread_index];
+                    threads.emplace_back([object, copy_count]() { CopyRefPtrBatches(*object, copy_count); });
+                }
+                for (std::thread &thread_item : threads)
+                {
+                    thread_item.join();
+                }
+            });
+            for (uint32_t object_index = 0; object_index < (is_shared ? 1 : thread_count); object_index++)
+            {
+                row.isCorrect = row.isCorrect && objects[object_index]->GetReferenceCount() == 1;
+            }
+            rows.push_back(row);
+        }
+    }
+}
+} // namespace
+
+int RunRefCountBenchmark(const RefCountBenchmarkOptions &options)
+{
+    std::vector<BenchmarkRow> rows;
+    AddSingleThreadRows(options, rows);
+    AddThreadRows(options, rows);
+
+    bool is_all_correct = true;
+    for (const BenchmarkRow &row : rows)
+    {
+        is_all_correct = is_all_correct && row.isCorrect;
+        double ns_per_copy = row.copyCount > 0 ? row.time * 1000000.0 / row.copyCount : 0;
+        std::cout << "TReferenced::" << row.name << "::threads::" << row.threadCount << "::copies::" << row.copyCount << "::" << row.time << "ms::" << ns_per_copy << "ns per copy" << (row.isCorrect ? "" : "::WRONG COUNT") << std::endl;
+    }
+
+    std::ofstream out_stream(options.outputFile, std::ios::trunc);
+    if (!out_stream.is_open())
+    {
+        std::cerr << "Failed to write " << options.outputFile << std::endl;
+        return 1;
+    }
+
+    out_stream << "{\n  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [\n";
+    for (size_t row_index = 0; row_index < rows.size(); row_index++)
+    {
+        const BenchmarkRow &row = rows[row_index];
+        double ns_per_copy = row.copyCount > 0 ? row.time * 1000000.0 / row.copyCount : 0;
+        out_stream << "    {\"name\": \"" << row.name << "\", \"threads\": " << row.threadCount << ", \"copies\": " << row.copyCount << ", \"ms\": " << row.time << ", \"ns_per_copy\": " << ns_per_copy
+                   << ", \"correct\": " << (row.isCorrect ? "true" : "false") << "}" << (row_index + 1 < rows.size() ? "," : "") << "\n";
+    }
+    out_stream << "  ]\n}\n";
+
+    return out_stream.good() && is_all_correct ? 0 : 1;
+}
@@ -0,0 +1,21 @@
+#pragma once
+#ifndef POINTCLOUD_REFCOUNTBENCHMARK_H
+#define POINTCLOUD_REFCOUNTBENCHMARK_H
+#include <cstdint>
+#include <string>
+
+typedef struct RefCountBenchmarkOptions
+{
+    std::string outputFile = "./refcount_benchmark.json";
+    uint64_t copyCount = 1 << 24; // Reference()/UnReference() pairs of every row (per thread on the threaded rows)
+    uint32_t repeatCount = 3;     // every row runs that many times, the fastest run is reported
+} RefCountBenchmarkOptions;
+
+// Microbenchmarks of reference counting, no Vulkan:
+//   single thread  the plain uint32_t count TCore.lib's Turbo::Core::TReferenced had against the atomic one of src/TReferenced.cpp,
+//                  copying and moving a TRefPtr<T> (a move touches no count)
+//   threads        1, 2, 4, ... hardware_concurrency threads copying and dropping TRefPtr<T>s of one shared object (the cache line bounces) or of their own
+// Print a line per row and write them as JSON to options.outputFile. Return the process exit code (1 if a count is wrong afterwards).
+int RunRefCountBenchmark(const RefCountBenchmarkOptions &options);
+
+#endif // !POINTCLOUD_REFCOUNTBENCHMARK_H
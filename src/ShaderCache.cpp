@@ -0,0 +1,424 @@
+#include "ShaderCache.h"
+#include "Trace.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+const uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+const uint64_t FNV_PRIME = 1099511628211ull;
+
+// bump it whenever the layout of the cache key or file changes
+const uint32_t SHADER_CACHE_VERSION = 2;
+
+// the Vulkan SDK compiler shaders/CompileShaders.bat uses, found through PATH
+const char *SPIRV_COMPILER = "glslangValidator";
+
+#if defined(_WIN32)
+const char *NULL_DEVICE = "NUL";
+#else
+const char *NULL_DEVICE = "/dev/null";
+#endif
+
+const char *GetStageName(Turbo::Core::TShaderType type)
+{
+    switch (type)
+    {
+    case Turbo::Core::TShaderType::VERTEX:
+        return "vert";
+    case Turbo::Core::TShaderType::TESSELLATION_CONTROL:
+        return "tesc";
+    case Turbo::Core::TShaderType::TESSELLATION_EVALUATION:
+        return "tese";
+    case Turbo::Core::TShaderType::GEOMETRY:
+        return "geom";
+    case Turbo::Core::TShaderType::FRAGMENT:
+        return "frag";
+    case Turbo::Core::TShaderType::COMPUTE:
+        return "comp";
+    case Turbo::Core::TShaderType::TASK:
+        return "task";
+    case Turbo::Core::TShaderType::MESH:
+        return "mesh";
+    case Turbo::Core::TShaderType::RAY_GENERATION:
+        return "rgen";
+    case Turbo::Core::TShaderType::ANY_HIT:
+        return "rahit";
+    case Turbo::Core::TShaderType::CLOSEST_HIT:
+        return "rchit";
+    case Turbo::Core::TShaderType::MISS:
+        return "rmiss";
+    case Turbo::Core::TShaderType::INTERSECTION:
+        return "rint";
+    case Turbo::Core::TShaderType::CALLABLE:
+        return "rcall";
+    }
+    return "comp";
+}
+
+int RunCommand(const std::string &command)
+{
+#if defined(_WIN32)
+    // cmd.exe strips the outer quotes of the whole line, keep the quoted paths inside intact
+    return std::system(("\"" + command + "\"").c_str());
+#else
+    return std::system(command.c_str());
+#endif
+}
+
+bool ReadSpirV(const std::string &path, std::vector<uint32_t> &spirv)
+{
+    std::ifstream in_stream(path, std::ios::binary | std::ios::ate);
+    if (in_stream.is_open())
+    {
+        std::streamsize size = in_stream.tellg();
+        if (size > 0 && size % sizeof(uint32_t) == 0)
+        {
+            spirv.resize(size / sizeof(uint32_t));
+            in_stream.seekg(0);
+            if (in_stream.read(reinterpret_cast<char *>(spirv.data()), size) && spirv[0] == 0x07230203) // SPIR-V magic number
+            {
+                return true;
+            }
+        }
+    }
+
+    spirv.clear();
+    return false;
+}
+
+uint64_t Fnv1a(uint64_t hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= bytes[i];
+        hash *= FNV_PRIME;
+    }
+    return hash;
+}
+
+uint64_t Fnv1a(uint64_t hash, const std::string &value)
+{
+    // hash the length too, so {"ab", "c"} and {"a", "bc"} differ
+    uint64_t size = value.size();
+    hash = Fnv1a(hash, &size, sizeof(size));
+    return Fnv1a(hash, value.data(), value.size());
+}
+
+// the source bytes CompileShaders.bat embeds keep the \r of a CRLF file, a text mode read drops them on Windows
+uint64_t HashSource(const char *source, size_t size)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    for (size_t i = 0; i < size; i++)
+    {
+        if (source[i] != '\r')
+        {
+            hash = Fnv1a(hash, &source[i], 1);
+        }
+    }
+    return hash;
+}
+
+// Hash every file code #includes (and what those include), looked up in includePaths in order like glslang does.
+// An include not found is hashed by name, creating it later changes the key.
+uint64_t HashIncludes(uint64_t hash, const std::string &code, const std::vector<std::string> &includePaths, std::set<std::string> &visitedPaths)
+{
+    std::istringstream code_stream(code);
+    std::string line;
+    while (std::getline(code_stream, line))
+    {
+        size_t directive_pos = line.find_first_not_of(" \t");
+        if (directive_pos == std::string::npos || line.compare(directive_pos, 8, "#include") != 0)
+        {
+            continue;
+        }
+
+        size_t name_begin = line.find_first_of("\"<", directive_pos + 8);
+        if (name_begin == std::string::npos)
+        {
+            continue;
+        }
+        size_t name_end = line.find(line[name_begin] == '"' ? '"' : '>', name_begin + 1);
+        if (name_end == std::string::npos)
+        {
+            continue;
+        }
+        std::string include_name = line.substr(name_begin + 1, name_end - name_begin - 1);
+
+        bool is_found = false;
+        for (const std::string &include_path_item : includePaths)
+        {
+            std::string path = include_path_item + "/" + include_name;
+            std::ifstream include_stream(path, std::ios::binary);
+            if (!include_stream.is_open())
+            {
+                continue;
+            }
+
+            is_found = true;
+            if (visitedPaths.insert(path).second)
+            {
+                std::string include_code((std::istreambuf_iterator<char>(include_stream)), std::istreambuf_iterator<char>());
+                hash = Fnv1a(hash, path);
+                hash = Fnv1a(hash, include_code);
+                hash = HashIncludes(hash, include_code, includePaths, visitedPaths);
+            }
+            break;
+        }
+
+        if (!is_found)
+        {
+            hash = Fnv1a(hash, include_name);
+        }
+    }
+    return hash;
+}
+
+void MakeDirectory(const std::string &directory)
+{
+#if defined(_WIN32)
+    _mkdir(directory.c_str());
+#else
+    mkdir(directory.c_str(), 0755);
+#endif
+}
+} // namespace
+
+uint64_t ShaderCache::Hash(Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint)
+{
+    uint64_t hash = FNV_OFFSET_BASIS;
+    hash = Fnv1a(hash, &SHADER_CACHE_VERSION, sizeof(SHADER_CACHE_VERSION));
+
+    uint32_t shader_type = static_cast<uint32_t>(type);
+    hash = Fnv1a(hash, &shader_type, sizeof(shader_type));
+    hash = Fnv1a(hash, code);
+
+    uint64_t define_count = defines.size();
+    hash = Fnv1a(hash, &define_count, sizeof(define_count));
+    for (const std::string &define_item : defines)
+    {
+        hash = Fnv1a(hash, define_item);
+    }
+
+    uint64_t include_path_count = includePaths.size();
+    hash = Fnv1a(hash, &include_path_count, sizeof(include_path_count));
+    for (const std::string &include_path_item : includePaths)
+    {
+        hash = Fnv1a(hash, include_path_item);
+    }
+
+    // an edited include has to miss as well
+    std::set<std::string> visited_paths;
+    hash = HashIncludes(hash, code, includePaths, visited_paths);
+
+    return Fnv1a(hash, entryPoint);
+}
+
+std::string ShaderCache::InjectDefines(const std::string &code, const std::vector<std::string> &defines)
+{
+    if (defines.empty())
+    {
+        return code;
+    }
+
+    std::string define_lines;
+    for (const std::string &define_item : defines)
+    {
+        define_lines += "#define " + define_item + "\n";
+    }
+
+    // GLSL requires #version to be the first directive
+    size_t version_pos = code.find("#version");
+    if (version_pos == std::string::npos)
+    {
+        return define_lines + code;
+    }
+
+    size_t line_end = code.find('\n', version_pos);
+    if (line_end == std::string::npos)
+    {
+        return code + "\n" + define_lines;
+    }
+
+    return code.substr(0, line_end + 1) + define_lines + code.substr(line_end + 1);
+}
+
+ShaderCache::ShaderCache(const std::string &directory) : hitCount(0), missCount(0), compileCount(0)
+{
+    this->directory = directory;
+    MakeDirectory(this->directory);
+}
+
+void ShaderCache::Embed(const std::string &name, const uint32_t *code, size_t size, const unsigned char *source, size_t sourceSize)
+{
+    EmbeddedSpirV &embedded_spirv = this->embeddedSpirVs[name];
+    embedded_spirv.sourceHash = HashSource(reinterpret_cast<const char *>(source), sourceSize);
+    embedded_spirv.spirv = std::vector<uint32_t>(code, code + size / sizeof(uint32_t));
+}
+
+std::string ShaderCache::GetPath(Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint) const
+{
+    std::stringstream path_stream;
+    path_stream << this->directory << "/" << std::hex << ShaderCache::Hash(type, code, defines, includePaths, entryPoint) << ".spv";
+    return path_stream.str();
+}
+
+bool ShaderCache::FindSpirV(const std::string &name, Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint, std::vector<uint32_t> &spirv)
+{
+    if (defines.empty() && includePaths.empty())
+    {
+        auto embedded_spirv = this->embeddedSpirVs.find(name);
+        if (embedded_spirv != this->embeddedSpirVs.end() && embedded_spirv->second.sourceHash == HashSource(code.data(), code.size()))
+        {
+            this->hitCount++;
+            spirv = embedded_spirv->second.spirv;
+            return true;
+        }
+    }
+
+    std::string path = this->GetPath(type, code, defines, includePaths, entryPoint);
+
+    std::lock_guard<std::mutex> read_lock(this->fileMutex);
+    if (ReadSpirV(path, spirv))
+    {
+        this->hitCount++;
+        return true;
+    }
+    return false;
+}
+
+bool ShaderCache::IsCompilerAvailable()
+{
+    std::call_once(this->compilerFlag, [this]() {
+        std::string command = std::string(SPIRV_COMPILER) + " --version > " + NULL_DEVICE + " 2>&1";
+        this->isCompilerAvailable = RunCommand(command) == 0;
+        if (!this->isCompilerAvailable)
+        {
+            std::cerr << SPIRV_COMPILER << " not found, shaders missing the cache are compiled by Turbo on the main thread" << std::endl;
+        }
+    });
+    return this->isCompilerAvailable;
+}
+
+bool ShaderCache::CompileSpirV(Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint, std::vector<uint32_t> &spirv)
+{
+    spirv.clear();
+    if (!this->IsCompilerAvailable())
+    {
+        return false;
+    }
+
+    TRACE_ZONE("CompileSpirV");
+    std::string path = this->GetPath(type, code, defines, includePaths, entryPoint);
+
+    // two jobs may miss the same key at once, each compile gets its own files
+    std::string compile_path = path + "." + std::to_string(this->compileCount++);
+    std::string source_path = compile_path + ".glsl";
+    std::string output_path = compile_path + ".out";
+    std::string log_path = compile_path + ".log";
+    {
+        std::ofstream source_stream(source_path, std::ios::binary | std::ios::trunc);
+        source_stream << ShaderCache::InjectDefines(code, defines);
+        if (!source_stream)
+        {
+            return false;
+        }
+    }
+
+    std::stringstream command_stream;
+    command_stream << SPIRV_COMPILER << " -V --target-env vulkan1.2 -S " << GetStageName(type);
+    if (entryPoint != "main")
+    {
+        command_stream << " -e " << entryPoint << " --source-entrypoint " << entryPoint;
+    }
+    for (const std::string &include_path_item : includePaths)
+    {
+        command_stream << " \"-I" << include_path_item << "\"";
+    }
+    command_stream << " -o \"" << output_path << "\" \"" << source_path << "\" > \"" << log_path << "\" 2>&1";
+
+    bool is_compiled = RunCommand(command_stream.str()) == 0 && ReadSpirV(output_path, spirv);
+    std::remove(source_path.c_str());
+    std::remove(output_path.c_str());
+    std::remove(log_path.c_str());
+    if (!is_compiled)
+    {
+        // the main thread compiles it again through Turbo, which reports the error
+        return false;
+    }
+
+    this->missCount++;
+    this->WriteSpirV(path, spirv);
+    return true;
+}
+
+void ShaderCache::WriteSpirV(const std::string &path, const std::vector<uint32_t> &spirv)
+{
+    // write to a temporary file first, a half written .spv would be taken as a hit next time
+    std::string temp_path = path + ".tmp";
+    std::lock_guard<std::mutex> write_lock(this->fileMutex);
+    {
+        std::ofstream out_stream(temp_path, std::ios::binary | std::ios::trunc);
+        out_stream.write(reinterpret_cast<const char *>(spirv.data()), spirv.size() * sizeof(uint32_t));
+    }
+    std::remove(path.c_str());
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0)
+    {
+        std::cerr << "Failed to write shader cache " << path << std::endl;
+    }
+}
+
+template <typename Shader>
+Turbo::Core::TRefPtr<Shader> ShaderCache::CreateShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &name, Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint)
+{
+    std::vector<uint32_t> spirv;
+    if (this->FindSpirV(name, type, code, defines, includePaths, entryPoint, spirv))
+    {
+        return new Shader(device, spirv.size() * sizeof(uint32_t), spirv.data(), entryPoint);
+    }
+
+    this->missCount++;
+    TRACE_ZONE("CompileShader");
+
+    // the compiled shader is the one handed out, its SPIR-V only goes to the cache
+    Turbo::Core::TRefPtr<Shader> shader = new Shader(device, Turbo::Core::TShaderLanguage::GLSL, ShaderCache::InjectDefines(code, defines), includePaths, entryPoint);
+    this->WriteSpirV(this->GetPath(type, code, defines, includePaths, entryPoint), shader->GetSpirV());
+    return shader;
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> ShaderCache::CreateVertexShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &name, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint)
+{
+    return this->CreateShader<Turbo::Core::TVertexShader>(device, name, Turbo::Core::TShaderType::VERTEX, code, defines, includePaths, entryPoint);
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> ShaderCache::CreateFragmentShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &name, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint)
+{
+    return this->CreateShader<Turbo::Core::TFragmentShader>(device, name, Turbo::Core::TShaderType::FRAGMENT, code, defines, includePaths, entryPoint);
+}
+
+Turbo::Core::TRefPtr<Turbo::Core::TComputeShader> ShaderCache::CreateComputeShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &name, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint)
+{
+    return this->CreateShader<Turbo::Core::TComputeShader>(device, name, Turbo::Core::TShaderType::COMPUTE, code, defines, includePaths, entryPoint);
+}
+
+uint32_t ShaderCache::GetHitCount() const
+{
+    return this->hitCount;
+}
+
+uint32_t ShaderCache::GetMissCount() const
+{
+    return this->missCount;
+}
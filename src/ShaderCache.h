@@ -0,0 +1,79 @@
+#pragma once
+#ifndef POINTCLOUD_SHADERCACHE_H
+#define POINTCLOUD_SHADERCACHE_H
+#include "../core/include/TDevice.h"
+#include "../core/include/TShader.h"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// GLSL -> SPIR-V through an on-disk cache (<directory>/<key>.spv). The key is a FNV-1a hash of the
+// source, defines, include paths, the contents of the included files, shader type and entry point, so a hit is a file read instead of a glslang compile.
+// With POINTCLOUD_EMBEDDED_SPIRV defined the SPIR-V generated by shaders/CompileShaders.bat is linked into the
+// binary and looked up by shader name first (only for the variant without defines or include paths), as long as the
+// source it was built from matches the code passed in. An edited shader falls through to the on-disk cache.
+// On a miss CompileSpirV() runs glslangValidator (Vulkan SDK, the same one shaders/CompileShaders.bat uses) as a child process,
+// so the SPIR-V is produced without any Turbo object. Without it in PATH, Create*Shader() compiles through Turbo::Core::TShader.
+// FindSpirV()/CompileSpirV()/Create*Shader() may be called from several threads, Embed() only before that.
+// NOTE: the reflection (InternalParseSpirV) still runs inside Turbo::Core::TShader, TShader has no way to accept it from outside
+class ShaderCache
+{
+  private:
+    std::string directory;
+    typedef struct EmbeddedSpirV
+    {
+        uint64_t sourceHash = 0; // of the GLSL CompileShaders.bat compiled, line endings ignored
+        std::vector<uint32_t> spirv;
+    } EmbeddedSpirV;
+
+    std::map<std::string, EmbeddedSpirV> embeddedSpirVs;
+
+    std::mutex fileMutex; // two threads may want the same .spv
+    std::atomic<uint32_t> hitCount;
+    std::atomic<uint32_t> missCount;
+    std::atomic<uint32_t> compileCount; // names the temporary files of each CompileSpirV()
+
+    std::once_flag compilerFlag;
+    bool isCompilerAvailable = false;
+
+  private:
+    std::string GetPath(Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint) const;
+    void WriteSpirV(const std::string &path, const std::vector<uint32_t> &spirv);
+    bool IsCompilerAvailable();
+
+    template <typename Shader>
+    Turbo::Core::TRefPtr<Shader> CreateShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &name, Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint);
+
+  public:
+    static uint64_t Hash(Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint);
+
+    // Insert "#define <define>" lines right after the #version directive, a define may be "NAME" or "NAME VALUE"
+    static std::string InjectDefines(const std::string &code, const std::vector<std::string> &defines);
+
+  public:
+    explicit ShaderCache(const std::string &directory = "./shader_cache");
+
+  public:
+    void Embed(const std::string &name, const uint32_t *code, size_t size, const unsigned char *source, size_t sourceSize);
+
+    // The embedded table, then <directory>/<key>.spv. Never compiles and needs no device, false on a miss
+    bool FindSpirV(const std::string &name, Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint, std::vector<uint32_t> &spirv);
+
+    // Compile the GLSL with glslangValidator and write the SPIR-V to the cache. Pure std, needs no device,
+    // false if the compiler is not found or the compile failed
+    bool CompileSpirV(Turbo::Core::TShaderType type, const std::string &code, const std::vector<std::string> &defines, const std::vector<std::string> &includePaths, const std::string &entryPoint, std::vector<uint32_t> &spirv);
+
+    // On a miss the shader is compiled from GLSL once, and its SPIR-V written to the cache
+    Turbo::Core::TRefPtr<Turbo::Core::TVertexShader> CreateVertexShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &name, const std::string &code, const std::vector<std::string> &defines = {}, const std::vector<std::string> &includePaths = {}, const std::string &entryPoint = "main");
+    Turbo::Core::TRefPtr<Turbo::Core::TFragmentShader> CreateFragmentShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &name, const std::string &code, const std::vector<std::string> &defines = {}, const std::vector<std::string> &includePaths = {}, const std::string &entryPoint = "main");
+    Turbo::Core::TRefPtr<Turbo::Core::TComputeShader> CreateComputeShader(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::string &name, const std::string &code, const std::vector<std::string> &defines = {}, const std::vector<std::string> &includePaths = {}, const std::string &entryPoint = "main");
+
+    uint32_t GetHitCount() const;
+    uint32_t GetMissCount() const;
+};
+
+#endif // !POINTCLOUD_SHADERCACHE_H
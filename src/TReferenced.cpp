@@ -0,0 +1,93 @@
+#include "../core/include/TReferenced.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Every member of Turbo::Core::TReferenced is defined here, so the linker takes this one and never pulls TReferenced.obj out of TCore.lib.
+// The header (and its layout) stays the one TCore was built with, only the count is now changed with atomic operations on the same uint32_t:
+// a relaxed increment (a new reference is always made from one already held), an acquire/release decrement so every write through
+// the object happens before the delete of the thread dropping the last reference.
+// NOTE: an atomic count makes copying and dropping a TRefPtr<T> thread safe, not the objects themselves
+
+namespace
+{
+#if defined(_MSC_VER)
+static_assert(sizeof(long) == sizeof(uint32_t), "the Interlocked intrinsics work on a 32 bit long");
+
+uint32_t AtomicIncrement(uint32_t &value)
+{
+    return static_cast<uint32_t>(_InterlockedIncrement(reinterpret_cast<volatile long *>(&value)));
+}
+
+uint32_t AtomicDecrement(uint32_t &value)
+{
+    return static_cast<uint32_t>(_InterlockedDecrement(reinterpret_cast<volatile long *>(&value)));
+}
+
+uint32_t AtomicLoad(const uint32_t &value)
+{
+    // an aligned volatile read is atomic, /volatile:ms (the x64 default) gives it acquire semantics
+    return static_cast<uint32_t>(*reinterpret_cast<const volatile long *>(&value));
+}
+#else
+uint32_t AtomicIncrement(uint32_t &value)
+{
+    return __atomic_add_fetch(&value, 1, __ATOMIC_RELAXED);
+}
+
+uint32_t AtomicDecrement(uint32_t &value)
+{
+    return __atomic_sub_fetch(&value, 1, __ATOMIC_ACQ_REL);
+}
+
+uint32_t AtomicLoad(const uint32_t &value)
+{
+    return __atomic_load_n(&value, __ATOMIC_ACQUIRE);
+}
+#endif
+} // namespace
+
+Turbo::Core::TReferenced::TReferenced()
+{
+}
+
+Turbo::Core::TReferenced::~TReferenced()
+{
+}
+
+void Turbo::Core::TReferenced::Release() const
+{
+    delete this;
+}
+
+uint32_t Turbo::Core::TReferenced::Reference() const
+{
+    return AtomicIncrement(this->referenceCount);
+}
+
+uint32_t Turbo::Core::TReferenced::UnReference() const
+{
+    uint32_t reference_count = AtomicDecrement(this->referenceCount);
+    if (reference_count == 0)
+    {
+        // only the thread which dropped the last reference gets 0
+        this->Release();
+    }
+    return reference_count;
+}
+
+uint32_t Turbo::Core::TReferenced::UnReferenceWithoutDelete() const
+{
+    return AtomicDecrement(this->referenceCount);
+}
+
+uint32_t Turbo::Core::TReferenced::GetReferenceCount() const
+{
+    return AtomicLoad(this->referenceCount);
+}
+
+bool Turbo::Core::TReferenced::Valid() const
+{
+    return true;
+}
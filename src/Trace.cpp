@@ -0,0 +1,185 @@
+#include "Trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+constexpr uint32_t Trace::MAX_EVENT_COUNT;
+
+namespace
+{
+typedef struct TraceEvent
+{
+    const char *name;
+    uint64_t begin;
+    uint64_t end;
+} TraceEvent;
+
+// Written by its own thread only. The capture thread reads generation then count (both acquire),
+// the owner resets count before it publishes a new generation, so a matching generation never comes with a stale count
+typedef struct ThreadBuffer
+{
+    std::vector<TraceEvent> events = std::vector<TraceEvent>(Trace::MAX_EVENT_COUNT);
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> generation{0};
+    uint32_t id = 0;
+    std::string name; // guarded by registry_mutex
+} ThreadBuffer;
+
+std::mutex registry_mutex;
+std::vector<std::unique_ptr<ThreadBuffer>> thread_buffers; // kept until exit, a finished thread still shows up in the capture
+thread_local ThreadBuffer *current_thread_buffer = nullptr;
+
+std::atomic<bool> is_capturing{false};
+std::atomic<uint32_t> capture_generation{0};
+std::atomic<uint32_t> dropped_event_count{0};
+uint64_t capture_begin = 0;
+
+ThreadBuffer &GetThreadBuffer()
+{
+    if (current_thread_buffer == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        thread_buffers.emplace_back(new ThreadBuffer());
+        current_thread_buffer = thread_buffers.back().get();
+        current_thread_buffer->id = static_cast<uint32_t>(thread_buffers.size());
+    }
+    return *current_thread_buffer;
+}
+
+void WriteJsonString(std::ofstream &outStream, const std::string &value)
+{
+    outStream << '"';
+    for (char c : value)
+    {
+        switch (c)
+        {
+        case '"':
+            outStream << "\\\"";
+            break;
+        case '\\':
+            outStream << "\\\\";
+            break;
+        case '\n':
+            outStream << "\\n";
+            break;
+        default:
+            outStream << c;
+            break;
+        }
+    }
+    outStream << '"';
+}
+} // namespace
+
+uint64_t Trace::Now()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+bool Trace::IsCapturing()
+{
+    return is_capturing.load(std::memory_order_relaxed);
+}
+
+void Trace::BeginCapture()
+{
+    capture_begin = Trace::Now();
+    dropped_event_count.store(0, std::memory_order_relaxed);
+    capture_generation.fetch_add(1, std::memory_order_release);
+    is_capturing.store(true, std::memory_order_release);
+}
+
+bool Trace::EndCapture(const std::string &path)
+{
+    is_capturing.store(false, std::memory_order_release);
+    uint32_t generation = capture_generation.load(std::memory_order_acquire);
+
+    std::ofstream out_stream(path, std::ios::trunc);
+    if (!out_stream.is_open())
+    {
+        return false;
+    }
+
+    out_stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool is_first = true;
+
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    for (const std::unique_ptr<ThreadBuffer> &thread_buffer_item : thread_buffers)
+    {
+        if (!thread_buffer_item->name.empty())
+        {
+            out_stream << (is_first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread_buffer_item->id << ",\"args\":{\"name\":";
+            WriteJsonString(out_stream, thread_buffer_item->name);
+            out_stream << "}}";
+            is_first = false;
+        }
+
+        if (thread_buffer_item->generation.load(std::memory_order_acquire) != generation)
+        {
+            continue; // nothing recorded by this thread during the capture
+        }
+
+        // a zone opened before EndCapture() may still be appended meanwhile, the events below count stay untouched
+        uint32_t event_count = thread_buffer_item->count.load(std::memory_order_acquire);
+        for (uint32_t event_index = 0; event_index < event_count; event_index++)
+        {
+            const TraceEvent &event = thread_buffer_item->events[event_index];
+            uint64_t begin = event.begin > capture_begin ? event.begin - capture_begin : 0;
+            uint64_t end = event.end > capture_begin ? event.end - capture_begin : 0;
+
+            out_stream << (is_first ? "\n" : ",\n") << "{\"name\":";
+            WriteJsonString(out_stream, event.name);
+            // Chrome trace timestamps are microseconds
+            out_stream << ",\"cat\":\"PointCloud\",\"ph\":\"X\",\"ts\":" << begin / 1000.0 << ",\"dur\":" << (end - begin) / 1000.0 << ",\"pid\":1,\"tid\":" << thread_buffer_item->id << "}";
+            is_first = false;
+        }
+    }
+
+    out_stream << "\n]}\n";
+    return out_stream.good();
+}
+
+void Trace::SetThreadName(const std::string &name)
+{
+    ThreadBuffer &thread_buffer = GetThreadBuffer();
+    std::lock_guard<std::mutex> lock(registry_mutex);
+    thread_buffer.name = name;
+}
+
+void Trace::Record(const char *name, uint64_t begin, uint64_t end)
+{
+    if (!Trace::IsCapturing())
+    {
+        return;
+    }
+
+    ThreadBuffer &thread_buffer = GetThreadBuffer();
+    uint32_t generation = capture_generation.load(std::memory_order_acquire);
+    if (thread_buffer.generation.load(std::memory_order_relaxed) != generation)
+    {
+        thread_buffer.count.store(0, std::memory_order_relaxed);
+        thread_buffer.generation.store(generation, std::memory_order_release);
+    }
+
+    uint32_t count = thread_buffer.count.load(std::memory_order_relaxed);
+    if (count >= Trace::MAX_EVENT_COUNT)
+    {
+        dropped_event_count.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    TraceEvent &event = thread_buffer.events[count];
+    event.name = name;
+    event.begin = begin;
+    event.end = end;
+    thread_buffer.count.store(count + 1, std::memory_order_release);
+}
+
+uint32_t Trace::GetDroppedEventCount()
+{
+    return dropped_event_count.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,65 @@
+#pragma once
+#ifndef POINTCLOUD_TRACE_H
+#define POINTCLOUD_TRACE_H
+#include <cstdint>
+#include <string>
+
+// CPU zones recorded into per-thread buffers and written as Chrome trace JSON (chrome://tracing, ui.perfetto.dev).
+// Recording never takes a lock: every thread appends to its own buffer and publishes the new event count with a release store,
+// only the first event of a thread locks once to register its buffer. Nothing is recorded outside BeginCapture()/EndCapture().
+class Trace
+{
+  public:
+    static constexpr uint32_t MAX_EVENT_COUNT = 1 << 16; // per thread and capture, later events are dropped
+
+  public:
+    static uint64_t Now(); // nanosecond, steady clock
+
+    static bool IsCapturing();
+    static void BeginCapture();
+    // Stop recording and write every event of the capture to path
+    static bool EndCapture(const std::string &path);
+
+    // Show up as the thread name in the trace viewer
+    static void SetThreadName(const std::string &name);
+
+    // name must outlive the capture, use string literals
+    static void Record(const char *name, uint64_t begin, uint64_t end);
+
+    static uint32_t GetDroppedEventCount(); // of the last capture
+};
+
+class TraceZone
+{
+  private:
+    const char *name;
+    uint64_t begin = 0;
+    bool isCapturing;
+
+  public:
+    explicit TraceZone(const char *name) : name(name), isCapturing(Trace::IsCapturing())
+    {
+        if (this->isCapturing)
+        {
+            this->begin = Trace::Now();
+        }
+    }
+
+    ~TraceZone()
+    {
+        if (this->isCapturing)
+        {
+            Trace::Record(this->name, this->begin, Trace::Now());
+        }
+    }
+
+    TraceZone(const TraceZone &) = delete;
+    TraceZone &operator=(const TraceZone &) = delete;
+};
+
+#define POINTCLOUD_TRACE_CONCAT_IMPL(a, b) a##b
+#define POINTCLOUD_TRACE_CONCAT(a, b) POINTCLOUD_TRACE_CONCAT_IMPL(a, b)
+// Record the rest of the enclosing scope as a zone
+#define TRACE_ZONE(name) TraceZone POINTCLOUD_TRACE_CONCAT(trace_zone_, __LINE__)(name)
+
+#endif // !POINTCLOUD_TRACE_H
@@ -0,0 +1,616 @@
+#include "UploadBenchmark.h"
+#include "HeadlessBenchmark.h"
+#include "PointCloudUpload.h"
+#include "WorkerPool.h"
+
+#include "../core/include/TBarrier.h"
+#include "../core/include/TCommandBuffer.h"
+#include "../core/include/TCommandBufferPool.h"
+#include "../core/include/TDevice.h"
+#include "../core/include/TDeviceQueue.h"
+#include "../core/include/TFence.h"
+#include "../core/include/TInstance.h"
+#include "../core/include/TPhysicalDevice.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+namespace
+{
+// optimalBufferCopyOffsetAlignment is at most 256 on desktop and software ICDs, and a multiple of every texel size used here
+const Turbo::Core::TDeviceSize STAGING_ALIGNMENT = 256;
+
+typedef struct UploadConfiguration
+{
+    std::string path; // "staged", "mapped", or the name of the PointCloudUpload.h function used as the reference
+    UploadStorage storage;
+    UploadFormat format;
+    uint32_t chunkSize;
+    uint32_t stagingRingSize; // MB
+    uint32_t submitBatchSize;
+} UploadConfiguration;
+
+typedef struct UploadResult
+{
+    UploadConfiguration configuration;
+    std::string skipReason; // empty if the configuration ran
+    uint64_t byteSize = 0;  // device side position + color
+    uint32_t chunkCount = 0;
+    uint32_t submitCount = 0;
+    double firstFrameTime = 0; // millisecond
+    double totalTime = 0;      // millisecond
+} UploadResult;
+
+typedef struct UploadChunk
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> positionImage;
+    Turbo::Core::TRefPtr<Turbo::Core::TImage> colorImage;
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> positionBuffer;
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> colorBuffer;
+    PointsBounds bounds;
+} UploadChunk;
+
+typedef struct UploadSubmission
+{
+    Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> commandBuffer;
+    Turbo::Core::TRefPtr<Turbo::Core::TFence> fence;
+    uint64_t stagingRingEnd = 0;                                            // the ring bytes before it are free once the fence signaled
+    std::vector<Turbo::Core::TRefPtr<Turbo::Core::TBuffer>> stagingBuffers; // stagingRingSize == 0
+} UploadSubmission;
+
+double GetElapsedMilliseconds(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+Turbo::Core::TDeviceSize AlignUp(Turbo::Core::TDeviceSize size, Turbo::Core::TDeviceSize alignment)
+{
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+const char *ToString(UploadStorage storage)
+{
+    switch (storage)
+    {
+    case UploadStorage::IMAGE:
+        return "image";
+    case UploadStorage::BUFFER_STAGED:
+        return "buffer_staged";
+    case UploadStorage::BUFFER_MAPPED:
+        return "buffer_mapped";
+    }
+    return "";
+}
+
+const char *ToString(UploadFormat format)
+{
+    switch (format)
+    {
+    case UploadFormat::RGBA32F:
+        return "rgba32f";
+    case UploadFormat::RGBA16F:
+        return "rgba16f";
+    case UploadFormat::RGBA32F_RGBA8:
+        return "rgba32f_rgba8";
+    }
+    return "";
+}
+
+Turbo::Core::TFormatType GetPositionFormat(UploadFormat format)
+{
+    return format == UploadFormat::RGBA16F ? Turbo::Core::TFormatType::R16G16B16A16_SFLOAT : Turbo::Core::TFormatType::R32G32B32A32_SFLOAT;
+}
+
+Turbo::Core::TFormatType GetColorFormat(UploadFormat format)
+{
+    switch (format)
+    {
+    case UploadFormat::RGBA16F:
+        return Turbo::Core::TFormatType::R16G16B16A16_SFLOAT;
+    case UploadFormat::RGBA32F_RGBA8:
+        return Turbo::Core::TFormatType::R8G8B8A8_UNORM;
+    default:
+        return Turbo::Core::TFormatType::R32G32B32A32_SFLOAT;
+    }
+}
+
+Turbo::Core::TDeviceSize GetPositionSize(UploadFormat format)
+{
+    return format == UploadFormat::RGBA16F ? sizeof(uint64_t) : sizeof(POSITION);
+}
+
+Turbo::Core::TDeviceSize GetColorSize(UploadFormat format)
+{
+    switch (format)
+    {
+    case UploadFormat::RGBA16F:
+        return sizeof(uint64_t);
+    case UploadFormat::RGBA32F_RGBA8:
+        return sizeof(uint32_t);
+    default:
+        return sizeof(COLOR);
+    }
+}
+
+// PackPointsChunk for RGBA32F, the other formats convert while packing and compute the same bounds so every path does the same work
+PointsBounds PackUploadChunk(const Point *points, size_t count, UploadFormat format, void *positionDst, void *colorDst)
+{
+    if (format == UploadFormat::RGBA32F)
+    {
+        return PackPointsChunk(points, count, static_cast<POSITION *>(positionDst), static_cast<COLOR *>(colorDst));
+    }
+
+    glm::vec3 bounds_min(FLT_MAX);
+    glm::vec3 bounds_max(-FLT_MAX);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const POSITION &position = points[i].position;
+        const COLOR &color = points[i].color;
+        if (format == UploadFormat::RGBA16F)
+        {
+            static_cast<uint64_t *>(positionDst)[i] = glm::packHalf4x16(glm::vec4(position.x, position.y, position.z, position.w));
+            static_cast<uint64_t *>(colorDst)[i] = glm::packHalf4x16(glm::vec4(color.r, color.g, color.b, color.a));
+        }
+        else
+        {
+            static_cast<POSITION *>(positionDst)[i] = position;
+            static_cast<uint32_t *>(colorDst)[i] = glm::packUnorm4x8(glm::vec4(color.r, color.g, color.b, color.a));
+        }
+
+        bounds_min = glm::min(bounds_min, glm::vec3(position.x, position.y, position.z));
+        bounds_max = glm::max(bounds_max, glm::vec3(position.x, position.y, position.z));
+    }
+
+    PointsBounds bounds;
+    bounds.min = {bounds_min.x, bounds_min.y, bounds_min.z, 0};
+    bounds.max = {bounds_max.x, bounds_max.y, bounds_max.z, 0};
+    bounds.centre = {(bounds_min.x + bounds_max.x) * 0.5f, (bounds_min.y + bounds_max.y) * 0.5f, (bounds_min.z + bounds_max.z) * 0.5f, 0};
+    return bounds;
+}
+
+std::vector<Point> GenerateUploadBenchmarkPoints(uint64_t count)
+{
+    std::vector<Point> points(count);
+    std::minstd_rand random(42);
+    std::uniform_real_distribution<float> distribution(0.0f, 1.0f);
+    for (Point &point : points)
+    {
+        point.position = {distribution(random) * 100.0f - 50.0f, distribution(random) * 100.0f - 50.0f, distribution(random) * 100.0f - 50.0f, 1.0f};
+        point.color = {distribution(random), distribution(random), distribution(random), 1.0f};
+    }
+    return points;
+}
+
+// PointsStorageType::IMAGE/BUFFER through a staging buffer: pack into the staging ring (or a buffer per chunk), record the copies of
+// submitBatchSize chunks into one command buffer, submit it with one fence, and only wait for a fence when the ring is full or at the end
+void RunStagedUpload(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> &queue, const Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> &commandPool, const std::vector<Point> &points, UploadResult &result)
+{
+    const UploadConfiguration &configuration = result.configuration;
+    bool is_image = configuration.storage == UploadStorage::IMAGE;
+    size_t chunk_content_size = static_cast<size_t>(configuration.chunkSize) * configuration.chunkSize;
+    size_t chunk_count = (points.size() + chunk_content_size - 1) / chunk_content_size;
+    Turbo::Core::TDeviceSize position_size = GetPositionSize(configuration.format);
+    Turbo::Core::TDeviceSize color_size = GetColorSize(configuration.format);
+
+    uint64_t ring_size = static_cast<uint64_t>(configuration.stagingRingSize) << 20;
+    if (ring_size > 0 && AlignUp(AlignUp(chunk_content_size * position_size, STAGING_ALIGNMENT) + chunk_content_size * color_size, STAGING_ALIGNMENT) > ring_size)
+    {
+        result.skipReason = "a chunk does not fit into the staging ring";
+        return;
+    }
+
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    Turbo::Core::TRefPtr<Turbo::Core::TBuffer> staging_ring;
+    uint8_t *staging_ring_ptr = nullptr;
+    if (ring_size > 0)
+    {
+        staging_ring = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::MAPPED | Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, ring_size);
+        staging_ring_ptr = static_cast<uint8_t *>(staging_ring->Map());
+    }
+
+    std::vector<UploadChunk> chunks(chunk_count);
+    std::deque<UploadSubmission> submissions;
+    UploadSubmission current_submission;
+    uint32_t current_chunk_count = 0;
+    uint64_t ring_head = 0; // monotonic byte counters, the ring offset is counter % ring_size
+    uint64_t ring_tail = 0;
+
+    auto retire = [&]() {
+        UploadSubmission &submission = submissions.front();
+        submission.fence->WaitUntil();
+        ring_tail = submission.stagingRingEnd;
+        commandPool->Free(submission.commandBuffer);
+        submissions.pop_front();
+    };
+
+    auto submit = [&]() {
+        if (!is_image)
+        {
+            // the image copies already made themselves visible with their layout transitions
+            Turbo::Core::TMemoryBarrier memory_barrier(Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT);
+            current_submission.commandBuffer->CmdPipelineMemoryBarrier(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::VERTEX_SHADER_BIT, memory_barrier);
+        }
+        current_submission.commandBuffer->End();
+        current_submission.fence = new Turbo::Core::TFence(device);
+        current_submission.stagingRingEnd = ring_head;
+        queue->Submit(current_submission.commandBuffer, current_submission.fence);
+        submissions.push_back(current_submission);
+        current_submission = UploadSubmission();
+        current_chunk_count = 0;
+
+        if (++result.submitCount == 1)
+        {
+            // a progressive loader would draw its first frame now
+            retire();
+            result.firstFrameTime = GetElapsedMilliseconds(start_time);
+        }
+    };
+
+    for (size_t chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    {
+        size_t count = std::min(chunk_content_size, points.size() - chunk_index * chunk_content_size);
+        Turbo::Core::TDeviceSize color_offset = AlignUp(count * position_size, STAGING_ALIGNMENT);
+        Turbo::Core::TDeviceSize staging_size = AlignUp(color_offset + count * color_size, STAGING_ALIGNMENT);
+
+        Turbo::Core::TRefPtr<Turbo::Core::TBuffer> staging_buffer;
+        Turbo::Core::TDeviceSize staging_offset = 0;
+        uint8_t *staging_ptr = nullptr;
+        if (ring_size > 0)
+        {
+            while (true)
+            {
+                if (ring_head == ring_tail)
+                {
+                    // nothing in flight, start over at the beginning instead of padding to it
+                    ring_head = 0;
+                    ring_tail = 0;
+                }
+
+                // a chunk never wraps around the end of the ring, the rest of the ring is skipped
+                uint64_t ring_offset = ring_head % ring_size;
+                uint64_t padding = ring_offset + staging_size > ring_size ? ring_size - ring_offset : 0;
+                if (ring_head + padding + staging_size - ring_tail <= ring_size)
+                {
+                    staging_offset = (ring_head + padding) % ring_size;
+                    ring_head += padding + staging_size;
+                    break;
+                }
+
+                // with nothing in flight the ring is held by the chunks of the current submission
+                if (submissions.empty())
+                {
+                    submit();
+                }
+                else
+                {
+                    retire();
+                }
+            }
+
+            staging_buffer = staging_ring;
+            staging_ptr = staging_ring_ptr + staging_offset;
+        }
+        else
+        {
+            staging_buffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_SRC, Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, staging_size);
+            staging_ptr = static_cast<uint8_t *>(staging_buffer->Map());
+        }
+
+        UploadChunk &chunk = chunks[chunk_index];
+        chunk.bounds = PackUploadChunk(points.data() + chunk_index * chunk_content_size, count, configuration.format, staging_ptr, staging_ptr + color_offset);
+
+        if (ring_size > 0)
+        {
+            // Flush is a no-op on HOST_COHERENT memory
+            staging_ring->Flush(staging_offset, staging_size);
+        }
+        else
+        {
+            staging_buffer->Unmap();
+            current_submission.stagingBuffers.push_back(staging_buffer);
+        }
+
+        if (current_submission.commandBuffer.Get() == nullptr)
+        {
+            current_submission.commandBuffer = commandPool->Allocate();
+            current_submission.commandBuffer->Begin();
+        }
+        Turbo::Core::TRefPtr<Turbo::Core::TCommandBuffer> &command_buffer = current_submission.commandBuffer;
+
+        if (is_image)
+        {
+            uint32_t tex_size = configuration.chunkSize;
+            chunk.positionImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, GetPositionFormat(configuration.format), tex_size, tex_size, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+            chunk.colorImage = new Turbo::Core::TImage(device, 0, Turbo::Core::TImageType::DIMENSION_2D, GetColorFormat(configuration.format), tex_size, tex_size, 1, 1, 1, Turbo::Core::TSampleCountBits::SAMPLE_1_BIT, Turbo::Core::TImageTiling::OPTIMAL, Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE, Turbo::Core::TMemoryFlagsBits::DEDICATED_MEMORY, Turbo::Core::TImageLayout::UNDEFINED);
+
+            command_buffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::HOST_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TAccessBits::HOST_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, chunk.positionImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+            command_buffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::HOST_BIT, Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TAccessBits::HOST_WRITE_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TImageLayout::UNDEFINED, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, chunk.colorImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+
+            uint32_t row_count = static_cast<uint32_t>(count / tex_size);
+            uint32_t remaining_points = static_cast<uint32_t>(count % tex_size);
+            if (row_count > 0)
+            {
+                command_buffer->CmdCopyBufferToImage(staging_buffer, chunk.positionImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, staging_offset, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, tex_size, row_count, 1);
+                command_buffer->CmdCopyBufferToImage(staging_buffer, chunk.colorImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, staging_offset + color_offset, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, 0, 0, tex_size, row_count, 1);
+            }
+            if (remaining_points > 0)
+            {
+                command_buffer->CmdCopyBufferToImage(staging_buffer, chunk.positionImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, staging_offset + row_count * tex_size * position_size, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, row_count, 0, remaining_points, 1, 1);
+                command_buffer->CmdCopyBufferToImage(staging_buffer, chunk.colorImage, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, staging_offset + color_offset + row_count * tex_size * color_size, 0, 0, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 0, 1, 0, row_count, 0, remaining_points, 1, 1);
+            }
+
+            command_buffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::VERTEX_SHADER_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, Turbo::Core::TImageLayout::GENERAL, chunk.positionImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+            command_buffer->CmdTransformImageLayout(Turbo::Core::TPipelineStageBits::TRANSFER_BIT, Turbo::Core::TPipelineStageBits::VERTEX_SHADER_BIT, Turbo::Core::TAccessBits::TRANSFER_WRITE_BIT, Turbo::Core::TAccessBits::SHADER_READ_BIT, Turbo::Core::TImageLayout::TRANSFER_DST_OPTIMAL, Turbo::Core::TImageLayout::GENERAL, chunk.colorImage, Turbo::Core::TImageAspectBits::ASPECT_COLOR_BIT, 0, 1, 0, 1);
+        }
+        else
+        {
+            chunk.positionBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_DST, 0, count * position_size);
+            chunk.colorBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER | Turbo::Core::TBufferUsageBits::BUFFER_TRANSFER_DST, 0, count * color_size);
+            command_buffer->CmdCopyBuffer(staging_buffer, chunk.positionBuffer, staging_offset, 0, count * position_size);
+            command_buffer->CmdCopyBuffer(staging_buffer, chunk.colorBuffer, staging_offset + color_offset, 0, count * color_size);
+        }
+
+        result.byteSize += count * (position_size + color_size);
+        if (++current_chunk_count >= configuration.submitBatchSize)
+        {
+            submit();
+        }
+    }
+
+    if (current_chunk_count > 0)
+    {
+        submit();
+    }
+    while (!submissions.empty())
+    {
+        retire();
+    }
+
+    result.totalTime = GetElapsedMilliseconds(start_time);
+    result.chunkCount = static_cast<uint32_t>(chunk_count);
+
+    if (staging_ring.Get() != nullptr)
+    {
+        staging_ring->Unmap();
+    }
+}
+
+// PointsStorageType::BUFFER packed on this thread, so the formats and chunk sizes compare against the staged paths without the worker pool
+void RunMappedUpload(const Turbo::Core::TRefPtr<Turbo::Core::TDevice> &device, const std::vector<Point> &points, UploadResult &result)
+{
+    const UploadConfiguration &configuration = result.configuration;
+    size_t chunk_content_size = static_cast<size_t>(configuration.chunkSize) * configuration.chunkSize;
+    size_t chunk_count = (points.size() + chunk_content_size - 1) / chunk_content_size;
+    Turbo::Core::TDeviceSize position_size = GetPositionSize(configuration.format);
+    Turbo::Core::TDeviceSize color_size = GetColorSize(configuration.format);
+
+    std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+
+    std::vector<UploadChunk> chunks(chunk_count);
+    for (size_t chunk_index = 0; chunk_index < chunk_count; chunk_index++)
+    {
+        size_t count = std::min(chunk_content_size, points.size() - chunk_index * chunk_content_size);
+
+        UploadChunk &chunk = chunks[chunk_index];
+        chunk.positionBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, Turbo::Core::TMemoryFlagsBits::MAPPED | Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, count * position_size);
+        chunk.colorBuffer = new Turbo::Core::TBuffer(device, 0, Turbo::Core::TBufferUsageBits::BUFFER_STORAGE_BUFFER, Turbo::Core::TMemoryFlagsBits::MAPPED | Turbo::Core::TMemoryFlagsBits::HOST_ACCESS_SEQUENTIAL_WRITE, count * color_size);
+
+        chunk.bounds = PackUploadChunk(points.data() + chunk_index * chunk_content_size, count, configuration.format, chunk.positionBuffer->Map(), chunk.colorBuffer->Map());
+
+        chunk.positionBuffer->Flush();
+        chunk.colorBuffer->Flush();
+        chunk.positionBuffer->Unmap();
+        chunk.colorBuffer->Unmap();
+
+        result.byteSize += count * (position_size + color_size);
+        if (chunk_index == 0)
+        {
+            // host writes are visible to the next submission, no fence to wait for
+            result.firstFrameTime = GetElapsedMilliseconds(start_time);
+        }
+    }
+
+    result.totalTime = GetElapsedMilliseconds(start_time);
+    result.chunkCount = static_cast<uint32_t>(chunk_count);
+}
+
+void WriteJsonString(std::ofstream &outStream, const std::string &value)
+{
+    outStream << '"';
+    for (char c : value)
+    {
+        if (c == '"' || c == '\\')
+        {
+            outStream << '\\';
+        }
+        outStream << c;
+    }
+    outStream << '"';
+}
+
+double GetGigabytePerSecond(const UploadResult &result)
+{
+    return result.totalTime > 0 ? result.byteSize / (result.totalTime / 1000.0) / (1024.0 * 1024.0 * 1024.0) : 0;
+}
+} // namespace
+
+bool ParseUploadBenchmarkList(const std::string &text, std::vector<uint32_t> &values)
+{
+    std::vector<uint32_t> result;
+    std::stringstream text_stream(text);
+    std::string item;
+    while (std::getline(text_stream, item, ','))
+    {
+        char *end = nullptr;
+        unsigned long value = strtoul(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0')
+        {
+            return false;
+        }
+        result.push_back(static_cast<uint32_t>(value));
+    }
+
+    if (result.empty())
+    {
+        return false;
+    }
+
+    values = result;
+    return true;
+}
+
+int RunUploadBenchmark(const UploadBenchmarkOptions &options)
+{
+    // no layers and no surface extensions, validation would only distort the timings
+    Turbo::Core::TVersion instance_version(1, 2, 0, 0);
+    Turbo::Core::TRefPtr<Turbo::Core::TInstance> instance = new Turbo::Core::TInstance(nullptr, nullptr, &instance_version);
+    Turbo::Core::TRefPtr<Turbo::Core::TPhysicalDevice> physical_device = FindPhysicalDevice(instance, options.deviceName);
+    if (physical_device.Get() == nullptr)
+    {
+        std::cerr << "No physical device matches " << options.deviceName << std::endl;
+        return 1;
+    }
+    std::cout << "Upload benchmark on " << physical_device->GetDeviceName() << std::endl;
+
+    Turbo::Core::TRefPtr<Turbo::Core::TDevice> device = new Turbo::Core::TDevice(physical_device, nullptr, nullptr, nullptr);
+    Turbo::Core::TRefPtr<Turbo::Core::TDeviceQueue> queue = device->GetBestGraphicsQueue();
+    Turbo::Core::TRefPtr<Turbo::Core::TCommandBufferPool> command_pool = new Turbo::Core::TCommandBufferPool(queue);
+    DevicePools device_pools(queue);
+    WorkerPool worker_pool;
+
+    std::vector<Point> points = GenerateUploadBenchmarkPoints(options.pointCount);
+    bool is_support_direct_write = IsSupportDirectWriteUpload(physical_device, points.size() * (sizeof(POSITION) + sizeof(COLOR)));
+
+    // what the viewer runs today first, every other row reads against it
+    std::vector<UploadConfiguration> configurations;
+    configurations.push_back({"CreateAllPointsImageData", UploadStorage::IMAGE, UploadFormat::RGBA32F, TEX_SIZE, 0, 1});
+    configurations.push_back({"CreateAllPointsBufferData", UploadStorage::BUFFER_MAPPED, UploadFormat::RGBA32F, TEX_SIZE, 0, 0});
+    for (uint32_t chunk_size : options.chunkSizes)
+    {
+        for (UploadStorage storage : options.storages)
+        {
+            for (UploadFormat format : options.formats)
+            {
+                if (storage == UploadStorage::BUFFER_MAPPED)
+                {
+                    configurations.push_back({"mapped", storage, format, chunk_size, 0, 0});
+                    continue;
+                }
+
+                for (uint32_t staging_ring_size : options.stagingRingSizes)
+                {
+                    for (uint32_t submit_batch_size : options.submitBatchSizes)
+                    {
+                        configurations.push_back({"staged", storage, format, chunk_size, staging_ring_size, std::max(1u, submit_batch_size)});
+                    }
+                }
+            }
+        }
+    }
+
+    uint32_t max_image_size = physical_device->GetDeviceLimits().maxImageDimension2D;
+    Turbo::Core::TImageUsages image_usages = Turbo::Core::TImageUsageBits::IMAGE_TRANSFER_DST | Turbo::Core::TImageUsageBits::IMAGE_SAMPLED | Turbo::Core::TImageUsageBits::IMAGE_STORAGE;
+
+    std::vector<UploadResult> results;
+    for (const UploadConfiguration &configuration : configurations)
+    {
+        UploadResult best_result;
+        best_result.configuration = configuration;
+
+        if (configuration.chunkSize == 0)
+        {
+            best_result.skipReason = "chunk size 0";
+        }
+        else if (configuration.storage == UploadStorage::BUFFER_MAPPED && !is_support_direct_write)
+        {
+            best_result.skipReason = "no device local and host visible heap large enough";
+        }
+        else if (configuration.storage == UploadStorage::IMAGE && configuration.chunkSize > max_image_size)
+        {
+            best_result.skipReason = "chunk size above maxImageDimension2D";
+        }
+        else if (configuration.storage == UploadStorage::IMAGE && (!physical_device->IsFormatSupportImage(GetPositionFormat(configuration.format), Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TImageTiling::OPTIMAL, image_usages, 0) || !physical_device->IsFormatSupportImage(GetColorFormat(configuration.format), Turbo::Core::TImageType::DIMENSION_2D, Turbo::Core::TImageTiling::OPTIMAL, image_usages, 0)))
+        {
+            best_result.skipReason = "format not supported as storage image";
+        }
+
+        for (uint32_t repeat_index = 0; repeat_index < std::max(1u, options.repeatCount) && best_result.skipReason.empty(); repeat_index++)
+        {
+            UploadResult result;
+            result.configuration = configuration;
+
+            if (configuration.path == "CreateAllPointsImageData" || configuration.path == "CreateAllPointsBufferData")
+            {
+                std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+                std::vector<PointsChunkData> points_chunk_datas = configuration.storage == UploadStorage::IMAGE ? CreateAllPointsImageData(points, device, device_pools) : CreateAllPointsBufferData(points, device, worker_pool);
+                result.totalTime = GetElapsedMilliseconds(start_time);
+                result.firstFrameTime = result.totalTime; // the viewer draws nothing before every chunk is resident
+                result.byteSize = points.size() * (sizeof(POSITION) + sizeof(COLOR));
+                result.chunkCount = static_cast<uint32_t>(points_chunk_datas.size());
+                result.submitCount = configuration.storage == UploadStorage::IMAGE ? result.chunkCount : 0;
+            }
+            else if (configuration.storage == UploadStorage::BUFFER_MAPPED)
+            {
+                RunMappedUpload(device, points, result);
+            }
+            else
+            {
+                RunStagedUpload(device, queue, command_pool, points, result);
+            }
+
+            device->WaitIdle();
+            if (!result.skipReason.empty() || repeat_index == 0 || result.totalTime < best_result.totalTime)
+            {
+                best_result = result;
+            }
+        }
+
+        if (best_result.skipReason.empty())
+        {
+            std::cout << "Upload::" << configuration.path << "::" << ToString(configuration.storage) << "::" << ToString(configuration.format) << "::chunk::" << configuration.chunkSize << "::ring::" << configuration.stagingRingSize << "MB::batch::" << configuration.submitBatchSize << "::" << GetGigabytePerSecond(best_result) << "GB/s::first frame::" << best_result.firstFrameTime << "ms::total::" << best_result.totalTime << "ms" << std::endl;
+        }
+        results.push_back(best_result);
+    }
+
+    std::ofstream out_stream(options.outputFile, std::ios::trunc);
+    if (!out_stream.is_open())
+    {
+        std::cerr << "Failed to write " << options.outputFile << std::endl;
+        return 1;
+    }
+
+    out_stream << "{\n  \"device\": ";
+    WriteJsonString(out_stream, physical_device->GetDeviceName());
+    out_stream << ",\n  \"points\": " << points.size() << ",\n  \"direct_write\": " << (is_support_direct_write ? "true" : "false") << ",\n  \"results\": [\n";
+    for (size_t result_index = 0; result_index < results.size(); result_index++)
+    {
+        const UploadResult &result = results[result_index];
+        const UploadConfiguration &configuration = result.configuration;
+        out_stream << "    {\"path\": \"" << configuration.path << "\", \"storage\": \"" << ToString(configuration.storage) << "\", \"format\": \"" << ToString(configuration.format) << "\", \"chunk_size\": " << configuration.chunkSize;
+        out_stream << ", \"staging_ring_mb\": " << configuration.stagingRingSize << ", \"submit_batch\": " << configuration.submitBatchSize;
+        if (!result.skipReason.empty())
+        {
+            out_stream << ", \"skipped\": \"" << result.skipReason << "\"";
+        }
+        else
+        {
+            out_stream << ", \"chunks\": " << result.chunkCount << ", \"submits\": " << result.submitCount << ", \"bytes\": " << result.byteSize;
+            out_stream << ", \"gb_per_second\": " << GetGigabytePerSecond(result) << ", \"first_frame_ms\": " << result.firstFrameTime << ", \"total_ms\": " << result.totalTime;
+        }
+        out_stream << "}" << (result_index + 1 < results.size() ? "," : "") << "\n";
+    }
+    out_stream << "  ]\n}\n";
+
+    return out_stream.good() ? 0 : 1;
+}
@@ -0,0 +1,46 @@
+#pragma once
+#ifndef POINTCLOUD_UPLOADBENCHMARK_H
+#define POINTCLOUD_UPLOADBENCHMARK_H
+#include <cstdint>
+#include <string>
+#include <vector>
+
+typedef enum class UploadStorage
+{
+    IMAGE,         // staging buffer -> CmdCopyBufferToImage -> storage image, what CreateAllPointsImageData does
+    BUFFER_STAGED, // staging buffer -> CmdCopyBuffer -> device local storage buffer
+    BUFFER_MAPPED, // packed straight into a mapped storage buffer, what CreateAllPointsBufferData does (needs IsSupportDirectWriteUpload)
+} UploadStorage;
+
+typedef enum class UploadFormat
+{
+    RGBA32F,       // POSITION and COLOR as they are today, 32 byte per point
+    RGBA16F,       // half position and half color, 16 byte per point
+    RGBA32F_RGBA8, // float position and unorm8 color, 20 byte per point
+} UploadFormat;
+
+typedef struct UploadBenchmarkOptions
+{
+    std::string outputFile = "./upload_benchmark.json";
+    std::string deviceName;            // pick the first physical device whose name contains it (e.g. "llvmpipe"), the best one if empty
+    uint64_t pointCount = 4000000;     // synthetic points, position and color uniform in a cube
+    uint32_t repeatCount = 2;          // every configuration is uploaded that many times, the fastest run is reported
+
+    std::vector<uint32_t> chunkSizes = {256, 512, 1024}; // side of the square chunk, a chunk holds size * size points
+    std::vector<UploadStorage> storages = {UploadStorage::IMAGE, UploadStorage::BUFFER_STAGED, UploadStorage::BUFFER_MAPPED};
+    std::vector<UploadFormat> formats = {UploadFormat::RGBA32F, UploadFormat::RGBA16F, UploadFormat::RGBA32F_RGBA8};
+    std::vector<uint32_t> stagingRingSizes = {0, 16, 64}; // MB, 0: a staging buffer per chunk released after its submission like CreateAllPointsImageData
+    std::vector<uint32_t> submitBatchSizes = {1, 8};      // chunks recorded into one command buffer per queue submission and fence
+} UploadBenchmarkOptions;
+
+// Upload synthetic points with every combination of the option lists (BUFFER_MAPPED ignores the staging ring and the batching),
+// plus the unchanged CreateAllPointsImageData/CreateAllPointsBufferData as the reference, and write GB/s and time to first frame
+// of each as JSON to options.outputFile. No layers, no surface, works on software ICDs such as lavapipe. Return the process exit code.
+// NOTE: time to first frame is from the start of the upload until the first submission has landed (its fence signaled),
+//       the earliest a loader which draws the chunks as they arrive could show points. The reference paths only return once every chunk is resident.
+int RunUploadBenchmark(const UploadBenchmarkOptions &options);
+
+// "256,512,1024" -> {256, 512, 1024}, false if an item is not a number
+bool ParseUploadBenchmarkList(const std::string &text, std::vector<uint32_t> &values);
+
+#endif // !POINTCLOUD_UPLOADBENCHMARK_H
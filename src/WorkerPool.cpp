@@ -0,0 +1,331 @@
+#include "WorkerPool.h"
+#include "Trace.h"
+
+#include <algorithm>
+#include <string>
+
+namespace
+{
+const uint32_t RANGES_PER_THREAD = 4; // ParallelFor() ranges per thread, the spare ones are there to be stolen
+
+// the pool and the worker index of the calling thread, nullptr outside the workers
+thread_local WorkerPool *current_worker_pool = nullptr;
+thread_local uint32_t current_worker_index = 0;
+} // namespace
+
+class WorkerPool::Task
+{
+  public:
+    std::function<void()> function;
+    TaskAffinity affinity = TaskAffinity::ANY;
+
+    std::atomic<uint32_t> pendingCount{1}; // unfinished dependencies, plus one held by Schedule() until every dependency is registered
+    std::atomic<bool> isFinished{false};
+    std::mutex mutex; // dependents, and isFinished against a new dependent
+    std::vector<TaskHandle> dependents;
+};
+
+WorkerPool::WorkerPool(uint32_t threadCount) : queuedCount(0), waitingCount(0), mainThreadId(std::this_thread::get_id())
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (uint32_t thread_index = 0; thread_index < threadCount; thread_index++)
+    {
+        this->workerQueues.emplace_back(new WorkerQueue());
+    }
+
+    for (uint32_t thread_index = 0; thread_index < threadCount; thread_index++)
+    {
+        this->threads.emplace_back([this, thread_index]() {
+            Trace::SetThreadName("Worker " + std::to_string(thread_index));
+            current_worker_pool = this;
+            current_worker_index = thread_index;
+            this->WorkerLoop();
+        });
+    }
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->isStop = true;
+    }
+    this->condition.notify_all();
+
+    for (std::thread &thread_item : this->threads)
+    {
+        thread_item.join();
+    }
+}
+
+void WorkerPool::WorkerLoop()
+{
+    while (true)
+    {
+        if (this->TryRunTask())
+        {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->condition.wait(lock, [this]() { return this->isStop || this->queuedCount.load() > 0; });
+        // the queued tasks still run after the stop
+        if (this->isStop && this->queuedCount.load() == 0)
+        {
+            return;
+        }
+    }
+}
+
+void WorkerPool::Enqueue(const TaskHandle &task)
+{
+    if (task->affinity == TaskAffinity::MAIN_THREAD)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            this->mainThreadTasks.push_back(task);
+        }
+        // the main thread may sleep in Wait()
+        this->condition.notify_all();
+        return;
+    }
+
+    if (current_worker_pool == this)
+    {
+        WorkerQueue &worker_queue = *this->workerQueues[current_worker_index];
+        std::lock_guard<std::mutex> lock(worker_queue.mutex);
+        worker_queue.tasks.push_back(task);
+        this->queuedCount++;
+    }
+    else
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->tasks.push_back(task);
+        this->queuedCount++;
+    }
+
+    // taking the mutex orders this against a thread between its predicate check and its sleep
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+    }
+    this->condition.notify_one();
+}
+
+void WorkerPool::ReleaseDependency(const TaskHandle &task)
+{
+    if (task->pendingCount.fetch_sub(1) == 1)
+    {
+        this->Enqueue(task);
+    }
+}
+
+void WorkerPool::RunTask(const TaskHandle &task)
+{
+    task->function();
+    task->function = nullptr;
+
+    std::vector<TaskHandle> dependents;
+    {
+        std::lock_guard<std::mutex> lock(task->mutex);
+        task->isFinished = true;
+        dependents.swap(task->dependents);
+    }
+
+    for (const TaskHandle &dependent_item : dependents)
+    {
+        this->ReleaseDependency(dependent_item);
+    }
+
+    if (this->waitingCount.load() > 0)
+    {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+        }
+        this->condition.notify_all();
+    }
+}
+
+bool WorkerPool::TryRunTask()
+{
+    TaskHandle task;
+    if (std::this_thread::get_id() == this->mainThreadId)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->mainThreadTasks.empty())
+        {
+            task = std::move(this->mainThreadTasks.front());
+            this->mainThreadTasks.pop_front();
+        }
+    }
+
+    // the own deque from the back
+    if (!task && current_worker_pool == this)
+    {
+        WorkerQueue &worker_queue = *this->workerQueues[current_worker_index];
+        std::lock_guard<std::mutex> lock(worker_queue.mutex);
+        if (!worker_queue.tasks.empty())
+        {
+            task = std::move(worker_queue.tasks.back());
+            worker_queue.tasks.pop_back();
+            this->queuedCount--;
+        }
+    }
+
+    if (!task)
+    {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        if (!this->tasks.empty())
+        {
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+            this->queuedCount--;
+        }
+    }
+
+    // steal from the front of the others, starting after the own index so the thieves spread out
+    uint32_t worker_count = static_cast<uint32_t>(this->workerQueues.size());
+    uint32_t first_victim_index = current_worker_pool == this ? current_worker_index + 1 : 0;
+    for (uint32_t victim_offset = 0; !task && victim_offset < worker_count; victim_offset++)
+    {
+        WorkerQueue &victim_queue = *this->workerQueues[(first_victim_index + victim_offset) % worker_count];
+        std::lock_guard<std::mutex> lock(victim_queue.mutex);
+        if (!victim_queue.tasks.empty())
+        {
+            task = std::move(victim_queue.tasks.front());
+            victim_queue.tasks.pop_front();
+            this->queuedCount--;
+        }
+    }
+
+    if (!task)
+    {
+        return false;
+    }
+
+    this->RunTask(task);
+    return true;
+}
+
+size_t WorkerPool::GetRangeSize(size_t count) const
+{
+    size_t range_count = std::min<size_t>(count, this->threads.size() * RANGES_PER_THREAD);
+    return (count + range_count - 1) / range_count;
+}
+
+uint32_t WorkerPool::GetThreadCount() const
+{
+    return static_cast<uint32_t>(this->threads.size());
+}
+
+WorkerPool::TaskHandle WorkerPool::Schedule(std::function<void()> &&function, const std::vector<TaskHandle> &dependencies, TaskAffinity affinity)
+{
+    TaskHandle task = std::make_shared<Task>();
+    task->function = std::move(function);
+    task->affinity = affinity;
+
+    for (const TaskHandle &dependency_item : dependencies)
+    {
+        if (!dependency_item)
+        {
+            continue;
+        }
+
+        std::lock_guard<std::mutex> lock(dependency_item->mutex);
+        if (!dependency_item->isFinished)
+        {
+            task->pendingCount++;
+            dependency_item->dependents.push_back(task);
+        }
+    }
+
+    this->ReleaseDependency(task);
+    return task;
+}
+
+void WorkerPool::Wait(const TaskHandle &task)
+{
+    if (!task)
+    {
+        return;
+    }
+
+    bool is_main_thread = std::this_thread::get_id() == this->mainThreadId;
+    while (!task->isFinished)
+    {
+        if (this->TryRunTask())
+        {
+            continue;
+        }
+
+        // nothing to run: the task is running elsewhere or waits on its dependencies
+        this->waitingCount++;
+        {
+            std::unique_lock<std::mutex> lock(this->mutex);
+            this->condition.wait(lock, [&]() { return task->isFinished.load() || this->queuedCount.load() > 0 || (is_main_thread && !this->mainThreadTasks.empty()); });
+        }
+        this->waitingCount--;
+    }
+}
+
+bool WorkerPool::IsFinished(const TaskHandle &task)
+{
+    return !task || task->isFinished;
+}
+
+uint32_t WorkerPool::RunMainThreadTasks()
+{
+    if (std::this_thread::get_id() != this->mainThreadId)
+    {
+        return 0;
+    }
+
+    uint32_t run_count = 0;
+    while (true)
+    {
+        TaskHandle task;
+        {
+            std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->mainThreadTasks.empty())
+            {
+                return run_count;
+            }
+            task = std::move(this->mainThreadTasks.front());
+            this->mainThreadTasks.pop_front();
+        }
+        this->RunTask(task);
+        run_count++;
+    }
+}
+
+void WorkerPool::Push(std::function<void()> &&task)
+{
+    this->Schedule(std::move(task));
+}
+
+void WorkerPool::ParallelFor(size_t count, const std::function<void(size_t begin, size_t end)> &function)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    size_t range_size = this->GetRangeSize(count);
+    std::vector<TaskHandle> range_tasks;
+    for (size_t begin = range_size; begin < count; begin += range_size)
+    {
+        size_t end = std::min(begin + range_size, count);
+        range_tasks.push_back(this->Schedule([&function, begin, end]() { function(begin, end); }));
+    }
+
+    // the calling thread takes the first range instead of idling
+    function(0, std::min(range_size, count));
+
+    for (const TaskHandle &range_task_item : range_tasks)
+    {
+        this->Wait(range_task_item);
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+#ifndef POINTCLOUD_WORKERPOOL_H
+#define POINTCLOUD_WORKERPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+typedef enum class TaskAffinity
+{
+    ANY,         // any worker, or a thread waiting in the pool
+    MAIN_THREAD, // only the thread which created the pool, in RunMainThreadTasks() or while it waits (Vulkan queue submission, GLFW)
+} TaskAffinity;
+
+// Work stealing scheduler shared by the loader, the preprocessing and the renderer.
+// Every worker owns a deque: it pushes and pops its own tasks at the back (the latest, still in its cache), idle workers steal
+// from the front of the others (the oldest, usually the largest part of a split). Tasks scheduled from outside go to a shared queue.
+// A task may depend on other tasks, it is queued once the last of them finished. Waiting inside the pool (Wait(), ParallelFor(),
+// ParallelReduce()) runs pending tasks instead of blocking, so tasks may wait on tasks, std::future::get() still blocks.
+// NOTE: Turbo::Core::TReferenced counts atomically (src/TReferenced.cpp), a task may copy and release TRefPtr<T>s but the Turbo objects are not thread safe
+class WorkerPool
+{
+  public:
+    class Task;
+    typedef std::shared_ptr<Task> TaskHandle;
+
+  private:
+    typedef struct WorkerQueue
+    {
+        std::mutex mutex;
+        std::deque<TaskHandle> tasks;
+    } WorkerQueue;
+
+    std::vector<std::thread> threads;
+    std::vector<std::unique_ptr<WorkerQueue>> workerQueues; // by worker index
+    std::deque<TaskHandle> tasks;                           // scheduled from outside the workers
+    std::deque<TaskHandle> mainThreadTasks;                 // TaskAffinity::MAIN_THREAD
+    std::mutex mutex;                                       // tasks, mainThreadTasks and the sleeping threads
+    std::condition_variable condition;
+    std::atomic<uint32_t> queuedCount;  // tasks in tasks and workerQueues
+    std::atomic<uint32_t> waitingCount; // threads asleep in Wait()
+    std::thread::id mainThreadId;
+    bool isStop = false;
+
+  private:
+    void WorkerLoop();
+    void Enqueue(const TaskHandle &task);
+    void ReleaseDependency(const TaskHandle &task);
+    void RunTask(const TaskHandle &task);
+    bool TryRunTask(); // run one queued task the calling thread may run, false if none
+    size_t GetRangeSize(size_t count) const;
+
+  public:
+    explicit WorkerPool(uint32_t threadCount = 0); // threadCount == 0 means std::thread::hardware_concurrency()
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+  public:
+    uint32_t GetThreadCount() const;
+
+    // Run function once every task of dependencies finished (the finished ones and empty handles are skipped)
+    TaskHandle Schedule(std::function<void()> &&function, const std::vector<TaskHandle> &dependencies = {}, TaskAffinity affinity = TaskAffinity::ANY);
+    // Run queued tasks until task finished. On the main thread the TaskAffinity::MAIN_THREAD tasks run meanwhile too
+    void Wait(const TaskHandle &task);
+    static bool IsFinished(const TaskHandle &task);
+    // Run the TaskAffinity::MAIN_THREAD tasks which are ready, from the thread which created the pool only, return how many ran
+    uint32_t RunMainThreadTasks();
+
+    void Push(std::function<void()> &&task);
+
+    template <typename Function>
+    auto Submit(Function &&function) -> std::future<decltype(function())>;
+
+    // Split [0, count) into contiguous ranges, a few per thread so the stolen ones even out uneven ranges,
+    // run function(begin, end) for each and wait until all finished. The calling thread takes the first range
+    void ParallelFor(size_t count, const std::function<void(size_t begin, size_t end)> &function);
+
+    // combine(identity, rangeFunction(begin, end)) of the ParallelFor() ranges, combined in range order so the result does not
+    // depend on which thread ran which range
+    template <typename T, typename RangeFunction, typename CombineFunction>
+    T ParallelReduce(size_t count, const T &identity, RangeFunction &&rangeFunction, CombineFunction &&combine);
+};
+
+template <typename Function>
+auto WorkerPool::Submit(Function &&function) -> std::future<decltype(function())>
+{
+    using Result = decltype(function());
+    std::shared_ptr<std::packaged_task<Result()>> task = std::make_shared<std::packaged_task<Result()>>(std::forward<Function>(function));
+    std::future<Result> result = task->get_future();
+    this->Push([task]() { (*task)(); });
+    return result;
+}
+
+template <typename T, typename RangeFunction, typename CombineFunction>
+T WorkerPool::ParallelReduce(size_t count, const T &identity, RangeFunction &&rangeFunction, CombineFunction &&combine)
+{
+    if (count == 0)
+    {
+        return identity;
+    }
+
+    size_t range_size = this->GetRangeSize(count);
+    std::vector<T> range_results((count + range_size - 1) / range_size, identity);
+    this->ParallelFor(count, [&](size_t begin, size_t end) { range_results[begin / range_size] = rangeFunction(begin, end); });
+
+    T result = identity;
+    for (const T &range_result : range_results)
+    {
+        result = combine(result, range_result);
+    }
+    return result;
+}
+
+#endif // !POINTCLOUD_WORKERPOOL_H
@@ -0,0 +1,249 @@
+#include "WorkerPoolBenchmark.h"
+#include "WorkerPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+typedef struct BenchmarkRow
+{
+    std::string name;
+    uint32_t threadCount = 0;
+    uint64_t itemCount = 0; // tasks of the overhead rows, items of the scaling rows
+    double time = 0;        // ms, the fastest repeat
+    double speedup = 0;     // of the serial loop, scaling rows only
+    bool isCorrect = true;
+} BenchmarkRow;
+
+double GetElapsedMilliseconds(std::chrono::steady_clock::time_point startTime)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
+
+// integer work so every split of the sum gives the same result
+uint64_t GetItemWork(uint64_t item)
+{
+    uint64_t value = item + 0x9E3779B97F4A7C15ull;
+    for (uint32_t round_index = 0; round_index < 32; round_index++)
+    {
+        value ^= value >> 31;
+        value *= 0xBF58476D1CE4E5B9ull;
+    }
+    return value;
+}
+
+uint64_t GetRangeWork(size_t begin, size_t end)
+{
+    uint64_t sum = 0;
+    for (size_t item = begin; item < end; item++)
+    {
+        sum += GetItemWork(item);
+    }
+    return sum;
+}
+
+template <typename Function>
+double GetFastestTime(uint32_t repeatCount, Function &&function)
+{
+    double fastest_time = 0;
+    for (uint32_t repeat_index = 0; repeat_index < std::max(1u, repeatCount); repeat_index++)
+    {
+        std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+        function();
+        double time = GetElapsedMilliseconds(start_time);
+        fastest_time = repeat_index == 0 ? time : std::min(fastest_time, time);
+    }
+    return fastest_time;
+}
+
+void AddOverheadRows(const WorkerPoolBenchmarkOptions &options, std::vector<BenchmarkRow> &rows)
+{
+    WorkerPool worker_pool;
+    uint32_t task_count = std::max(1u, options.taskCount);
+    BenchmarkRow row;
+    row.threadCount = worker_pool.GetThreadCount();
+    row.itemCount = task_count;
+
+    // from outside: every task goes through the shared queue
+    std::atomic<uint32_t> run_count(0);
+    row.name = "schedule_from_main";
+    row.time = GetFastestTime(options.repeatCount, [&]() {
+        std::vector<WorkerPool::TaskHandle> tasks;
+        tasks.reserve(task_count);
+        for (uint32_t task_index = 0; task_index < task_count; task_index++)
+        {
+            tasks.push_back(worker_pool.Schedule([&run_count]() { run_count++; }));
+        }
+        for (const WorkerPool::TaskHandle &task_item : tasks)
+        {
+            worker_pool.Wait(task_item);
+        }
+    });
+    rows.push_back(row);
+
+    // from a worker: its own deque, the others steal
+    row.name = "schedule_from_task";
+    row.time = GetFastestTime(options.repeatCount, [&]() {
+        WorkerPool::TaskHandle parent = worker_pool.Schedule([&]() {
+            std::vector<WorkerPool::TaskHandle> tasks;
+            tasks.reserve(task_count);
+            for (uint32_t task_index = 0; task_index < task_count; task_index++)
+            {
+                tasks.push_back(worker_pool.Schedule([&run_count]() { run_count++; }));
+            }
+            for (const WorkerPool::TaskHandle &task_item : tasks)
+            {
+                worker_pool.Wait(task_item);
+            }
+        });
+        worker_pool.Wait(parent);
+    });
+    rows.push_back(row);
+
+    // every task waits for the previous one, nothing runs in parallel
+    row.name = "dependency_chain";
+    row.time = GetFastestTime(options.repeatCount, [&]() {
+        WorkerPool::TaskHandle previous;
+        for (uint32_t task_index = 0; task_index < task_count; task_index++)
+        {
+            previous = worker_pool.Schedule([&run_count]() { run_count++; }, {previous});
+        }
+        worker_pool.Wait(previous);
+    });
+    rows.push_back(row);
+
+    // one task depends on all the others
+    row.name = "dependency_fan_in";
+    row.time = GetFastestTime(options.repeatCount, [&]() {
+        std::vector<WorkerPool::TaskHandle> tasks;
+        tasks.reserve(task_count);
+        for (uint32_t task_index = 0; task_index < task_count; task_index++)
+        {
+            tasks.push_back(worker_pool.Schedule([&run_count]() { run_count++; }));
+        }
+        worker_pool.Wait(worker_pool.Schedule([]() {}, tasks));
+    });
+    rows.push_back(row);
+
+    uint32_t expected_run_count = 4 * task_count * std::max(1u, options.repeatCount);
+    if (run_count.load() != expected_run_count)
+    {
+        for (size_t row_index = rows.size() - 4; row_index < rows.size(); row_index++)
+        {
+            rows[row_index].isCorrect = false;
+        }
+    }
+}
+
+void AddScalingRows(const WorkerPoolBenchmarkOptions &options, std::vector<BenchmarkRow> &rows)
+{
+    size_t item_count = static_cast<size_t>(options.itemCount);
+    uint32_t max_thread_count = std::max(1u, std::thread::hardware_concurrency());
+
+    uint64_t serial_sum = 0;
+    BenchmarkRow serial_row;
+    serial_row.name = "serial";
+    serial_row.threadCount = 1;
+    serial_row.itemCount = item_count;
+    serial_row.time = GetFastestTime(options.repeatCount, [&]() { serial_sum = GetRangeWork(0, item_count); });
+    serial_row.speedup = 1;
+    rows.push_back(serial_row);
+
+    std::vector<uint32_t> thread_counts;
+    for (uint32_t thread_count = 1; thread_count < max_thread_count; thread_count *= 2)
+    {
+        thread_counts.push_back(thread_count);
+    }
+    thread_counts.push_back(max_thread_count);
+
+    for (uint32_t thread_count : thread_counts)
+    {
+        WorkerPool worker_pool(thread_count);
+        uint64_t sum = 0;
+        BenchmarkRow row;
+        row.name = "parallel_reduce";
+        row.threadCount = thread_count;
+        row.itemCount = item_count;
+        row.time = GetFastestTime(options.repeatCount, [&]() { sum = worker_pool.ParallelReduce(item_count, uint64_t(0), GetRangeWork, [](uint64_t left, uint64_t right) { return left + right; }); });
+        row.speedup = row.time > 0 ? serial_row.time / row.time : 0;
+        row.isCorrect = sum == serial_sum;
+        rows.push_back(row);
+    }
+
+    // the ad hoc alternative: threads created for the call
+    uint64_t thread_sum = 0;
+    BenchmarkRow thread_row;
+    thread_row.name = "std_thread_per_range";
+    thread_row.threadCount = max_thread_count;
+    thread_row.itemCount = item_count;
+    thread_row.time = GetFastestTime(options.repeatCount, [&]() {
+        size_t range_size = (item_count + max_thread_count - 1) / max_thread_count;
+        std::vector<uint64_t> range_sums(max_thread_count, 0);
+        std::vector<std::thread> threads;
+        for (uint32_t range_index = 0; range_index < max_thread_count; range_index++)
+        {
+            size_t begin = std::min(item_count, range_index * range_size);
+            size_t end = std::min(item_count, begin + range_size);
+            threads.emplace_back([&range_sums, range_index, begin, end]() { range_sums[range_index] = GetRangeWork(begin, end); });
+        }
+        thread_sum = 0;
+        for (uint32_t range_index = 0; range_index < max_thread_count; range_index++)
+        {
+            threads[range_index].join();
+            thread_sum += range_sums[range_index];
+        }
+    });
+    thread_row.speedup = thread_row.time > 0 ? serial_row.time / thread_row.time : 0;
+    thread_row.isCorrect = thread_sum == serial_sum;
+    rows.push_back(thread_row);
+}
+} // namespace
+
+int RunWorkerPoolBenchmark(const WorkerPoolBenchmarkOptions &options)
+{
+    std::vector<BenchmarkRow> rows;
+    AddOverheadRows(options, rows);
+    AddScalingRows(options, rows);
+
+    bool is_all_correct = true;
+    for (const BenchmarkRow &row : rows)
+    {
+        is_all_correct = is_all_correct && row.isCorrect;
+        double ns_per_item = row.itemCount > 0 ? row.time * 1000000.0 / row.itemCount : 0;
+        std::cout << "WorkerPool::" << row.name << "::threads::" << row.threadCount << "::items::" << row.itemCount << "::" << row.time << "ms::" << ns_per_item << "ns per item";
+        if (row.speedup > 0)
+        {
+            std::cout << "::speedup::" << row.speedup;
+        }
+        std::cout << (row.isCorrect ? "" : "::WRONG RESULT") << std::endl;
+    }
+
+    std::ofstream out_stream(options.outputFile, std::ios::trunc);
+    if (!out_stream.is_open())
+    {
+        std::cerr << "Failed to write " << options.outputFile << std::endl;
+        return 1;
+    }
+
+    out_stream << "{\n  \"hardware_concurrency\": " << std::thread::hardware_concurrency() << ",\n  \"results\": [\n";
+    for (size_t row_index = 0; row_index < rows.size(); row_index++)
+    {
+        const BenchmarkRow &row = rows[row_index];
+        double ns_per_item = row.itemCount > 0 ? row.time * 1000000.0 / row.itemCount : 0;
+        out_stream << "    {\"name\": \"" << row.name << "\", \"threads\": " << row.threadCount << ", \"items\": " << row.itemCount << ", \"ms\": " << row.time << ", \"ns_per_item\": " << ns_per_item;
+        if (row.speedup > 0)
+        {
+            out_stream << ", \"speedup\": " << row.speedup;
+        }
+        out_stream << ", \"correct\": " << (row.isCorrect ? "true" : "false") << "}" << (row_index + 1 < rows.size() ? "," : "") << "\n";
+    }
+    out_stream << "  ]\n}\n";
+
+    return out_stream.good() && is_all_correct ? 0 : 1;
+}
@@ -0,0 +1,22 @@
+#pragma once
+#ifndef POINTCLOUD_WORKERPOOLBENCHMARK_H
+#define POINTCLOUD_WORKERPOOLBENCHMARK_H
+#include <cstdint>
+#include <string>
+
+typedef struct WorkerPoolBenchmarkOptions
+{
+    std::string outputFile = "./worker_pool_benchmark.json";
+    uint32_t taskCount = 100000;  // empty tasks of the overhead rows
+    uint64_t itemCount = 1 << 24; // items of the scaling rows, 32 rounds of integer hashing each
+    uint32_t repeatCount = 3;     // every row runs that many times, the fastest run is reported
+} WorkerPoolBenchmarkOptions;
+
+// Microbenchmarks of WorkerPool, no Vulkan:
+//   overhead  empty tasks from the main thread, from inside a task (own deque and stealing), a dependency chain and a fan-in
+//   scaling   ParallelReduce() over options.itemCount items with 1, 2, 4, ... hardware_concurrency workers (the calling thread
+//             takes a range too), against the serial loop and one std::thread per range spawned for the call
+// Print a line per row and write them as JSON to options.outputFile. Return the process exit code (1 if a reduction is wrong).
+int RunWorkerPoolBenchmark(const WorkerPoolBenchmarkOptions &options);
+
+#endif // !POINTCLOUD_WORKERPOOLBENCHMARK_H
@@ -0,0 +1,597 @@
+// Deterministic synthetic PLY point clouds for the loader benchmarks (tools/PlyLoaderBenchmark.cpp) and the headless renderer benchmark.
+// Only integer and IEEE float arithmetic plus sqrt is used (no transcendental functions, no <random> distributions), so a seed gives the same file on every platform.
+//
+// Build:
+//   cl /O2 /EHsc tools\PlyGenerator.cpp
+//   g++ -O2 -std=c++14 tools/PlyGenerator.cpp -o PlyGenerator
+//
+// Usage:
+//   PlyGenerator <output.ply> [--points 10M] [--format ascii|binary_le|binary_be] [--distribution uniform|surface|clustered]
+//                             [--normals] [--labels] [--faces] [--seed 1]
+//   PlyGenerator --suite <existing directory> [--max-points 10M]
+//
+// Vertex properties are x, y, z (float), [nx, ny, nz (float)], red, green, blue, alpha (uchar), [label (int)],
+// --faces adds one triangle "face" element per three vertices (list uchar int vertex_indices).
+// Point counts accept the k, M and G suffixes.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+enum class PlyFormat
+{
+    ASCII,
+    BINARY_LE,
+    BINARY_BE,
+};
+
+enum class PointDistribution
+{
+    UNIFORM,   // box of 20 x 20 x 4 around the origin
+    SURFACE,   // noisy saddle z = (x * x - y * y) / 40, normals follow the surface
+    CLUSTERED, // CLUSTER_COUNT blobs with an approximately normal falloff
+};
+
+struct GeneratorOptions
+{
+    std::string outputFile;
+    uint64_t pointCount = 10000000;
+    PlyFormat format = PlyFormat::BINARY_LE;
+    PointDistribution distribution = PointDistribution::UNIFORM;
+    bool isNormals = false;
+    bool isLabels = false;
+    bool isFaces = false;
+    uint64_t seed = 1;
+};
+
+const uint32_t CLUSTER_COUNT = 64;
+const size_t WRITE_BUFFER_SIZE = 4 * 1024 * 1024;
+
+// splitmix64, tiny and identical on every compiler
+class Random
+{
+  private:
+    uint64_t state;
+
+  public:
+    explicit Random(uint64_t seed) : state(seed)
+    {
+    }
+
+    uint64_t Next()
+    {
+        uint64_t z = (this->state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    // [0, 1)
+    float NextFloat()
+    {
+        return static_cast<float>(this->Next() >> 40) / static_cast<float>(1u << 24);
+    }
+
+    // [-1, 1)
+    float NextSignedFloat()
+    {
+        return this->NextFloat() * 2.0f - 1.0f;
+    }
+
+    // Irwin-Hall with four samples, mean 0 and standard deviation ~0.577
+    float NextBellFloat()
+    {
+        return this->NextFloat() + this->NextFloat() + this->NextFloat() + this->NextFloat() - 2.0f;
+    }
+};
+
+struct Vertex
+{
+    float x, y, z;
+    float nx, ny, nz;
+    unsigned char r, g, b, a;
+    int32_t label;
+};
+
+class BufferedWriter
+{
+  private:
+    FILE *file;
+    std::vector<char> buffer;
+
+  public:
+    explicit BufferedWriter(FILE *file) : file(file)
+    {
+        this->buffer.reserve(WRITE_BUFFER_SIZE);
+    }
+
+    ~BufferedWriter()
+    {
+        this->Flush();
+    }
+
+    void Write(const void *data, size_t size)
+    {
+        if (this->buffer.size() + size > WRITE_BUFFER_SIZE)
+        {
+            this->Flush();
+        }
+        const char *bytes = static_cast<const char *>(data);
+        this->buffer.insert(this->buffer.end(), bytes, bytes + size);
+    }
+
+    void Write(const std::string &text)
+    {
+        this->Write(text.data(), text.size());
+    }
+
+    // PLY binary values are written in the byte order of the file
+    template <typename T>
+    void WriteValue(T value, bool isBigEndian)
+    {
+        unsigned char bytes[sizeof(T)];
+        memcpy(bytes, &value, sizeof(T));
+        if (isBigEndian)
+        {
+            std::reverse(bytes, bytes + sizeof(T));
+        }
+        this->Write(bytes, sizeof(T));
+    }
+
+    void Flush()
+    {
+        if (!this->buffer.empty())
+        {
+            fwrite(this->buffer.data(), 1, this->buffer.size(), this->file);
+            this->buffer.clear();
+        }
+    }
+};
+
+bool ParseCount(const std::string &text, uint64_t *count)
+{
+    char *end = nullptr;
+    double value = strtod(text.c_str(), &end);
+    if (end == text.c_str() || value < 0)
+    {
+        return false;
+    }
+
+    switch (*end)
+    {
+    case 'k':
+    case 'K':
+        value *= 1e3;
+        break;
+    case 'm':
+    case 'M':
+        value *= 1e6;
+        break;
+    case 'g':
+    case 'G':
+        value *= 1e9;
+        break;
+    case '\0':
+        break;
+    default:
+        return false;
+    }
+
+    *count = static_cast<uint64_t>(value);
+    return true;
+}
+
+std::string CountToString(uint64_t count)
+{
+    if (count >= 1000000 && count % 1000000 == 0)
+    {
+        return std::to_string(count / 1000000) + "M";
+    }
+    if (count >= 1000 && count % 1000 == 0)
+    {
+        return std::to_string(count / 1000) + "k";
+    }
+    return std::to_string(count);
+}
+
+const char *FormatToString(PlyFormat format)
+{
+    switch (format)
+    {
+    case PlyFormat::ASCII:
+        return "ascii";
+    case PlyFormat::BINARY_LE:
+        return "binary_little_endian";
+    case PlyFormat::BINARY_BE:
+        return "binary_big_endian";
+    }
+    return "";
+}
+
+const char *DistributionToString(PointDistribution distribution)
+{
+    switch (distribution)
+    {
+    case PointDistribution::UNIFORM:
+        return "uniform";
+    case PointDistribution::SURFACE:
+        return "surface";
+    case PointDistribution::CLUSTERED:
+        return "clustered";
+    }
+    return "";
+}
+
+unsigned char ToColorByte(float value)
+{
+    return static_cast<unsigned char>(std::max(0.0f, std::min(1.0f, value)) * 255.0f + 0.5f);
+}
+
+void Normalize(float *x, float *y, float *z)
+{
+    float length_sq = *x * *x + *y * *y + *z * *z;
+    if (length_sq <= 0.0f)
+    {
+        *x = 0.0f;
+        *y = 0.0f;
+        *z = 1.0f;
+        return;
+    }
+
+    // sqrt is correctly rounded by IEEE 754, so this stays deterministic
+    float length = static_cast<float>(std::sqrt(static_cast<double>(length_sq)));
+    *x /= length;
+    *y /= length;
+    *z /= length;
+}
+
+Vertex GenerateVertex(Random &random, PointDistribution distribution, const std::vector<Vertex> &clusterCenters)
+{
+    Vertex vertex = {};
+    switch (distribution)
+    {
+    case PointDistribution::UNIFORM: {
+        vertex.x = random.NextSignedFloat() * 10.0f;
+        vertex.y = random.NextSignedFloat() * 10.0f;
+        vertex.z = random.NextSignedFloat() * 2.0f;
+        vertex.nx = random.NextSignedFloat();
+        vertex.ny = random.NextSignedFloat();
+        vertex.nz = random.NextSignedFloat();
+        vertex.label = 0;
+        break;
+    }
+    case PointDistribution::SURFACE: {
+        vertex.x = random.NextSignedFloat() * 10.0f;
+        vertex.y = random.NextSignedFloat() * 10.0f;
+        vertex.z = (vertex.x * vertex.x - vertex.y * vertex.y) / 40.0f + random.NextBellFloat() * 0.01f;
+        vertex.nx = -vertex.x / 20.0f;
+        vertex.ny = vertex.y / 20.0f;
+        vertex.nz = 1.0f;
+        vertex.label = vertex.z > 0.0f ? 1 : 0;
+        break;
+    }
+    case PointDistribution::CLUSTERED: {
+        uint32_t cluster_index = static_cast<uint32_t>(random.Next() % clusterCenters.size());
+        const Vertex &center = clusterCenters[cluster_index];
+        vertex.nx = random.NextBellFloat();
+        vertex.ny = random.NextBellFloat();
+        vertex.nz = random.NextBellFloat();
+        vertex.x = center.x + vertex.nx * 0.8f;
+        vertex.y = center.y + vertex.ny * 0.8f;
+        vertex.z = center.z + vertex.nz * 0.8f;
+        vertex.label = static_cast<int32_t>(cluster_index);
+        break;
+    }
+    }
+
+    Normalize(&vertex.nx, &vertex.ny, &vertex.nz);
+
+    // height ramp from blue to red, so the clouds are readable in the viewer
+    float t = (vertex.z + 2.0f) / 4.0f;
+    vertex.r = ToColorByte(t);
+    vertex.g = ToColorByte(1.0f - (t - 0.5f) * (t - 0.5f) * 4.0f);
+    vertex.b = ToColorByte(1.0f - t);
+    vertex.a = 255;
+    return vertex;
+}
+
+bool Generate(const GeneratorOptions &options)
+{
+    if (options.pointCount > 0x7FFFFFFF)
+    {
+        fprintf(stderr, "%s: ply/plyfile.cpp counts elements with an int, at most 2147483647 points\n", options.outputFile.c_str());
+        return false;
+    }
+
+    FILE *file = fopen(options.outputFile.c_str(), "wb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "Failed to open %s\n", options.outputFile.c_str());
+        return false;
+    }
+
+    uint64_t face_count = options.isFaces ? options.pointCount / 3 : 0;
+    bool is_big_endian = options.format == PlyFormat::BINARY_BE;
+    char line[256];
+
+    {
+        BufferedWriter writer(file);
+
+        std::string header = "ply\nformat " + std::string(FormatToString(options.format)) + " 1.0\n";
+        header += "comment PlyGenerator " + std::string(DistributionToString(options.distribution)) + " seed " + std::to_string(options.seed) + "\n";
+        header += "element vertex " + std::to_string(options.pointCount) + "\n";
+        header += "property float x\nproperty float y\nproperty float z\n";
+        if (options.isNormals)
+        {
+            header += "property float nx\nproperty float ny\nproperty float nz\n";
+        }
+        header += "property uchar red\nproperty uchar green\nproperty uchar blue\nproperty uchar alpha\n";
+        if (options.isLabels)
+        {
+            header += "property int label\n";
+        }
+        if (options.isFaces)
+        {
+            header += "element face " + std::to_string(face_count) + "\nproperty list uchar int vertex_indices\n";
+        }
+        header += "end_header\n";
+        writer.Write(header);
+
+        Random random(options.seed);
+        std::vector<Vertex> cluster_centers(CLUSTER_COUNT);
+        for (Vertex &cluster_center : cluster_centers)
+        {
+            cluster_center.x = random.NextSignedFloat() * 10.0f;
+            cluster_center.y = random.NextSignedFloat() * 10.0f;
+            cluster_center.z = random.NextSignedFloat() * 2.0f;
+        }
+
+        for (uint64_t point_index = 0; point_index < options.pointCount; point_index++)
+        {
+            Vertex vertex = GenerateVertex(random, options.distribution, cluster_centers);
+            if (options.format == PlyFormat::ASCII)
+            {
+                int length = snprintf(line, sizeof(line), "%.6f %.6f %.6f", vertex.x, vertex.y, vertex.z);
+                if (options.isNormals)
+                {
+                    length += snprintf(line + length, sizeof(line) - length, " %.6f %.6f %.6f", vertex.nx, vertex.ny, vertex.nz);
+                }
+                length += snprintf(line + length, sizeof(line) - length, " %u %u %u %u", vertex.r, vertex.g, vertex.b, vertex.a);
+                if (options.isLabels)
+                {
+                    length += snprintf(line + length, sizeof(line) - length, " %d", vertex.label);
+                }
+                line[length++] = '\n';
+                writer.Write(line, length);
+            }
+            else
+            {
+                writer.WriteValue(vertex.x, is_big_endian);
+                writer.WriteValue(vertex.y, is_big_endian);
+                writer.WriteValue(vertex.z, is_big_endian);
+                if (options.isNormals)
+                {
+                    writer.WriteValue(vertex.nx, is_big_endian);
+                    writer.WriteValue(vertex.ny, is_big_endian);
+                    writer.WriteValue(vertex.nz, is_big_endian);
+                }
+                unsigned char color[4] = {vertex.r, vertex.g, vertex.b, vertex.a};
+                writer.Write(color, sizeof(color));
+                if (options.isLabels)
+                {
+                    writer.WriteValue(vertex.label, is_big_endian);
+                }
+            }
+        }
+
+        for (uint64_t face_index = 0; face_index < face_count; face_index++)
+        {
+            int32_t first = static_cast<int32_t>(face_index * 3);
+            if (options.format == PlyFormat::ASCII)
+            {
+                int length = snprintf(line, sizeof(line), "3 %d %d %d\n", first, first + 1, first + 2);
+                writer.Write(line, length);
+            }
+            else
+            {
+                unsigned char vertex_count = 3;
+                writer.Write(&vertex_count, 1);
+                writer.WriteValue(first, is_big_endian);
+                writer.WriteValue(first + 1, is_big_endian);
+                writer.WriteValue(first + 2, is_big_endian);
+            }
+        }
+    }
+
+    bool is_ok = ferror(file) == 0;
+    is_ok = fclose(file) == 0 && is_ok;
+    if (!is_ok)
+    {
+        fprintf(stderr, "Failed to write %s\n", options.outputFile.c_str());
+    }
+    return is_ok;
+}
+
+// every format at 1M, 10M, 100M and 500M points (up to maxPointCount), plus the attribute and distribution variants at 1M
+bool GenerateSuite(const std::string &directory, uint64_t maxPointCount)
+{
+    const PlyFormat formats[] = {PlyFormat::ASCII, PlyFormat::BINARY_LE, PlyFormat::BINARY_BE};
+    const char *format_names[] = {"ascii", "le", "be"};
+    const uint64_t point_counts[] = {1000000, 10000000, 100000000, 500000000};
+
+    std::vector<GeneratorOptions> suite;
+    for (uint64_t point_count : point_counts)
+    {
+        if (point_count > maxPointCount)
+        {
+            break;
+        }
+        for (size_t format_index = 0; format_index < 3; format_index++)
+        {
+            GeneratorOptions options;
+            options.pointCount = point_count;
+            options.format = formats[format_index];
+            options.outputFile = directory + "/uniform_" + CountToString(point_count) + "_" + format_names[format_index] + ".ply";
+            suite.push_back(options);
+        }
+    }
+
+    for (size_t format_index = 0; format_index < 3; format_index++)
+    {
+        for (PointDistribution distribution : {PointDistribution::SURFACE, PointDistribution::CLUSTERED})
+        {
+            GeneratorOptions options;
+            options.pointCount = std::min<uint64_t>(1000000, maxPointCount);
+            options.format = formats[format_index];
+            options.distribution = distribution;
+            options.outputFile = directory + "/" + DistributionToString(distribution) + "_" + CountToString(options.pointCount) + "_" + format_names[format_index] + ".ply";
+            suite.push_back(options);
+        }
+
+        GeneratorOptions options;
+        options.pointCount = std::min<uint64_t>(1000000, maxPointCount);
+        options.format = formats[format_index];
+        options.isNormals = true;
+        options.isLabels = true;
+        options.isFaces = true;
+        options.outputFile = directory + "/uniform_" + CountToString(options.pointCount) + "_" + format_names[format_index] + "_normals_labels_faces.ply";
+        suite.push_back(options);
+    }
+
+    for (const GeneratorOptions &options : suite)
+    {
+        printf("%s\n", options.outputFile.c_str());
+        if (!Generate(options))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void PrintUsage()
+{
+    fprintf(stderr, "PlyGenerator <output.ply> [--points 10M] [--format ascii|binary_le|binary_be] [--distribution uniform|surface|clustered] [--normals] [--labels] [--faces] [--seed 1]\n");
+    fprintf(stderr, "PlyGenerator --suite <directory> [--max-points 10M]\n");
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    GeneratorOptions options;
+    std::string suite_directory;
+    uint64_t max_point_count = 10000000;
+
+    for (int arg_index = 1; arg_index < argc; arg_index++)
+    {
+        std::string arg = argv[arg_index];
+        bool has_value = arg_index + 1 < argc;
+        if (arg == "--points" && has_value)
+        {
+            if (!ParseCount(argv[++arg_index], &options.pointCount))
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--max-points" && has_value)
+        {
+            if (!ParseCount(argv[++arg_index], &max_point_count))
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--format" && has_value)
+        {
+            std::string format = argv[++arg_index];
+            if (format == "ascii")
+            {
+                options.format = PlyFormat::ASCII;
+            }
+            else if (format == "binary_le")
+            {
+                options.format = PlyFormat::BINARY_LE;
+            }
+            else if (format == "binary_be")
+            {
+                options.format = PlyFormat::BINARY_BE;
+            }
+            else
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--distribution" && has_value)
+        {
+            std::string distribution = argv[++arg_index];
+            if (distribution == "uniform")
+            {
+                options.distribution = PointDistribution::UNIFORM;
+            }
+            else if (distribution == "surface")
+            {
+                options.distribution = PointDistribution::SURFACE;
+            }
+            else if (distribution == "clustered")
+            {
+                options.distribution = PointDistribution::CLUSTERED;
+            }
+            else
+            {
+                PrintUsage();
+                return 1;
+            }
+        }
+        else if (arg == "--seed" && has_value)
+        {
+            options.seed = strtoull(argv[++arg_index], nullptr, 10);
+        }
+        else if (arg == "--normals")
+        {
+            options.isNormals = true;
+        }
+        else if (arg == "--labels")
+        {
+            options.isLabels = true;
+        }
+        else if (arg == "--faces")
+        {
+            options.isFaces = true;
+        }
+        else if (arg == "--suite" && has_value)
+        {
+            suite_directory = argv[++arg_index];
+        }
+        else if (arg[0] != '-' && options.outputFile.empty())
+        {
+            options.outputFile = arg;
+        }
+        else
+        {
+            PrintUsage();
+            return 1;
+        }
+    }
+
+    if (!suite_directory.empty())
+    {
+        return GenerateSuite(suite_directory, max_point_count) ? 0 : 1;
+    }
+
+    if (options.outputFile.empty())
+    {
+        PrintUsage();
+        return 1;
+    }
+
+    return Generate(options) ? 0 : 1;
+}
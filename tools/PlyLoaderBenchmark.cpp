@@ -0,0 +1,277 @@
+// Time every way the viewer can ingest a PLY file, on files made by tools/PlyGenerator.cpp or real scans.
+//   LoadPly           src/PlyLoader.cpp, what the viewer runs (x, y, z, red, green, blue, alpha into PlyData)
+//   plyfile_xyz       ply/plyfile.cpp ply_get_element() with only x, y, z requested, the floor of the element reader
+//   plyfile_all       ply/plyfile.cpp ply_get_element() with every vertex property plus the face lists
+// Each path reports points/s, MB/s of the file and the peak resident set size of the process after it ran.
+// NOTE: the peak RSS never goes down, run one path per process (--only) to read it per path
+//
+// Build:
+//   cl /O2 /EHsc /Iply /Iglm /Icore\include tools\PlyLoaderBenchmark.cpp src\PlyLoader.cpp src\Trace.cpp ply\plyfile.cpp
+//   g++ -O2 -std=c++14 -Iply -Iglm -Icore/include tools/PlyLoaderBenchmark.cpp src/PlyLoader.cpp src/Trace.cpp ply/plyfile.cpp -o PlyLoaderBenchmark -pthread
+// (core/include only for the Vulkan headers behind PointCloudData.h, TCore.lib is not linked)
+//
+// Usage:
+//   PlyLoaderBenchmark [--repeat 3] [--only LoadPly|plyfile_xyz|plyfile_all] [--json results.json] <file.ply>...
+
+#include "../src/PlyLoader.h"
+
+#include <ply.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+struct BenchmarkResult
+{
+    std::string file;
+    std::string path;
+    uint64_t pointCount = 0;
+    uint64_t fileSize = 0;  // byte
+    double time = 0;        // second, best of the repeats
+    uint64_t peakRss = 0;   // byte
+};
+
+uint64_t GetPeakRss()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters = {};
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+uint64_t GetFileSize(const std::string &path)
+{
+    std::ifstream in_stream(path, std::ios::binary | std::ios::ate);
+    return in_stream.is_open() ? static_cast<uint64_t>(in_stream.tellg()) : 0;
+}
+
+uint64_t RunLoadPly(const std::string &path)
+{
+    PlyData ply_data = LoadPly(path);
+    return ply_data.points.size();
+}
+
+// Read the vertex element with the requested properties and every element after it the way the viewer would need them.
+// isAllProperties == false: x, y, z only. true: every scalar vertex property with its file type, and the "face" vertex_indices lists.
+uint64_t RunPlyFile(const std::string &path, bool isAllProperties)
+{
+    int elements_count = 0;
+    char **elements = nullptr;
+    int file_type = 0;
+    float version = 0;
+
+    PlyFile *ply_file = ply_open_for_reading(const_cast<char *>(path.c_str()), &elements_count, &elements, &file_type, &version);
+    if (ply_file == nullptr)
+    {
+        fprintf(stderr, "Failed to open %s\n", path.c_str());
+        return 0;
+    }
+
+    uint64_t point_count = 0;
+    for (int element_index = 0; element_index < elements_count; element_index++)
+    {
+        int element_count = 0;
+        int property_count = 0;
+        PlyProperty **property_list = ply_get_element_description(ply_file, elements[element_index], &element_count, &property_count);
+
+        if (equal_strings("vertex", elements[element_index]))
+        {
+            std::vector<PlyProperty> properties;
+            int element_size = 0;
+            for (int property_index = 0; property_index < property_count; property_index++)
+            {
+                PlyProperty property = *property_list[property_index];
+                bool is_xyz = equal_strings(property.name, "x") || equal_strings(property.name, "y") || equal_strings(property.name, "z");
+                if (property.is_list || (!isAllProperties && !is_xyz))
+                {
+                    continue;
+                }
+
+                // keep the file type, 8 bytes per slot is enough for every PLY scalar
+                property.internal_type = property.external_type;
+                property.offset = element_size;
+                element_size += 8;
+                properties.push_back(property);
+            }
+
+            for (PlyProperty &property : properties)
+            {
+                ply_get_property(ply_file, elements[element_index], &property);
+            }
+
+            std::vector<char> vertex(std::max(element_size, 8));
+            for (int i = 0; i < element_count; i++)
+            {
+                ply_get_element(ply_file, vertex.data());
+            }
+            point_count += element_count;
+        }
+        else if (equal_strings("face", elements[element_index]) && isAllProperties)
+        {
+            struct PlyFace
+            {
+                unsigned char vertexCount;
+                int *vertices;
+            };
+
+            PlyProperty face_property = {"vertex_indices", PLY_INT, PLY_INT, offsetof(PlyFace, vertices), 1, PLY_UCHAR, PLY_UCHAR, offsetof(PlyFace, vertexCount)};
+            ply_get_property(ply_file, elements[element_index], &face_property);
+
+            for (int i = 0; i < element_count; i++)
+            {
+                PlyFace face = {};
+                ply_get_element(ply_file, &face);
+                free(face.vertices);
+            }
+        }
+        else
+        {
+            // the elements are stored one after another, nothing behind an unread element can be reached
+            break;
+        }
+    }
+
+    ply_close(ply_file);
+    return point_count;
+}
+
+void WriteJson(const std::string &path, const std::vector<BenchmarkResult> &results)
+{
+    std::ofstream out_stream(path, std::ios::trunc);
+    out_stream << "[\n";
+    for (size_t result_index = 0; result_index < results.size(); result_index++)
+    {
+        const BenchmarkResult &result = results[result_index];
+        out_stream << "  {\"file\": \"";
+        for (char c : result.file)
+        {
+            if (c == '"' || c == '\\')
+            {
+                out_stream << '\\';
+            }
+            out_stream << c;
+        }
+        out_stream << "\", \"path\": \"" << result.path << "\", \"points\": " << result.pointCount << ", \"bytes\": " << result.fileSize << ", \"seconds\": " << result.time;
+        out_stream << ", \"points_per_second\": " << (result.time > 0 ? result.pointCount / result.time : 0) << ", \"mb_per_second\": " << (result.time > 0 ? result.fileSize / result.time / (1024.0 * 1024.0) : 0);
+        out_stream << ", \"peak_rss_bytes\": " << result.peakRss << "}" << (result_index + 1 < results.size() ? "," : "") << "\n";
+    }
+    out_stream << "]\n";
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    int repeat_count = 3;
+    std::string only_path;
+    std::string json_path;
+    std::vector<std::string> files;
+
+    for (int arg_index = 1; arg_index < argc; arg_index++)
+    {
+        std::string arg = argv[arg_index];
+        bool has_value = arg_index + 1 < argc;
+        if (arg == "--repeat" && has_value)
+        {
+            repeat_count = std::max(1, atoi(argv[++arg_index]));
+        }
+        else if (arg == "--only" && has_value)
+        {
+            only_path = argv[++arg_index];
+        }
+        else if (arg == "--json" && has_value)
+        {
+            json_path = argv[++arg_index];
+        }
+        else if (arg[0] != '-')
+        {
+            files.push_back(arg);
+        }
+        else
+        {
+            fprintf(stderr, "PlyLoaderBenchmark [--repeat 3] [--only LoadPly|plyfile_xyz|plyfile_all] [--json results.json] <file.ply>...\n");
+            return 1;
+        }
+    }
+
+    if (files.empty())
+    {
+        fprintf(stderr, "PlyLoaderBenchmark [--repeat 3] [--only LoadPly|plyfile_xyz|plyfile_all] [--json results.json] <file.ply>...\n");
+        return 1;
+    }
+
+    typedef std::function<uint64_t(const std::string &)> IngestionPath;
+    const std::vector<std::pair<std::string, IngestionPath>> ingestion_paths = {
+        {"LoadPly", RunLoadPly},
+        {"plyfile_xyz", [](const std::string &path) { return RunPlyFile(path, false); }},
+        {"plyfile_all", [](const std::string &path) { return RunPlyFile(path, true); }},
+    };
+
+    std::vector<BenchmarkResult> results;
+    printf("%-48s %-12s %12s %10s %14s %10s %12s\n", "file", "path", "points", "ms", "points/s", "MB/s", "peak RSS MB");
+    for (const std::string &file : files)
+    {
+        uint64_t file_size = GetFileSize(file);
+        for (const auto &ingestion_path : ingestion_paths)
+        {
+            if (!only_path.empty() && only_path != ingestion_path.first)
+            {
+                continue;
+            }
+
+            BenchmarkResult result;
+            result.file = file;
+            result.path = ingestion_path.first;
+            result.fileSize = file_size;
+            for (int repeat_index = 0; repeat_index < repeat_count; repeat_index++)
+            {
+                std::chrono::steady_clock::time_point start_time = std::chrono::steady_clock::now();
+                result.pointCount = ingestion_path.second(file);
+                double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+                result.time = repeat_index == 0 ? time : std::min(result.time, time);
+            }
+            result.peakRss = GetPeakRss();
+            results.push_back(result);
+
+            double points_per_second = result.time > 0 ? result.pointCount / result.time : 0;
+            double mb_per_second = result.time > 0 ? result.fileSize / result.time / (1024.0 * 1024.0) : 0;
+            printf("%-48s %-12s %12llu %10.1f %14.0f %10.1f %12.1f\n", file.c_str(), result.path.c_str(), static_cast<unsigned long long>(result.pointCount), result.time * 1000.0, points_per_second, mb_per_second, result.peakRss / (1024.0 * 1024.0));
+        }
+    }
+
+    if (!json_path.empty())
+    {
+        WriteJson(json_path, results);
+    }
+
+    return 0;
+}